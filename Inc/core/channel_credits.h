@@ -0,0 +1,195 @@
+/**
+ * @file channel_credits.h
+ * @brief Logical channels with credit-based flow control
+ *
+ * This file defines the channel_credits class, which lets several
+ * independent streams (console, telemetry, file transfer) share one
+ * link without starving each other or overrunning the receiver.
+ *
+ * Frames of channel 1..CHANNEL_MAX-1 carry a channel header tag:
+ *
+ *   {c2:p:log/line:d:boot ok}
+ *
+ * Channel 0 (untagged) is not flow-controlled and carries control
+ * traffic. For every other channel the receiver opens a window of
+ * bytes and advertises it with $credit frames:
+ *
+ *   {p:$credit:d:<channel>,<limit>[,<channel>,<limit>...]}
+ *
+ * where limit is the cumulative number of encoded bytes the sender may
+ * have sent on that channel. The sender charges every frame with its
+ * encoded size and refuses frames that would exceed the limit. The
+ * receiver raises the limit as frames are executed, so the bytes in
+ * flight on a channel never exceed its window.
+ *
+ * Since limits are cumulative, a lost $credit frame is repaired by the
+ * next one; tick() re-advertises open windows periodically so that a
+ * blocked sender always recovers.
+ *
+ * Each peer owns one channel_credits, which holds the transmit credit
+ * granted by the other side and the receive windows of this side.
+ *
+ * Design goals:
+ * - Fixed number of channels, no dynamic memory allocation
+ * - Byte-accurate windows sized to the receiver's RX buffer
+ * - Tick-driven re-advertisement, no clock dependency
+ *
+ * @note Frames lost on the link are not refunded and shrink the window
+ *       of their channel; use a CRC trailer and reliable_link on lossy
+ *       links, or reopen the channel on both sides after a reconnect.
+ * @note Credit state is not synchronized; all senders of one channel
+ *       must run in the same task.
+ */
+#ifndef PATHWIRE_INC_CORE_CHANNEL_CREDITS_H_
+#define PATHWIRE_INC_CORE_CHANNEL_CREDITS_H_
+
+#include <stdint.h>
+
+class cmnd_sender;
+
+
+/**
+ * @def CHANNEL_MAX
+ * @brief Number of logical channels, including control channel 0
+ *
+ * One $credit frame carries the limits of all channels, so
+ * 2 * (CHANNEL_MAX - 1) must not exceed MAX_CSV_ITEMS.
+ */
+#ifndef CHANNEL_MAX
+#define CHANNEL_MAX 4
+#endif
+
+/**
+ * @def CHANNEL_REFRESH_TICKS
+ * @brief Ticks after which open windows are advertised again
+ */
+#ifndef CHANNEL_REFRESH_TICKS
+#define CHANNEL_REFRESH_TICKS 100
+#endif
+
+
+/**
+ * @class channel_credits
+ * @brief Per-channel transmit credit and receive windows of one peer
+ *
+ * Typical usage:
+ * @code
+ * channel_credits credits(reply_sender);
+ *
+ * executer.set_reply_sender(&reply_sender);
+ * executer.set_channel_credits(&credits);
+ *
+ * console.set_channel(&credits, 1);
+ * files.set_channel(&credits, 2);
+ *
+ * credits.open(1, 64);     // receive windows, in bytes
+ * credits.open(2, 384);
+ *
+ * if (credits.credit(2) >= 200)
+ *     files.send_bytes("file/data", buf, 128, 128);
+ *
+ * // periodic task
+ * credits.tick();
+ * @endcode
+ */
+class channel_credits
+{
+public:
+
+    /**
+     * @brief Constructs the channel state with all channels closed
+     *
+     * @param reply Sender used for $credit frames (should use channel 0)
+     */
+    explicit channel_credits(cmnd_sender& reply);
+
+    /**
+     * @brief Opens the receive window of a channel and advertises it
+     *
+     * @param channel Channel 1..CHANNEL_MAX-1
+     * @param window  Bytes the peer may have in flight on this channel
+     * @return false if the channel is invalid
+     */
+    bool open(uint8_t channel, uint16_t window);
+
+    /**
+     * @brief Returns the bytes that may still be sent on a channel
+     *
+     * Always 0xFFFFFFFF for channel 0.
+     */
+    uint32_t credit(uint8_t channel) const;
+
+    /**
+     * @brief Returns the number of frames refused for lack of credit
+     */
+    uint32_t blocked(uint8_t channel) const;
+
+    /**
+     * @brief Sends due advertisements and refreshes open windows
+     */
+    void tick();
+
+    /**
+     * @brief Charges a frame about to be sent
+     *
+     * Called by cmnd_sender before a frame is queued.
+     *
+     * @return false if the channel lacks credit for len bytes
+     */
+    bool reserve(uint8_t channel, uint16_t len);
+
+    /**
+     * @brief Books a frame that has been queued
+     *
+     * Called by cmnd_sender after a successful reserve().
+     */
+    void commit(uint8_t channel, uint16_t len);
+
+    /**
+     * @brief Processes a $credit limit from the peer
+     *
+     * @param channel Channel of the limit
+     * @param limit   Cumulative byte limit
+     */
+    void grant(uint8_t channel, uint32_t limit);
+
+    /**
+     * @brief Returns a received frame's bytes to its channel window
+     *
+     * Called by cmnd_executer after every frame. Sends $credit once
+     * half of the window has been consumed since the last one.
+     *
+     * @param channel Channel of the frame
+     * @param len     Encoded frame size
+     */
+    void received(uint8_t channel, uint16_t len);
+
+private:
+
+    /**
+     * @brief Sends the limits of all channels with a due advertisement
+     *
+     * @param all true to include every open channel
+     */
+    void advertise(bool all);
+
+    /**
+     * @brief State of one channel
+     */
+    struct channel_state
+    {
+        uint32_t tx_limit;     ///< Cumulative limit granted by the peer
+        uint32_t tx_sent;      ///< Bytes sent
+        uint32_t tx_blocked;   ///< Frames refused for lack of credit
+
+        uint16_t rx_window;    ///< Receive window (0 = closed)
+        uint32_t rx_consumed;  ///< Bytes received and executed
+        uint32_t rx_limit;     ///< Last advertised limit
+    };
+
+    cmnd_sender& reply;
+    channel_state channels[CHANNEL_MAX];
+    uint16_t     age;          ///< Ticks since the last advertisement
+};
+
+#endif // PATHWIRE_INC_CORE_CHANNEL_CREDITS_H_
@@ -28,29 +28,80 @@
 #include "core/ring_buffer.h"
 #include "core/cmnd_frame.h"
 
+class cmnd_sender;
+class reliable_link;
+class fragment_reassembler;
+class channel_credits;
+class flow_control;
+
 
 /**
  * @def MAX_CSV_ITEMS
  * @brief Maximum number of CSV elements parsed per command
  *
  * This limit bounds stack usage and ensures predictable execution time.
+ * It may be overridden at build time, e.g. on hosts receiving
+ * aggregated summary frames with more values.
  */
+#ifndef MAX_CSV_ITEMS
 #define MAX_CSV_ITEMS 8
+#endif
+
+
+/**
+ * @struct sample_block
+ * @brief Decoded time-series block frame
+ *
+ * Passed to handlers of BLOCK paths as the data pointer (count = 1).
+ * Values are stored column-wise (structure of arrays): all samples of
+ * channel 0, then all samples of channel 1, and so on.
+ *
+ * Sample s of channel c is values[c * samples + s] and was taken at
+ * base_time + s * period.
+ */
+struct sample_block
+{
+    uint32_t     base_time;  ///< Timestamp of the first sample
+    uint32_t     period;     ///< Sample period (same unit as base_time)
+    uint16_t     samples;    ///< Samples per channel
+    uint16_t     channels;   ///< Number of channels
+    const float* values;     ///< samples * channels values, column-wise
+};
+
+
+/**
+ * @struct payload_chunk
+ * @brief Piece of a raw byte payload delivered incrementally
+ *
+ * Passed to handlers of CHUNK paths as the data pointer (count = 1),
+ * once per received piece. Pieces may arrive out of order; offset
+ * locates the bytes within the payload.
+ */
+struct payload_chunk
+{
+    uint16_t       offset;  ///< Byte offset of data within the payload
+    uint16_t       total;   ///< Total payload size in bytes
+    const uint8_t* data;    ///< Chunk bytes
+    uint16_t       len;     ///< Number of bytes in data
+    bool           last;    ///< The payload is complete after this chunk
+};
 
 
 /**
- * @enum data_type
- * @brief Supported PathWire data payload types
+ * @struct stream_chunk
+ * @brief Piece of a streamed command payload
  *
- * The detected or expected data type determines how the data payload
- * is parsed and passed to the handler.
+ * Passed to handlers of STREAM paths as the data pointer (count = 1),
+ * in order: one BEGIN, any number of DATA, then END or ABORT. Bytes are
+ * the raw text payload; a piece may end in the middle of a value.
+ * Payload received before ABORT must be treated as invalid.
  */
-enum class data_type : uint8_t
+struct stream_chunk
 {
-    NONE,     ///< No data payload (trigger command)
-    INT,      ///< Comma-separated signed integers (e.g. "1,-2,3")
-    FLOAT,    ///< Comma-separated floats (e.g. "1.25,-0.5")
-    STRING    ///< Comma-separated strings (e.g. "foo,bar")
+    stream_phase   phase;   ///< BEGIN, DATA, END or ABORT
+    uint32_t       offset;  ///< Byte offset of data within the payload
+    const uint8_t* data;    ///< Piece bytes (not null-terminated)
+    uint16_t       len;     ///< Number of bytes in data
 };
 
 
@@ -93,6 +144,102 @@ struct path_entry
 };
 
 
+/**
+ * @typedef handler_dispatch
+ * @brief Replacement for the direct handler call
+ *
+ * Receives the path table entry and exactly the arguments its handler
+ * would receive. Used to run handlers elsewhere, e.g. on a worker
+ * pool (see cmnd_executer::set_handler_dispatch()).
+ *
+ * @param ctx   Context pointer given at registration
+ * @param entry Matched path table entry
+ * @param type  Detected data type
+ * @param data  Pointer to parsed data (valid only for the duration of the call)
+ * @param count Number of elements in data
+ */
+typedef void (*handler_dispatch)(
+    void* ctx,
+    const path_entry& entry,
+    data_type type,
+    const void* data,
+    uint16_t count
+);
+
+
+/**
+ * @typedef response_handler
+ * @brief Receives the replies to this peer's requests
+ *
+ * Called instead of a table handler for every reply frame ({r<id>:...}),
+ * once set with cmnd_executer::set_response_handler().
+ *
+ * @param ctx     Context pointer given at registration
+ * @param request Request ID of the reply
+ * @param type    Detected data type
+ * @param data    Pointer to parsed data (valid only for the duration of the call)
+ * @param count   Number of elements in data
+ */
+typedef void (*response_handler)(
+    void* ctx,
+    uint16_t request,
+    data_type type,
+    const void* data,
+    uint16_t count
+);
+
+
+class reply_writer;
+
+
+/**
+ * @typedef request_handler
+ * @brief Handler of a request path that answers through a reply writer
+ *
+ * @param type  Detected data type
+ * @param data  Pointer to parsed data array (type-dependent)
+ * @param count Number of elements in the parsed data array
+ * @param reply Writer of the reply frame, tagged with the request's ID
+ *
+ * @note data and reply are valid only for the duration of the call.
+ */
+typedef void (*request_handler)(
+    data_type type,
+    const void* data,
+    uint16_t count,
+    reply_writer& reply
+);
+
+
+/**
+ * @struct request_entry
+ * @brief Static request table entry
+ *
+ * Like path_entry, but for paths that are answered: the handler writes
+ * its reply straight into the outgoing frame.
+ */
+struct request_entry
+{
+    const char*     path;           ///< Null-terminated request path
+    data_type       expected_type;  ///< Expected payload data type
+    request_handler handler;        ///< Handler function
+};
+
+
+/**
+ * @brief Computes the dictionary hash of a path table
+ *
+ * FNV-1a over every path (including its terminator) and expected type,
+ * in table order. Two peers with equal hashes agree on the path ID of
+ * every entry, which is its index in the table.
+ *
+ * @param table      Path table
+ * @param table_size Number of entries in the table
+ * @return 32-bit table hash
+ */
+uint32_t path_table_hash(const path_entry* table, uint16_t table_size);
+
+
 /**
  * @class cmnd_executer
  * @brief Dispatches parsed PathWire commands to user handlers
@@ -119,7 +266,71 @@ struct path_entry
  * - Memory allocation
  * - Command scheduling or threading
  *
- * @note At most one command is executed per poll() call.
+ * Batch frames ({m:...}) are dispatched entry by entry within a single
+ * poll() call, as if each entry had arrived in its own command frame.
+ *
+ * Binary frames are type-checked against the path table and their
+ * payload is handed to the handler in place (see wire_mode).
+ *
+ * Path IDs:
+ * A frame may address an entry by its table index instead of its path,
+ * written as "#<id>" in text frames or as a 2-byte ID in binary frames.
+ * Such frames are resolved by direct indexing. Senders only use IDs
+ * after the path dictionary handshake has confirmed that both sides
+ * share the same table (see cmnd_sender::set_path_dictionary()).
+ *
+ * Control frames:
+ * Paths starting with '$' are reserved for the protocol and handled
+ * by the executer itself:
+ * - $dict with no data: reply with the hash of this executer's table
+ * - $dict with a hash : forward the peer's table hash to the reply sender
+ * - $ack               : forward a reliable-delivery ACK to the reliable link
+ * - $credit            : forward channel credit limits to the channel state
+ * - $xoff / $xon       : pause / resume the senders attached to the flow control
+ *
+ * Reliable frames:
+ * Frames tagged with a sequence number are checked against the
+ * reliable link first; duplicates (retransmissions whose ACK was lost)
+ * are acknowledged again but not dispatched.
+ *
+ * Channels:
+ * With set_channel_credits(), the encoded size of every executed frame
+ * is returned to the receive window of its channel (see
+ * channel_credits).
+ *
+ * Fragmented payloads (frames with offset/total/transfer tags, see
+ * cmnd_sender::send_bytes()) are passed to the fragment_reassembler
+ * registered with set_reassembler(). BYTES paths receive the complete
+ * payload, CHUNK paths every fragment as a payload_chunk.
+ *
+ * Streamed frames (see cmnd_parser::set_stream_paths()) reach STREAM
+ * paths as a sequence of stream_chunk pieces, one per queued piece.
+ *
+ * Block frames ({b:...}) are delivered to paths whose expected type is
+ * data_type::BLOCK. Their values are decoded into the caller-provided
+ * buffer registered with set_block_buffer().
+ *
+ * Requests:
+ * A frame tagged with a request ID ({q<id>:...}) is a request; its
+ * handler reads the ID with current_request() and sends the reply with
+ * a reply tag carrying the same ID (cmnd_sender::tag_reply(), giving
+ * {r<id>:...}). On the requesting side set_response_handler() passes
+ * reply frames, decoded like commands, to a response handler instead of
+ * the path table. Requests from the peer are served as usual, so one
+ * link can both send and serve requests.
+ *
+ * Paths registered with set_request_table() are answered in place: the
+ * handler receives a reply_writer bound to the reply sender and tagged
+ * with the request's ID, and formats its reply directly into the
+ * outgoing frame. Request handlers always run inline.
+ *
+ * Handler dispatch:
+ * By default handlers run inline from poll(). With
+ * set_handler_dispatch() every handler call is passed to a dispatch
+ * function instead, which may queue it for another thread. Control
+ * frames are still handled inline.
+ *
+ * @note At most one frame is executed per poll() call.
  * @note Commands with mismatched types are silently dropped.
  */
 class cmnd_executer
@@ -142,21 +353,257 @@ public:
     /**
      * @brief Executes the next available command
      *
-     * Pops a single command frame from the frame queue, matches it
+     * Takes a single command frame from the frame queue, matches it
      * against the path table, and invokes the corresponding handler.
+     * The frame leaves the queue only after the handler has returned,
+     * so the parser (e.g. in the RX interrupt) does not reuse its work
+     * buffer space while the handler still reads it.
      *
      * If no frame is available, this function returns immediately.
      *
      * @note This function never blocks.
      * @note This function executes at most one command per call.
+     * @note Not reentrant: handlers must not call poll().
      */
     void poll();
 
+    /**
+     * @brief Registers the decode buffer for block frames
+     *
+     * @param buffer Storage for decoded block values
+     * @param size   Number of floats in buffer
+     *
+     * @note Block frames with more values than size are dropped.
+     * @note Without a buffer all block frames are dropped.
+     */
+    void set_block_buffer(float* buffer, uint16_t size);
+
+    /**
+     * @brief Sets the sender used to answer control frames
+     *
+     * @param sender Sender on the link back to the peer (nullptr = no replies)
+     *
+     * @note Replies are sent from poll(), so the sender must be usable
+     *       from the context that calls poll().
+     */
+    void set_reply_sender(cmnd_sender* sender);
+
+    /**
+     * @brief Enables duplicate suppression and ACKs for sequenced frames
+     *
+     * @param link Reliable link of this peer (nullptr = sequence tags ignored)
+     */
+    void set_reliable_link(reliable_link* link);
+
+    /**
+     * @brief Registers the reassembler for fragmented payloads
+     *
+     * @param reassembler Reassembler (nullptr = fragments are dropped)
+     */
+    void set_reassembler(fragment_reassembler* reassembler);
+
+    /**
+     * @brief Enables channel flow control
+     *
+     * @param credits Channel state of this peer (nullptr = $credit ignored)
+     */
+    void set_channel_credits(channel_credits* credits);
+
+    /**
+     * @brief Enables XON/XOFF from the peer
+     *
+     * @param flow Flow control state of this peer (nullptr = $xon/$xoff ignored)
+     */
+    void set_flow_control(flow_control* flow);
+
+    /**
+     * @brief Routes handler calls through a dispatch function
+     *
+     * @param fn  Dispatch function (nullptr = call handlers directly)
+     * @param ctx Context pointer passed to fn
+     *
+     * @note Fragmented payloads are delivered by the fragment_reassembler;
+     *       register the same dispatch there.
+     */
+    void set_handler_dispatch(handler_dispatch fn, void* ctx);
+
+    /**
+     * @brief Passes reply frames to a response handler
+     *
+     * Used by the requesting peer. Payloads are decoded as INT, FLOAT,
+     * STRING or NONE from their content (text) or type byte (binary);
+     * no path table entry is needed.
+     *
+     * @param fn  Response handler (nullptr = reply frames are dispatched
+     *            like any other)
+     * @param ctx Context pointer passed to fn
+     */
+    void set_response_handler(response_handler fn, void* ctx);
+
+    /**
+     * @brief Registers the paths answered through a reply_writer
+     *
+     * Request-tagged frames whose path is in this table are passed to
+     * its handler instead of the path table; replies go to the sender
+     * set with set_reply_sender().
+     *
+     * @param table      Pointer to a static request_entry table (nullptr = none)
+     * @param table_size Number of entries in the table
+     */
+    void set_request_table(const request_entry* table, uint16_t table_size);
+
+    /**
+     * @brief Returns the request ID of the frame being executed
+     *
+     * Only valid on the thread calling poll(), i.e. not from handlers
+     * run elsewhere through set_handler_dispatch().
+     *
+     * @param id Set to the request ID
+     * @return false if the frame is not a request (or called outside a handler)
+     */
+    bool current_request(uint16_t& id) const;
+
+    /**
+     * @brief Returns the dictionary hash of this executer's path table
+     */
+    uint32_t table_hash() const { return dict_hash; }
+
 private:
+
+    /**
+     * @brief Dispatches one frame popped from the frame queue
+     *
+     * @param frame Frame to execute
+     */
+    void execute(const cmnd_frame& frame);
+
+    /**
+     * @brief Calls the handler of entry, or passes the call to the dispatch function
+     */
+    void invoke(const path_entry& entry, data_type type, const void* data, uint16_t count);
+
+    /**
+     * @brief Decodes a reply frame and passes it to the response handler
+     *
+     * @param frame Command frame with FRAME_TAG_REPLY
+     */
+    void dispatch_response(const cmnd_frame& frame);
+
+    /**
+     * @brief Decodes a request frame and passes it to its request handler
+     *
+     * @param entry Matched request table entry
+     * @param frame Command frame with FRAME_TAG_REQUEST
+     */
+    void dispatch_request(const request_entry& entry, const cmnd_frame& frame);
+
+    /**
+     * @brief Looks up a path in the request table
+     *
+     * @param path Null-terminated path string
+     * @return Matching entry, or nullptr if the path is not a request path
+     */
+    const request_entry* find_request(const char* path) const;
+
+    /**
+     * @brief Handles a reserved '$' control frame
+     *
+     * @param frame Control frame
+     */
+    void handle_control(const cmnd_frame& frame);
+
+    /**
+     * @brief Returns the entry with the given path ID
+     *
+     * @param id Path ID (table index)
+     * @return Matching entry, or nullptr if the ID is out of range
+     */
+    const path_entry* entry_by_id(uint16_t id) const;
+
+    /**
+     * @brief Looks up a path in the path table
+     *
+     * Paths of the form "#<id>" are resolved through entry_by_id().
+     *
+     * @param path Null-terminated path string
+     * @return Matching entry, or nullptr if the path is unknown
+     */
+    const path_entry* find_entry(const char* path) const;
+
+    /**
+     * @brief Validates, parses and dispatches one command payload
+     *
+     * @param entry    Matched path table entry
+     * @param data     Null-terminated CSV payload
+     * @param data_len Payload length in bytes
+     */
+    void dispatch(const path_entry& entry, const char* data, uint16_t data_len);
+
+    /**
+     * @brief Dispatches every entry of a batch frame
+     *
+     * @param frame Batch frame
+     */
+    void dispatch_batch(const cmnd_frame& frame);
+
+    /**
+     * @brief Dispatches a binary frame
+     *
+     * INT and FLOAT payloads are passed to the handler as aligned views
+     * into the work buffer, without any conversion.
+     *
+     * @param entry Matched path table entry
+     * @param frame Binary frame
+     */
+    void dispatch_binary(const path_entry& entry, const cmnd_frame& frame);
+
+    /**
+     * @brief Decodes a fragment and passes it to the reassembler
+     *
+     * @param entry Matched path table entry
+     * @param frame Fragment frame (offset, total and transfer tags set)
+     */
+    void dispatch_fragment(const path_entry& entry, const cmnd_frame& frame);
+
+    /**
+     * @brief Passes one piece of a streamed frame to its handler
+     *
+     * @param frame Streamed piece (stream != NONE)
+     */
+    void dispatch_stream(const cmnd_frame& frame);
+
+    /**
+     * @brief Decodes a block frame and invokes the handler
+     *
+     * @param entry Matched path table entry
+     * @param frame Block frame
+     */
+    void dispatch_block(const path_entry& entry, const cmnd_frame& frame);
+
     ring_buffer<cmnd_frame>& frame_queue;
 
     const path_entry* path_table;
     uint16_t          path_count;
+
+    float*            block_buf;       ///< Decode buffer for block frames
+    uint16_t          block_buf_size;  ///< Capacity of block_buf in floats
+
+    cmnd_sender*      reply;           ///< Sender for control replies
+    reliable_link*    link;            ///< ARQ state for sequenced frames
+    fragment_reassembler* fragments;   ///< Reassembly of fragmented payloads
+    channel_credits*  credits;         ///< Channel windows, or nullptr
+    flow_control*     flow;            ///< XON/XOFF state, or nullptr
+    const path_entry* stream_entry;    ///< Path of the open stream, or nullptr
+    uint32_t          stream_offset;   ///< Payload bytes streamed so far
+    uint32_t          dict_hash;       ///< path_table_hash() of path_table
+    handler_dispatch  dispatch_fn;     ///< Replaces direct handler calls, or nullptr
+    void*             dispatch_ctx;    ///< Context of dispatch_fn
+    response_handler  response_fn;     ///< Receives replies, or nullptr
+    void*             response_ctx;    ///< Context of response_fn
+    const cmnd_frame* current;         ///< Frame being executed, or nullptr
+    const request_entry* request_table; ///< Paths answered in place, or nullptr
+    uint16_t          request_count;   ///< Number of entries in request_table
+    const request_entry* serving;      ///< Request being decoded, or nullptr
 };
 
 #endif // PATHWIRE_INC_CORE_CMND_EXECUTER_H_
@@ -20,6 +20,129 @@
 
 #include <stdint.h>
 
+
+/**
+ * @enum data_type
+ * @brief Supported PathWire data payload types
+ *
+ * The detected or expected data type determines how the data payload
+ * is parsed and passed to the handler.
+ */
+enum class data_type : uint8_t
+{
+    NONE,     ///< No data payload (trigger command)
+    INT,      ///< Comma-separated signed integers (e.g. "1,-2,3")
+    FLOAT,    ///< Comma-separated floats (e.g. "1.25,-0.5")
+    STRING,   ///< Comma-separated strings (e.g. "foo,bar")
+    BLOCK,    ///< Time-series block of float samples (see sample_block)
+    BYTES,    ///< Raw byte payload, reassembled from fragments
+    CHUNK,    ///< Raw byte payload delivered piecewise (see payload_chunk)
+    STREAM    ///< Text payload streamed while it arrives (see stream_chunk)
+};
+
+
+/**
+ * @enum wire_mode
+ * @brief Encoding used on the wire
+ *
+ * TEXT frames use the human-readable {p:<path>:d:<csv_data>} format.
+ *
+ * BINARY frames are COBS-encoded packets terminated by a 0x00 byte:
+ *   <kind:1> <type:1> <path_len:1> <path> <payload>
+ *
+ * A path_len of 0 means the path is replaced by its 2-byte path ID
+ * (little-endian) negotiated through the path dictionary:
+ *   <kind:1> <type:1> <0x00> <path_id:2> <payload>
+ *
+ * The payload is raw little-endian data:
+ * - INT    : int32_t[n]
+ * - FLOAT  : float[n]
+ * - STRING : n null-terminated strings
+ * - NONE   : empty
+ * - BLOCK  : base_time:u32, period:u32, samples:u16, channels:u16,
+ *            float[samples * channels] (column-wise)
+ * - BYTES  : raw bytes (fragments; sent as hex digits in TEXT frames)
+ */
+enum class wire_mode : uint8_t
+{
+    TEXT,    ///< Human-readable text frames
+    BINARY   ///< COBS-framed binary packets
+};
+
+
+/**
+ * @def PATH_ID_NONE
+ * @brief Marks a frame that carries its path as a string
+ */
+#define PATH_ID_NONE 0xFFFFU
+
+
+/**
+ * @enum frame_tag
+ * @brief Optional header tags (combine with |)
+ *
+ * Tags precede the frame kind. In TEXT frames each tag is written as
+ * <letter><decimal value>: directly after '{':
+ *   {s12:p:ctrl/arm:d:1}
+ * In BINARY packets each tag is <letter:1><value:2 LE> in front of the
+ * kind byte.
+ */
+enum frame_tag : uint8_t
+{
+    FRAME_TAG_SEQ    = 1U << 0,  ///< 's': reliable-delivery sequence number
+    FRAME_TAG_OFFSET = 1U << 1,  ///< 'o': byte offset of a fragment
+    FRAME_TAG_TOTAL  = 1U << 2,  ///< 't': total size of a fragmented payload
+    FRAME_TAG_XFER   = 1U << 3,  ///< 'x': transfer ID of a fragmented payload
+    FRAME_TAG_CHANNEL = 1U << 4, ///< 'c': logical channel (absent = channel 0)
+    FRAME_TAG_REQUEST = 1U << 5, ///< 'q': request ID
+    FRAME_TAG_REPLY  = 1U << 6   ///< 'r': request ID of the request answered
+};
+
+
+/**
+ * @def FRAGMENT_BLOCK
+ * @brief Alignment of fragment offsets in bytes
+ *
+ * Every fragment except the last carries a multiple of FRAGMENT_BLOCK
+ * bytes, so the receiver can track coverage with one bit per block.
+ */
+#ifndef FRAGMENT_BLOCK
+#define FRAGMENT_BLOCK 16
+#endif
+
+
+/**
+ * @enum frame_kind
+ * @brief Frame kinds, identified by the letter following '{'
+ *
+ * The enumerator values are the wire characters.
+ */
+enum class frame_kind : uint8_t
+{
+    COMMAND = 'p',  ///< {p:<path>:d:<csv_data>}
+    BLOCK   = 'b',  ///< {b:<path>:d:<t0>,<period>,<samples>,<column-wise values>}
+    BATCH   = 'm'   ///< {m:<path>:d:<csv_data>;<path>:d:<csv_data>;...}
+};
+
+
+/**
+ * @enum stream_phase
+ * @brief Position of a frame within a streamed payload
+ *
+ * The parser emits a streamed command frame as a sequence of pieces:
+ * BEGIN, any number of DATA, then END (frame complete and valid) or
+ * ABORT (frame malformed, truncated or failing its CRC).
+ */
+enum class stream_phase : uint8_t
+{
+    NONE,   ///< Regular, completely buffered frame
+    BEGIN,  ///< Path known, no payload bytes yet
+    DATA,   ///< Next payload bytes
+    END,    ///< Last payload bytes; the frame is complete
+    ABORT   ///< The frame was discarded; no further pieces follow
+};
+
+
 /**
  * @struct cmnd_frame
  * @brief Parsed PathWire command representation
@@ -28,6 +151,16 @@
  * sections. The memory backing these pointers must remain valid while
  * the frame is in use.
  *
+ * For BINARY frames, data points to the raw payload, which the parser
+ * places at a 4-byte aligned address.
+ *
+ * For streamed pieces (stream != NONE), data holds only the payload
+ * bytes of that piece and is not null-terminated.
+ *
+ * For BATCH frames, path and data describe the first entry and all
+ * entries are stored back to back as null-terminated strings:
+ *   path0 '\0' data0 '\0' path1 '\0' data1 '\0' ...
+ *
  * @note This structure performs no validation.
  * @note Lifetime is managed externally by the parser buffer.
  */
@@ -38,6 +171,25 @@ struct cmnd_frame
 
     const char* data;     ///< Pointer to data payload (CSV or raw)
     uint16_t    data_len; ///< Length of data payload
+
+    frame_kind  kind;     ///< Frame kind
+    uint16_t    entries;  ///< Number of path/data pairs (1 unless BATCH)
+
+    data_type   type;     ///< Payload type (BINARY frames only)
+    wire_mode   wire;     ///< Encoding the frame was received in
+
+    uint16_t    path_id;  ///< Binary path ID, or PATH_ID_NONE (path is valid)
+
+    uint8_t     tags;     ///< frame_tag flags present in the header
+    uint16_t    seq;      ///< Sequence number (FRAME_TAG_SEQ)
+    uint16_t    offset;   ///< Fragment offset (FRAME_TAG_OFFSET)
+    uint16_t    total;    ///< Fragmented payload size (FRAME_TAG_TOTAL)
+    uint16_t    xfer;     ///< Transfer ID (FRAME_TAG_XFER)
+    uint8_t     channel;  ///< Logical channel (FRAME_TAG_CHANNEL)
+    uint16_t    request;  ///< Request ID (FRAME_TAG_REQUEST or FRAME_TAG_REPLY)
+
+    stream_phase stream;  ///< Piece of a streamed frame, or NONE
+    uint16_t    wire_len; ///< Encoded size of the frame on the link in bytes
 };
 
 #endif // PATHWIRE_INC_CORE_CMND_FRAME_H_
@@ -9,7 +9,34 @@
  * suitable for embedded systems and interrupt-driven RX paths.
  *
  * Frame format:
- *   {p:<path>:d:<data>}
+ *   {<kind>:<path>:d:<data>}
+ *
+ * where kind is 'p' for command frames and 'b' for time-series block
+ * frames (see frame_kind). Batch frames ('m') carry several
+ * ';'-separated <path>:d:<data> entries in one frame:
+ *   {m:ctrl/kp:d:1.5;ctrl/ki:d:0.2;ctrl/mode:d:3}
+ *
+ * Batch entries are split in place while the bytes are copied into the
+ * work buffer, so no additional copy is made.
+ *
+ * In binary wire mode (see wire_mode) the parser instead decodes
+ * COBS-framed packets on the fly. The path is placed in the work buffer
+ * so that the payload following it starts on a 4-byte boundary, which
+ * lets handlers read int32/float arrays in place.
+ *
+ * Frames may start with header tags (see frame_tag), e.g. the sequence
+ * number of reliable delivery: {s12:p:ctrl/arm:d:1}
+ *
+ * With set_crc_mode() every frame must carry a CRC trailer (see
+ * crc_mode). The CRC is updated byte by byte while the frame is copied,
+ * and frames that fail the check are counted and dropped before they
+ * reach the frame queue.
+ *
+ * Command frames addressed to a STREAM path (see set_stream_paths())
+ * are not buffered as a whole: their payload is emitted in pieces as
+ * it arrives (see stream_phase), and the work buffer space behind the
+ * path is reused once the executer has consumed the pieces. The size of
+ * such payloads is therefore not limited by the work buffer.
  *
  * Example:
  *   {p:sensor/imu:d:1.0,2.0,3.0}
@@ -21,7 +48,8 @@
  * - ISR-safe when used with an ISR-safe ring_buffer
  *
  * @note Parsed frames reference slices of the provided work buffer.
- *       The consumer must process frames before the buffer is reused.
+ *       Frames are placed one after another and the buffer is only
+ *       reused from the start once the frame queue has been drained.
  */
 #ifndef PATHWIRE_INC_CORE_CMND_PARSER_H_
 #define PATHWIRE_INC_CORE_CMND_PARSER_H_
@@ -29,6 +57,10 @@
 #include <stdint.h>
 #include "core/ring_buffer.h"
 #include "core/cmnd_frame.h"
+#include "core/crc.h"
+#include "core/frame_notifier.h"
+
+struct path_entry;
 
 /**
  * @class cmnd_parser
@@ -82,6 +114,7 @@ public:
      * @brief Resets the parser to its initial state
      *
      * Clears internal indices, pointers, and state machine state.
+     * Space of frames still waiting in the frame queue is preserved.
      *
      * This function is automatically invoked on:
      * - Frame completion
@@ -103,10 +136,145 @@ public:
      *
      * @note At most one frame is emitted per successful parse sequence.
      * @note Malformed frames are silently discarded.
+     * @note Returns with bytes left in the RX buffer once the frames
+     *       queued by this call fill the work buffer or the frame queue;
+     *       call again after the executer has consumed them.
      */
     void poll();
 
+    /**
+     * @brief Selects the wire encoding of incoming frames
+     *
+     * @param mode TEXT (default) or BINARY
+     *
+     * @note Resets any partially parsed frame.
+     */
+    void set_wire_mode(wire_mode mode);
+
+    /**
+     * @brief Requires a CRC trailer on incoming frames
+     *
+     * @param mode NONE (default), CRC16_CCITT or CRC32C
+     *
+     * @note Resets any partially parsed frame.
+     * @note Frames without a valid trailer are dropped.
+     */
+    void set_crc_mode(crc_mode mode);
+
+    /**
+     * @brief Returns the number of frames dropped by the CRC check
+     */
+    uint32_t crc_errors() const { return crc_error_count; }
+
+    /**
+     * @brief Enables streaming for the STREAM paths of a path table
+     *
+     * Untagged text command frames whose path has the expected type
+     * data_type::STREAM are emitted in pieces while they arrive.
+     * Usually the executer's table is passed.
+     *
+     * @param table      Path table (nullptr = streaming disabled)
+     * @param table_size Number of entries in the table
+     *
+     * @note The work buffer must hold the path plus at least one byte.
+     * @note If the executer falls behind, poll() leaves bytes in the RX
+     *       buffer until the consumed pieces can be overwritten.
+     * @note Binary frames are always buffered as a whole.
+     */
+    void set_stream_paths(const path_entry* table, uint16_t table_size);
+
+    /**
+     * @brief Registers a frame-ready callback
+     *
+     * fn is called after every push to the frame queue, so the executer
+     * can sleep until there is work instead of being polled.
+     *
+     * @param fn  Callback (nullptr disables notifications)
+     * @param ctx Context pointer passed to fn
+     */
+    void set_frame_notifier(frame_notify_fn fn, void* ctx);
+
 private:
+
+    /**
+     * @brief Pushes a frame into the frame queue and fires the notifier
+     *
+     * @param frame Completed frame or stream piece
+     * @return false if the frame queue is full
+     */
+    bool queue_frame(const cmnd_frame& frame);
+
+    /**
+     * @brief Pushes the completed text frame into the frame queue
+     */
+    void emit_frame();
+
+    /**
+     * @brief Stores the value of the header tag just read
+     */
+    void store_tag();
+
+    /**
+     * @brief Moves the frame in progress to the start of the work buffer
+     *
+     * Done once the frame queue has been drained, so that space used
+     * by consumed frames is reclaimed even if no frame boundary falls
+     * on a drained queue.
+     */
+    void compact();
+
+    /**
+     * @brief Returns true if input must wait for the executer
+     *
+     * Frames queued by the current poll() still occupy the work buffer
+     * (or the frame queue is full). Instead of dropping the frame in
+     * progress, the remaining bytes stay in the RX buffer.
+     *
+     * @param need Work buffer bytes the next input byte may use
+     */
+    bool hold_input(uint16_t need);
+
+    /**
+     * @brief Returns true if path_ptr names a STREAM path
+     */
+    bool is_stream_path() const;
+
+    /**
+     * @brief Pushes the unsent payload bytes of a streamed frame
+     *
+     * @param phase Phase of the piece
+     * @return false if the frame queue is full
+     */
+    bool push_piece(stream_phase phase);
+
+    /**
+     * @brief Makes room for more payload of a streamed frame
+     *
+     * Flushes pending bytes and, once the frame queue has been drained,
+     * rewinds the write index to the start of the payload.
+     *
+     * @return false if the space is still referenced by queued pieces
+     */
+    bool rewind_stream();
+
+    /**
+     * @brief poll() implementation for binary wire mode
+     */
+    void poll_binary();
+
+    /**
+     * @brief Consumes one COBS-decoded packet byte
+     *
+     * @param b Decoded byte
+     * @return false if the packet is malformed or does not fit
+     */
+    bool accept_binary(uint8_t b);
+
+    /**
+     * @brief Emits the decoded binary packet as a frame
+     */
+    void finish_binary();
+
     ring_buffer<uint8_t>& rx_queue;
     ring_buffer<cmnd_frame>& frame_queue;
 
@@ -118,13 +286,15 @@ private:
      */
     enum class state_t : uint8_t {
         WAIT_START,     ///< Waiting for '{'
-        WAIT_P,         ///< Expecting 'p'
-        WAIT_P_COLON,   ///< Expecting ':'
+        WAIT_KIND,      ///< Expecting frame kind ('p', 'b' or 'm') or a tag
+        READ_TAG,       ///< Reading a header tag value
+        WAIT_KIND_COLON,///< Expecting ':'
         READ_PATH,      ///< Reading path string
         WAIT_D,         ///< Expecting 'd'
         WAIT_D_COLON,   ///< Expecting ':'
         READ_DATA,      ///< Reading CSV data payload
         WAIT_END,       ///< Waiting for '}'
+        WAIT_CRC,       ///< Reading the hex CRC trailer
         ERROR           ///< Error recovery state
     };
 
@@ -135,6 +305,7 @@ private:
     char*    workBuffer;      ///< Scratch buffer used to assemble frames
     uint16_t work_buf_size;   ///< Total size of the scratch buffer
     uint16_t idx;             ///< Current write index into the buffer
+    uint16_t frame_start;     ///< Start of the current frame in the buffer
 
     // ------------------------------------------------------------------
     // Frame field pointers
@@ -146,6 +317,62 @@ private:
     const char* data_ptr;     ///< Pointer to parsed data payload
     uint16_t    data_len;     ///< Length of the parsed data
 
+    frame_kind  kind;         ///< Kind of the frame being parsed
+    uint16_t    entries;      ///< Completed entries of a batch frame
+
+    // ------------------------------------------------------------------
+    // Binary mode state
+    // ------------------------------------------------------------------
+
+    wire_mode   mode;         ///< Wire encoding of incoming frames
+    data_type   bin_type;     ///< Payload type of the current packet
+    uint8_t     bin_path_len; ///< Path length of the current packet (0 = path ID)
+    uint16_t    bin_path_id;  ///< Path ID of the current packet
+    uint16_t    bin_head;     ///< Header length of the current packet
+    uint16_t    bin_base;     ///< Offset of the kind byte (after tags)
+    uint16_t    bin_pos;      ///< Decoded bytes of the current packet
+    uint8_t     cobs_left;    ///< Data bytes left in the current COBS block
+    bool        cobs_zero;    ///< A zero is due before the next COBS block
+
+    // ------------------------------------------------------------------
+    // CRC trailer state
+    // ------------------------------------------------------------------
+
+    crc_mode    crc;             ///< Required trailer
+    uint32_t    crc_reg;         ///< Running CRC of the current frame
+    uint32_t    crc_value;       ///< Received text trailer
+    uint8_t     crc_digits;      ///< Hex digits of the trailer read so far
+    uint32_t    crc_error_count; ///< Frames dropped by the CRC check
+
+    // ------------------------------------------------------------------
+    // Header tags
+    // ------------------------------------------------------------------
+
+    uint8_t     tags;         ///< frame_tag flags of the current frame
+    uint16_t    seq;          ///< Sequence number tag
+    uint16_t    offset;       ///< Fragment offset tag
+    uint16_t    total;        ///< Fragmented payload size tag
+    uint16_t    xfer;         ///< Transfer ID tag
+    uint8_t     channel;      ///< Channel tag
+    uint16_t    request;      ///< Request ID tag
+    uint16_t    frame_bytes;  ///< Bytes of the current frame read so far
+    uint8_t     tag_letter;   ///< Tag being read
+    uint32_t    tag_value;    ///< Value of the tag being read
+
+    // ------------------------------------------------------------------
+    // Streaming state
+    // ------------------------------------------------------------------
+
+    const path_entry* stream_table;  ///< Table of STREAM paths (may be nullptr)
+    uint16_t    stream_table_size;   ///< Entries in stream_table
+    bool        streaming;    ///< The current frame is being streamed
+    bool        stream_drain; ///< Wait for the queue to drain after a stream
+    uint16_t    stream_base;  ///< Payload start of the streamed frame
+    uint16_t    stream_sent;  ///< Payload bytes before this index were emitted
+
+    frame_notify_fn frame_notify;  ///< Frame-ready callback, or nullptr
+    void*       frame_ctx;    ///< Context of frame_notify
+
     state_t state;            ///< Current parser FSM state
 };
 
@@ -13,7 +13,9 @@
  *
  * - No dynamic memory allocation
  * - No blocking operations
- * - All output is byte-wise pushed to a TX queue
+ * - All output is byte-wise pushed to a TX queue, or staged and
+ *   published as a whole frame in multi-producer mode
+ * - Optional binary wire mode (COBS-framed packets, see wire_mode)
  *
  * @note This component does NOT perform transmission itself.
  *       It only prepares and enqueues bytes for transmission.
@@ -25,7 +27,14 @@
 #include <stdint.h>
 
 #include "core/ring_buffer.h"
+#include "core/cmnd_frame.h"
+#include "core/cmnd_executer.h"
+#include "core/crc.h"
+#include "core/mp_ring_buffer.h"
+#include "core/tx_lanes.h"
 #include "core/tx_notifier.h"
+#include "core/channel_credits.h"
+#include "core/flow_control.h"
 
 
 
@@ -47,6 +56,36 @@
  * - Threading or scheduling
  * - Buffer ownership or lifetime management
  *
+ * Multi-producer mode:
+ * Each producer task owns its own cmnd_sender constructed with a private
+ * staging buffer and a shared mp_ring_buffer. Frames are formatted into
+ * the staging buffer and published with a single reserve/commit, so
+ * frames from different producers never interleave on the wire and no
+ * mutex is required around send calls.
+ *
+ * A staging cmnd_sender may also be bound to one lane of a tx_lanes
+ * set, so replies and telemetry can be sent with different priorities
+ * over the same transport.
+ *
+ * Path dictionary:
+ * When the peer's path table is registered with set_path_dictionary(),
+ * frames to known paths are sent with their table index ("#<id>" or a
+ * 2-byte binary ID) once the peer has confirmed the same table hash
+ * through the $dict handshake. Until then, or when the hashes differ,
+ * path strings are sent.
+ *
+ * CRC trailer:
+ * set_crc_mode() appends a CRC-16/CCITT or CRC-32C trailer to every
+ * frame (see crc_mode). In direct mode the CRC is updated as each byte
+ * is queued; staged frames are checksummed in one pass over the staging
+ * buffer.
+ *
+ * Binary mode:
+ * With set_wire_mode(wire_mode::BINARY) values are copied as raw
+ * little-endian words instead of being formatted as text, and the
+ * packet is COBS-encoded in the staging buffer before it is queued.
+ * The staging buffer must hold the encoded packet plus delimiter.
+ *
  * @note The provided ring_buffer must outlive this object.
  * @note All methods return false on TX buffer overflow.
  */
@@ -64,10 +103,241 @@ public:
 	* @note The caller is responsible for ensuring ISR-safety if used in interrupts.
 	*/
 	cmnd_sender(ring_buffer<uint8_t>& tx_buffer)
-	        : tx_queue(tx_buffer)
+	        : tx_queue(&tx_buffer),
+	          mp_queue(nullptr),
+	          lanes(nullptr),
+	          lane(0),
+	          stage(nullptr),
+	          stage_size(0)
 	    {}
 
 
+	/**
+	* @brief Constructs a staging command sender using an external TX buffer
+	*
+	* Frames are formatted into the staging buffer and pushed into the
+	* TX buffer only once complete, so a frame is either queued entirely
+	* or not at all. Required for binary wire mode.
+	*
+	* @param tx_buffer         Reference to a byte-oriented ring buffer used for output
+	* @param staging_buffer    Buffer owned by this sender
+	* @param staging_size      Size of the staging buffer in bytes
+	*/
+	cmnd_sender(ring_buffer<uint8_t>& tx_buffer,
+	            char* staging_buffer,
+	            uint16_t staging_size)
+	        : tx_queue(&tx_buffer),
+	          mp_queue(nullptr),
+	          lanes(nullptr),
+	          lane(0),
+	          stage(staging_buffer),
+	          stage_size(staging_size)
+	    {}
+
+
+	/**
+	* @brief Constructs a multi-producer command sender
+	*
+	* Frames are formatted into the private staging buffer and published
+	* to the shared queue as one record when the frame is complete.
+	*
+	* @param tx_buffer         Shared multi-producer TX queue
+	* @param staging_buffer    Private buffer owned by this producer
+	* @param staging_size      Size of the staging buffer in bytes
+	*
+	* @note The staging buffer must hold the largest frame sent by this producer.
+	* @note Each producer needs its own cmnd_sender instance.
+	*/
+	cmnd_sender(mp_ring_buffer& tx_buffer,
+	            char* staging_buffer,
+	            uint16_t staging_size)
+	        : tx_queue(nullptr),
+	          mp_queue(&tx_buffer),
+	          lanes(nullptr),
+	          lane(0),
+	          stage(staging_buffer),
+	          stage_size(staging_size)
+	    {}
+
+
+	/**
+	* @brief Constructs a command sender bound to a priority TX lane
+	*
+	* Frames are formatted into the private staging buffer and queued on
+	* the given lane as one complete frame.
+	*
+	* @param tx_lanes_set      Lane set drained by the transport
+	* @param lane_index        Lane index returned by tx_lanes::add_lane()
+	* @param staging_buffer    Private buffer owned by this producer
+	* @param staging_size      Size of the staging buffer in bytes
+	*/
+	cmnd_sender(tx_lanes& tx_lanes_set,
+	            uint8_t lane_index,
+	            char* staging_buffer,
+	            uint16_t staging_size)
+	        : tx_queue(nullptr),
+	          mp_queue(nullptr),
+	          lanes(&tx_lanes_set),
+	          lane(lane_index),
+	          stage(staging_buffer),
+	          stage_size(staging_size)
+	    {}
+
+
+	/**
+	 * @brief Selects the wire encoding of outgoing frames
+	 *
+	 * In BINARY mode frames are sent as COBS-framed packets with raw
+	 * little-endian payloads (see wire_mode). Batch frames are only
+	 * available in TEXT mode.
+	 *
+	 * @param mode TEXT (default) or BINARY
+	 * @return false if BINARY is requested without a staging buffer
+	 */
+	bool set_wire_mode(wire_mode mode);
+
+
+	/**
+	 * @brief Selects the CRC trailer appended to outgoing frames
+	 *
+	 * @param mode NONE (default), CRC16_CCITT or CRC32C
+	 *
+	 * @note The receiving parser must use the same mode.
+	 */
+	void set_crc_mode(crc_mode mode) { crc = mode; }
+
+
+	/**
+	 * @brief Sends all following frames on a logical channel
+	 *
+	 * Frames are tagged with the channel and charged against the credit
+	 * the peer granted for it (see channel_credits). A frame that
+	 * exceeds the remaining credit is refused like a full TX queue.
+	 *
+	 * @param credits Channel state of this peer (nullptr = channel 0)
+	 * @param channel Channel 0..CHANNEL_MAX-1 (0 = not flow-controlled)
+	 * @return false if the channel is invalid, or if a flow-controlled
+	 *         channel is requested without a staging buffer
+	 */
+	bool set_channel(channel_credits* credits, uint8_t channel);
+
+
+	/**
+	 * @brief Holds back frames while the peer has sent XOFF
+	 *
+	 * While flow->peer_paused() is true, every frame except control
+	 * frames ('$' paths) is refused like a full TX queue.
+	 *
+	 * @param flow Flow control state of this peer (nullptr = never paused)
+	 */
+	void set_flow_control(flow_control* flow) { flow_ctl = flow; }
+
+
+	/**
+	 * @brief Registers the TX-ready callback of this sender
+	 *
+	 * Called whenever bytes were queued (once per burst), typically to
+	 * start the transport that drains this sender's queue. Senders that
+	 * share a queue register the same callback.
+	 *
+	 * @param fn  Callback (nullptr disables notifications)
+	 * @param ctx Context pointer passed to fn
+	 */
+	void set_tx_notifier(tx_notify_fn fn, void* ctx) { tx_ready.fn = fn; tx_ready.ctx = ctx; }
+
+
+	/**
+	 * @brief Tags the next frame with a request ID
+	 *
+	 * A request carries an ID chosen by the requester; the reply to it
+	 * carries the same ID in a reply tag (see tag_reply()):
+	 *   {q7:p:param/get:d:3}  →  {r7:p:param/value:d:3,250}
+	 *
+	 * The tag applies to the next frame only, and is dropped if that
+	 * frame is held back by flow control.
+	 *
+	 * @param id Request ID
+	 */
+	void tag_request(uint16_t id)
+	{
+		next_tags    = (uint8_t)((next_tags & ~FRAME_TAG_REPLY) | FRAME_TAG_REQUEST);
+		next_request = id;
+	}
+
+
+	/**
+	 * @brief Tags the next frame as the reply to a request
+	 *
+	 * @param id Request ID of the request answered
+	 *           (see cmnd_executer::current_request())
+	 */
+	void tag_reply(uint16_t id)
+	{
+		next_tags    = (uint8_t)((next_tags & ~FRAME_TAG_REQUEST) | FRAME_TAG_REPLY);
+		next_request = id;
+	}
+
+
+	/**
+	 * @brief Registers the peer's path table for path ID compression
+	 *
+	 * Path IDs stay disabled until accept_dictionary() confirms that the
+	 * peer uses a table with the same hash.
+	 *
+	 * @param table      Copy of the peer's path table (same order)
+	 * @param table_size Number of entries in the table
+	 */
+	void set_path_dictionary(const path_entry* table, uint16_t table_size);
+
+
+	/**
+	 * @brief Asks the peer to announce its path table hash
+	 *
+	 * Sends a $dict frame with no data. The peer's executer answers with
+	 * announce_dictionary() on its reply sender.
+	 *
+	 * @return true if the request was queued
+	 */
+	bool request_dictionary();
+
+
+	/**
+	 * @brief Announces the hash of the local path table to the peer
+	 *
+	 * @param hash Local table hash (see cmnd_executer::table_hash())
+	 * @return true if the announcement was queued
+	 */
+	bool announce_dictionary(uint32_t hash);
+
+
+	/**
+	 * @brief Compares the peer's table hash with the registered dictionary
+	 *
+	 * Enables path IDs if the hashes match and disables them otherwise.
+	 * Called by cmnd_executer when a $dict announcement arrives.
+	 *
+	 * @param peer_hash Table hash announced by the peer
+	 * @return true if path IDs are now in use
+	 */
+	bool accept_dictionary(uint32_t peer_hash);
+
+
+	/**
+	 * @brief Returns true if frames are sent with path IDs
+	 */
+	bool path_ids_active() const { return ids_active; }
+
+
+	/**
+	 * @brief Returns the number of bytes this sender has queued
+	 *
+	 * Counts every byte put into the TX queue (wrapping at 2^32),
+	 * including the partial frame a direct-mode sender leaves behind
+	 * when the queue fills.
+	 */
+	uint32_t queued_bytes() const { return queued_total; }
+
+
 	/**
 	 * @brief Sends a command frame with no data payload
 	 *
@@ -161,33 +431,219 @@ public:
     );
 
 
+    /**
+     * @brief Sends a time-series block frame
+     *
+     * Sends many samples of one path in a single frame. The frame header
+     * carries the timestamp of the first sample and the sample period;
+     * values are laid out column-wise so each channel is contiguous.
+     *
+     * Frame example (2 samples, 3 channels):
+     *   {b:sens/IMU/gyro:d:1000,1,2,0.010,0.011,0.020,0.021,0.030,0.031}
+     *
+     * @param path      Null-terminated path string
+     * @param base_time Timestamp of the first sample
+     * @param period    Time between consecutive samples
+     * @param values    samples * channels floats, column-wise
+     *                  (values[c * samples + s])
+     * @param samples   Samples per channel
+     * @param channels  Number of channels
+     *
+     * @return true if the entire frame was successfully enqueued
+     * @return false if the TX buffer overflows during frame construction
+     */
+    bool send_block(
+        const char* path,
+        uint32_t base_time,
+        uint32_t period,
+        const float* values,
+        uint16_t samples,
+        uint16_t channels
+    );
+
+
+    /**
+     * @brief Sends a raw byte payload as numbered fragments
+     *
+     * The payload is split into fragments of at most chunk bytes, each
+     * tagged with its byte offset, the total size and a transfer ID,
+     * so the payload can be larger than the receiver's work buffer.
+     * The receiver reassembles the fragments in any order (see
+     * fragment_reassembler).
+     *
+     * Frame example (text mode, bytes as hex digits):
+     *   {o32:t100:x7:p:cal/table:d:0A1B2C...}
+     *
+     * @param path  Null-terminated command path
+     * @param data  Payload bytes
+     * @param len   Payload size in bytes
+     * @param chunk Maximum payload bytes per fragment (rounded down to a
+     *              multiple of FRAGMENT_BLOCK)
+     *
+     * @return true if all fragments were queued
+     * @return false if a fragment could not be queued; fragments already
+     *         sent are discarded by the receiver's timeout
+     */
+    bool send_bytes(
+        const char* path,
+        const uint8_t* data,
+        uint16_t len,
+        uint16_t chunk
+    );
+
+
+    /**
+     * @brief Starts a batch frame
+     *
+     * Subsequent send_trigger(), send_int(), send_float() and
+     * send_string() calls append entries to a single batch frame
+     * instead of emitting separate frames, until end_batch() is called.
+     *
+     * Frame example:
+     *   {m:ctrl/kp:d:1.500;ctrl/ki:d:0.200;ctrl/mode:d:3}
+     *
+     * @return true if the batch header was successfully enqueued
+     * @return false if the TX buffer overflows
+     *
+     * @note String values inside a batch must not contain ';'.
+     * @note send_block() is rejected while a batch is open.
+     */
+    bool begin_batch();
+
+
+    /**
+     * @brief Completes a batch frame started by begin_batch()
+     *
+     * In staging modes the whole batch is published at once, so all
+     * entries reach the receiver together.
+     *
+     * @return true if the batch was successfully enqueued
+     * @return false if the TX buffer overflows
+     */
+    bool end_batch();
+
+
+    /**
+     * @brief Starts a burst of frames
+     *
+     * TX-ready notifications are deferred until end_burst(), so a group
+     * of frames is handed to the transport with a single notification
+     * instead of one per byte or frame.
+     */
+    void begin_burst();
+
+
+    /**
+     * @brief Ends a burst of frames
+     *
+     * Issues one TX-ready notification if any byte was queued since
+     * begin_burst().
+     */
+    void end_burst();
+
+
+    /**
+     * @brief Queues an already encoded frame unchanged
+     *
+     * Used to forward frames received on another link (see
+     * frame_router). The bytes are published as one unit, like a staged
+     * frame, in any queue mode. Wire mode, CRC, tags and channel credits
+     * of this sender are not applied; the frame is held back like any
+     * other while the peer is paused (see flow_control).
+     *
+     * @param frame Encoded frame (text frame with trailer, or COBS
+     *              packet with its 0x00 delimiter)
+     * @param len   Frame length in bytes
+     *
+     * @return true if the frame was queued
+     * @return false if the queue has no room or the peer is paused
+     */
+    bool send_raw(const uint8_t* frame, uint16_t len);
+
+
 
 private:
-	ring_buffer<uint8_t>& tx_queue;
+	ring_buffer<uint8_t>* tx_queue;   ///< Direct TX queue (single producer)
+	mp_ring_buffer*       mp_queue;   ///< Shared TX queue (multi-producer)
+	tx_lanes*             lanes;      ///< Priority lane set (multi-producer)
+	uint8_t               lane;       ///< Lane index within lanes
+
+	char*    stage;       ///< Staging buffer (nullptr = direct byte-wise mode)
+	uint16_t stage_size;  ///< Size of the staging buffer
+	uint16_t stage_len     = 0;  ///< Bytes of the current frame staged so far
+
+	wire_mode mode         = wire_mode::TEXT;  ///< Outgoing wire encoding
+	crc_mode  crc          = crc_mode::NONE;   ///< Frame trailer
+	uint32_t  crc_reg      = 0;  ///< Running CRC of the current direct frame
+
+	tx_notifier tx_ready   = { nullptr, nullptr };  ///< TX-ready callback
+	uint32_t  queued_total = 0;  ///< Bytes put into the TX queue
+
+	bool     burst_open    = false;  ///< Notifications are deferred
+	bool     burst_pending = false;  ///< Data was queued during the burst
+
+	bool     batch_open    = false;  ///< Entries are appended to a batch frame
+	uint16_t batch_entries = 0;      ///< Entries written to the open batch
+
+	const path_entry* dict_table = nullptr;  ///< Peer path table
+	uint16_t          dict_size  = 0;        ///< Entries in dict_table
+	uint32_t          dict_hash  = 0;        ///< path_table_hash() of dict_table
+	bool              ids_active = false;    ///< Peer confirmed dict_hash
+
+	uint8_t  next_tags = 0;  ///< frame_tag flags for the next frame
+	uint16_t next_seq    = 0;  ///< Sequence number for the next frame
+	uint16_t next_offset = 0;  ///< Fragment offset for the next frame
+	uint16_t next_total  = 0;  ///< Fragmented payload size for the next frame
+	uint16_t next_xfer   = 0;  ///< Transfer ID of the next fragmented payload
+	uint16_t next_request = 0; ///< Request ID for the next frame
+
+	channel_credits* credits = nullptr;  ///< Credit state of channel_id
+	uint8_t  channel_id  = 0;  ///< Channel of all frames (0 = untagged)
+
+	flow_control* flow_ctl = nullptr;  ///< Peer pause state, or nullptr
+
+	friend class reliable_link;
+	friend class reply_writer;
+
+
+	/**
+	 * @brief Looks up the path ID of a path in the peer dictionary
+	 *
+	 * @param path Null-terminated path string
+	 * @param id   Receives the path ID
+	 * @return true if IDs are active and the path is in the dictionary
+	 */
+	bool lookup_id(const char* path, uint16_t& id) const;
 
 
 	/**
 	 * @brief Starts a PathWire command frame
 	 *
 	 * Writes the fixed frame prefix to the TX buffer:
-	 *   {p:<path>:d:
+	 *   {<kind>:<path>:d:
+	 *
+	 * Inside a batch only the entry prefix is written:
+	 *   [;]<path>:d:
 	 *
 	 * This function does NOT write the closing '}' character.
 	 *
      * @param path Null-terminated command path string
+     * @param kind Frame kind character ('p' for commands)
 	 *
 	 * @return true if all prefix bytes were successfully enqueued
 	 * @return false if the TX buffer overflows
 	 *
 	 * @note Must be paired with end_frame() on success.
 	 */
-	bool begin_frame(const char* path);
+	bool begin_frame(const char* path, char kind = 'p');
 
 
 	/**
 	 * @brief Finalizes a PathWire command frame
 	 *
 	 * Writes the closing frame delimiter ('}') to the TX buffer.
+	 * In multi-producer mode the staged frame is then published.
+	 * Inside a batch this is a no-op; end_batch() closes the frame.
 	 *
 	 * @return true if the delimiter was successfully enqueued
 	 * @return false if the TX buffer overflows
@@ -196,11 +652,103 @@ private:
 	 */
 	bool end_frame();
 
+	/**
+	 * @brief Starts a binary packet in the staging buffer
+	 *
+	 * Writes the packet header <kind><type><path_len><path>, leaving
+	 * the first staging byte free for the COBS code byte.
+	 *
+	 * @param path Null-terminated path string (at most 255 characters)
+	 * @param kind Frame kind
+	 * @param type Payload type
+	 *
+	 * @return true if the header was staged
+	 * @return false if the path is too long or the staging buffer overflows
+	 */
+	bool begin_packet(const char* path, frame_kind kind, data_type type);
+
+
+	/**
+	 * @brief COBS-encodes the staged packet in place and publishes it
+	 *
+	 * @return true if the packet was queued
+	 * @return false if the staging buffer or TX queue overflows
+	 */
+	bool end_packet();
+
+
+	/**
+	 * @brief Returns true if a frame to path must wait for the peer's XON
+	 *
+	 * Counts the refused frame.
+	 */
+	bool held_back(const char* path);
+
+
+	/**
+	 * @brief Writes the header tags requested in next_tags
+	 *
+	 * Clears next_tags, so the tags apply to a single frame.
+	 *
+	 * @return true if all tags were written
+	 */
+	bool push_tags();
+
+
+	/**
+	 * @brief Appends the CRC trailer of the current frame
+	 *
+	 * Text frames get upper-case hex digits, binary packets raw bytes
+	 * in the order required for the residue check.
+	 *
+	 * @return true if the trailer was written
+	 */
+	bool push_crc();
+
+
+	/**
+	 * @brief Appends raw bytes to the staging buffer
+	 *
+	 * @param data Source bytes
+	 * @param len  Number of bytes
+	 *
+	 * @return true if all bytes were staged
+	 * @return false if the staging buffer overflows
+	 */
+	bool push_bytes(const void* data, uint32_t len);
+
+
+	/**
+	 * @brief Publishes the staged frame to the TX queue
+	 *
+	 * The whole frame is copied at once (with a single reserve/commit
+	 * for shared queues and lanes) and one TX-ready notification is
+	 * issued.
+	 *
+	 * @return true if the frame was published
+	 * @return false if the queue has no room for the frame
+	 */
+	bool publish_stage();
+
+	/**
+	 * @brief Copies a complete frame into the TX queue as one unit
+	 *
+	 * @return false if the queue has no room for the frame
+	 */
+	bool publish(const uint8_t* frame, uint16_t len);
+
+	/**
+	 * @brief Issues a TX-ready notification or defers it during a burst
+	 */
+	void signal_tx();
+
 	/**
 	 * @brief Pushes a single character into the TX buffer
 	 *
 	 * The character is enqueued as a single byte and a TX-ready
 	 * notification is issued immediately after a successful push.
+	 * In multi-producer mode the character is appended to the
+	 * staging buffer instead.
 	 *
 	 * @param c Character to enqueue
 	 *
@@ -245,6 +793,18 @@ private:
 
 
 
+    /**
+     * @brief Serializes and pushes an unsigned 32-bit integer
+     *
+     * @param v Integer value to serialize
+     *
+     * @return true if all characters were successfully enqueued
+     * @return false if the TX buffer overflows
+     */
+    bool push_uint(uint32_t v);
+
+
+
     /**
      * @brief Serializes and pushes a floating-point value
      *
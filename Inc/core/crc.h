@@ -0,0 +1,155 @@
+/**
+ * @file crc.h
+ * @brief Table-driven CRC-16/CCITT and CRC-32C for frame trailers
+ *
+ * This file provides the checksums used by the optional PathWire frame
+ * trailer (see crc_mode).
+ *
+ * Supported algorithms:
+ * - CRC-16/CCITT-FALSE : poly 0x1021, init 0xFFFF, MSB-first, no final XOR
+ * - CRC-32C (Castagnoli): poly 0x1EDC6F41 (reflected 0x82F63B78),
+ *                         init and final XOR 0xFFFFFFFF, LSB-first
+ *
+ * Two table layouts are available:
+ * - Compact (default on MCUs): 16-entry nibble tables in flash,
+ *   64 bytes for CRC-32C and 32 bytes for CRC-16
+ * - Slice-by-8 (default on 32/64-bit hosts): 8 x 256 entry tables built
+ *   at start-up; crc_block() then consumes 8 bytes per step
+ *
+ * The per-byte crc_update() is inline, so the parser can fold every byte
+ * into the running CRC in the same loop that copies it.
+ *
+ * Design goals:
+ * - No dynamic memory allocation
+ * - Same results for both table layouts
+ */
+#ifndef PATHWIRE_INC_CORE_CRC_H_
+#define PATHWIRE_INC_CORE_CRC_H_
+
+#include <stdint.h>
+
+
+/**
+ * @def PATHWIRE_CRC_SLICE8
+ * @brief Selects slice-by-8 tables (1) or compact nibble tables (0)
+ *
+ * Slice-by-8 needs 12 KiB of RAM for both tables.
+ */
+#ifndef PATHWIRE_CRC_SLICE8
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__) || defined(_M_X64)
+#define PATHWIRE_CRC_SLICE8 1
+#else
+#define PATHWIRE_CRC_SLICE8 0
+#endif
+#endif
+
+
+/**
+ * @enum crc_mode
+ * @brief Optional frame trailer
+ *
+ * TEXT frames carry the final CRC as upper-case hex digits directly
+ * after the closing brace, covering '{' through '}':
+ *   {p:ctrl/arm:d:1}5A3C
+ *
+ * BINARY packets carry it after the payload, before COBS encoding,
+ * covering the whole decoded packet. CRC-16 is sent MSB first and
+ * CRC-32C LSB first, so the receiver can check the constant residue
+ * of packet + trailer without locating the trailer first.
+ */
+enum class crc_mode : uint8_t
+{
+    NONE,         ///< No trailer
+    CRC16_CCITT,  ///< 2-byte CRC-16/CCITT-FALSE
+    CRC32C        ///< 4-byte CRC-32C
+};
+
+
+#if PATHWIRE_CRC_SLICE8
+extern uint16_t crc16_table[8][256];   ///< Slice-by-8 tables, [0] is the byte table
+extern uint32_t crc32c_table[8][256];  ///< Slice-by-8 tables, [0] is the byte table
+#else
+extern const uint16_t crc16_nibble[16];
+extern const uint32_t crc32c_nibble[16];
+#endif
+
+
+/**
+ * @brief Returns the trailer size in bytes (0, 2 or 4)
+ */
+inline uint8_t crc_size(crc_mode mode)
+{
+    return mode == crc_mode::CRC16_CCITT ? 2 : (mode == crc_mode::CRC32C ? 4 : 0);
+}
+
+/**
+ * @brief Returns the initial CRC register value
+ */
+inline uint32_t crc_init(crc_mode mode)
+{
+    return mode == crc_mode::CRC16_CCITT ? 0xFFFFU : 0xFFFFFFFFU;
+}
+
+/**
+ * @brief Converts a CRC register into the transmitted CRC value
+ */
+inline uint32_t crc_final(crc_mode mode, uint32_t reg)
+{
+    return mode == crc_mode::CRC32C ? ~reg : reg;
+}
+
+/**
+ * @brief Returns the register value after a packet and its binary trailer
+ */
+inline uint32_t crc_residue(crc_mode mode)
+{
+    return mode == crc_mode::CRC32C ? 0xB798B438U : 0U;
+}
+
+/**
+ * @brief Folds one byte into a CRC register
+ *
+ * @param mode CRC algorithm (NONE returns reg unchanged)
+ * @param reg  Current register value
+ * @param b    Input byte
+ * @return Updated register value
+ */
+inline uint32_t crc_update(crc_mode mode, uint32_t reg, uint8_t b)
+{
+#if PATHWIRE_CRC_SLICE8
+    if (mode == crc_mode::CRC16_CCITT)
+        return (uint16_t)((reg << 8) ^ crc16_table[0][((reg >> 8) ^ b) & 0xFFU]);
+
+    if (mode == crc_mode::CRC32C)
+        return (reg >> 8) ^ crc32c_table[0][(reg ^ b) & 0xFFU];
+#else
+    if (mode == crc_mode::CRC16_CCITT)
+    {
+        reg = (uint16_t)((reg << 4) ^ crc16_nibble[((reg >> 12) ^ (b >> 4)) & 0xFU]);
+        return (uint16_t)((reg << 4) ^ crc16_nibble[((reg >> 12) ^ b) & 0xFU]);
+    }
+
+    if (mode == crc_mode::CRC32C)
+    {
+        reg = (reg >> 4) ^ crc32c_nibble[(reg ^ b) & 0xFU];
+        return (reg >> 4) ^ crc32c_nibble[(reg ^ (b >> 4)) & 0xFU];
+    }
+#endif
+
+    return reg;
+}
+
+/**
+ * @brief Folds a block of bytes into a CRC register
+ *
+ * Uses slice-by-8 when PATHWIRE_CRC_SLICE8 is enabled.
+ *
+ * @param mode CRC algorithm
+ * @param reg  Current register value
+ * @param data Input bytes
+ * @param len  Number of bytes
+ * @return Updated register value
+ */
+uint32_t crc_block(crc_mode mode, uint32_t reg, const uint8_t* data, uint32_t len);
+
+#endif // PATHWIRE_INC_CORE_CRC_H_
@@ -0,0 +1,188 @@
+/**
+ * @file flow_control.h
+ * @brief Receiver-driven XON/XOFF flow control
+ *
+ * This file defines the flow_control class, which protects an RX ring
+ * buffer from overruns when the peer sends faster than the main loop
+ * parses, e.g. during host bursts.
+ *
+ * The receiver watches the fill level of its RX ring and sends
+ *
+ *   {p:$xoff:d:}   when the level reaches the high watermark
+ *   {p:$xon:d:}    when it has fallen to the low watermark
+ *
+ * The peer's executer forwards these frames to its own flow_control,
+ * and every sender attached to it refuses new frames while paused.
+ * Control frames (paths starting with '$') are never held back, so
+ * both directions can pause each other without deadlocking.
+ *
+ * The space above the high watermark must hold everything the peer
+ * may still send after the XOFF was flagged: bytes arriving until the
+ * next poll(), its TX queue, bytes in the transport, and the transmit
+ * time of the XOFF itself.
+ *
+ * Each peer owns one flow_control, which holds both the watermark
+ * state of its RX ring and the pause state requested by the peer.
+ *
+ * Design goals:
+ * - Constant-time level check, callable from the RX interrupt (which
+ *   only flags the XOFF; the sender is used by poll() and tick() only)
+ * - No dynamic memory allocation
+ * - Tick-driven repetition, no clock dependency
+ */
+#ifndef PATHWIRE_INC_CORE_FLOW_CONTROL_H_
+#define PATHWIRE_INC_CORE_FLOW_CONTROL_H_
+
+#include <stdint.h>
+
+#include "core/ring_buffer.h"
+
+class cmnd_sender;
+
+
+/**
+ * @def FLOW_REFRESH_TICKS
+ * @brief Ticks after which the current XON/XOFF state is sent again
+ *
+ * Repairs lost $xon/$xoff frames.
+ */
+#ifndef FLOW_REFRESH_TICKS
+#define FLOW_REFRESH_TICKS 50
+#endif
+
+
+/**
+ * @struct flow_stats
+ * @brief Cumulative flow control statistics
+ */
+struct flow_stats
+{
+    uint32_t xoff_sent;    ///< $xoff frames sent (including repeats)
+    uint32_t xon_sent;     ///< $xon frames sent (including repeats)
+    uint32_t peer_pauses;  ///< Times the peer paused this side
+    uint32_t held;         ///< Frames refused while paused
+};
+
+
+/**
+ * @class flow_control
+ * @brief RX watermark monitor and peer pause state of one peer
+ *
+ * Typical usage (device):
+ * @code
+ * flow_control flow(reply_sender, usart2_rx_buffer, 384, 128);
+ *
+ * usart2_attach_rx_flow(&flow);        // XOFF flagged by the RX interrupt
+ *
+ * // main loop
+ * parser.poll();
+ * flow.poll();                         // sends the XOFF, XON once drained
+ *
+ * // periodic task
+ * flow.tick();
+ * @endcode
+ *
+ * Typical usage (host):
+ * @code
+ * flow_control flow(sender, rx_ring, 3072, 1024);
+ *
+ * executer.set_flow_control(&flow);
+ * sender.set_flow_control(&flow);      // honors the device's XOFF
+ * @endcode
+ */
+class flow_control
+{
+public:
+
+    /**
+     * @brief Constructs the flow control state
+     *
+     * @param reply Sender used for $xon/$xoff (must be usable from the
+     *              context that calls poll() and tick())
+     * @param rx    RX ring buffer to watch
+     * @param high  Fill level that triggers XOFF
+     * @param low   Fill level that triggers XON (below high)
+     */
+    flow_control(cmnd_sender& reply,
+                 ring_buffer<uint8_t>& rx,
+                 uint16_t high,
+                 uint16_t low);
+
+    /**
+     * @brief Flags an XOFF if the RX ring has reached the high watermark
+     *
+     * Intended for the RX interrupt, right after a byte was pushed. It
+     * only records the pause; the XOFF itself is sent by the next
+     * poll(), so the reply sender is never touched from the interrupt.
+     */
+    void on_rx();
+
+    /**
+     * @brief Sends a flagged XOFF and checks both watermarks
+     *
+     * Call from the context that drains the RX ring, after
+     * cmnd_parser::poll().
+     */
+    void poll();
+
+    /**
+     * @brief Repeats the current state every FLOW_REFRESH_TICKS ticks
+     */
+    void tick();
+
+    /**
+     * @brief Returns true while the local RX ring is above the low
+     *        watermark after an XOFF
+     */
+    bool paused() const { return xoff; }
+
+    /**
+     * @brief Returns true while the peer has asked this side to pause
+     */
+    bool peer_paused() const { return peer_xoff; }
+
+    /**
+     * @brief Processes $xon/$xoff from the peer
+     *
+     * Called by cmnd_executer.
+     *
+     * @param pause true for $xoff, false for $xon
+     */
+    void on_peer(bool pause);
+
+    /**
+     * @brief Counts a frame refused while the peer is paused
+     *
+     * Called by cmnd_sender.
+     */
+    void held() { counters.held++; }
+
+    /**
+     * @brief Returns cumulative statistics
+     */
+    const flow_stats& stats() const { return counters; }
+
+private:
+
+    /**
+     * @brief Sends $xoff or $xon
+     *
+     * @param pause State to announce
+     */
+    void send(bool pause);
+
+    cmnd_sender&          reply;
+    ring_buffer<uint8_t>& rx_queue;
+    uint16_t              high;
+    uint16_t              low;
+
+    volatile bool         xoff;       ///< Paused, XON not sent yet
+    volatile bool         xoff_due;   ///< XOFF flagged by on_rx(), not sent yet
+    volatile bool         peer_xoff;  ///< Peer asked to pause
+    bool                  announced;  ///< A state was sent at least once
+    uint16_t              age;        ///< Ticks since the last state frame
+
+    flow_stats            counters;
+};
+
+#endif // PATHWIRE_INC_CORE_FLOW_CONTROL_H_
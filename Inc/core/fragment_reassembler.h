@@ -0,0 +1,173 @@
+/**
+ * @file fragment_reassembler.h
+ * @brief Reassembly of fragmented PathWire payloads
+ *
+ * This file defines the fragment_reassembler class, which collects the
+ * fragments produced by cmnd_sender::send_bytes() for payloads larger
+ * than the parser work buffer (lookup tables, firmware chunks).
+ *
+ * Fragments carry their byte offset, the total payload size and a
+ * transfer ID, so they may arrive in any order and duplicates are
+ * recognized, including late copies of a payload already delivered.
+ * Coverage is tracked with one bit per FRAGMENT_BLOCK bytes.
+ *
+ * Delivery depends on the expected type of the path:
+ * - BYTES : fragments are copied into the caller-provided buffer and
+ *           the handler receives the complete payload once
+ * - CHUNK : every new fragment is passed on as a payload_chunk, the
+ *           last one with payload_chunk::last set; no payload buffer
+ *           is needed
+ *
+ * One payload is reassembled at a time. The sender transmits payloads
+ * one after another, so a fragment of a new transfer abandons an
+ * incomplete one.
+ *
+ * Design goals:
+ * - Fixed memory bound, caller-provided payload buffer
+ * - No dynamic memory allocation
+ * - Tick-driven timeout, no clock dependency
+ */
+#ifndef PATHWIRE_INC_CORE_FRAGMENT_REASSEMBLER_H_
+#define PATHWIRE_INC_CORE_FRAGMENT_REASSEMBLER_H_
+
+#include <stdint.h>
+
+#include "core/cmnd_executer.h"
+
+
+/**
+ * @def FRAGMENT_MAX_BLOCKS
+ * @brief Maximum payload size in FRAGMENT_BLOCK units
+ *
+ * Bounds the coverage bitmap (FRAGMENT_MAX_BLOCKS / 8 bytes).
+ */
+#ifndef FRAGMENT_MAX_BLOCKS
+#define FRAGMENT_MAX_BLOCKS 256
+#endif
+
+
+/**
+ * @struct fragment_stats
+ * @brief Cumulative reassembly statistics
+ */
+struct fragment_stats
+{
+    uint32_t fragments;   ///< Fragments accepted
+    uint32_t duplicates;  ///< Fragments that added no new data
+    uint32_t rejected;    ///< Invalid fragments
+    uint32_t completed;   ///< Payloads delivered completely
+    uint32_t timeouts;    ///< Payloads dropped after the timeout
+    uint32_t abandoned;   ///< Payloads dropped when a new transfer started
+};
+
+
+/**
+ * @class fragment_reassembler
+ * @brief Collects fragments of one payload at a time
+ *
+ * Typical usage:
+ * @code
+ * static uint8_t table_buf[1024];
+ * fragment_reassembler reasm(table_buf, sizeof(table_buf), 500);
+ *
+ * executer.set_reassembler(&reasm);
+ *
+ * // periodic task
+ * reasm.tick();
+ * @endcode
+ */
+class fragment_reassembler
+{
+public:
+
+    /**
+     * @brief Constructs a reassembler
+     *
+     * @param buffer  Payload buffer for BYTES paths (may be nullptr if
+     *                only CHUNK paths are used)
+     * @param size    Size of buffer in bytes
+     * @param timeout Ticks without a new fragment before a partial
+     *                payload is discarded
+     */
+    fragment_reassembler(uint8_t* buffer, uint16_t size, uint16_t timeout);
+
+    /**
+     * @brief Processes one fragment
+     *
+     * Called by cmnd_executer.
+     *
+     * @param entry  Path table entry of the fragment
+     * @param id     Transfer ID
+     * @param offset Byte offset of data within the payload
+     * @param total  Total payload size
+     * @param data   Fragment bytes
+     * @param len    Number of bytes in data
+     */
+    void accept(const path_entry& entry,
+                uint16_t id,
+                uint16_t offset,
+                uint16_t total,
+                const uint8_t* data,
+                uint16_t len);
+
+    /**
+     * @brief Routes handler calls through a dispatch function
+     *
+     * Use the dispatch registered with cmnd_executer::set_handler_dispatch().
+     *
+     * @param fn  Dispatch function (nullptr = call handlers directly)
+     * @param ctx Context pointer passed to fn
+     */
+    void set_handler_dispatch(handler_dispatch fn, void* ctx);
+
+    /**
+     * @brief Advances the reassembly timeout by one tick
+     */
+    void tick();
+
+    /**
+     * @brief Returns true while a payload is partially received
+     */
+    bool busy() const { return active != nullptr; }
+
+    /**
+     * @brief Returns cumulative statistics
+     */
+    const fragment_stats& stats() const { return counters; }
+
+private:
+
+    /**
+     * @brief Marks the blocks covered by a fragment
+     *
+     * @return Number of blocks that were not covered before
+     */
+    uint16_t mark(uint16_t offset, uint16_t len);
+
+    /**
+     * @brief Ends the payload in progress and remembers its transfer
+     */
+    void finish();
+
+    uint8_t*          buf;
+    uint16_t          buf_size;
+    uint16_t          timeout;
+
+    const path_entry* active;      ///< Path of the payload in progress
+    uint16_t          xfer;        ///< Transfer ID of the payload in progress
+    uint16_t          total;       ///< Size of the payload in progress
+    uint16_t          missing;     ///< Blocks not received yet
+    uint16_t          age;         ///< Ticks since the last new fragment
+
+    const path_entry* done;        ///< Path of the last finished payload
+    uint16_t          done_xfer;   ///< Transfer ID of the last finished payload
+
+    uint32_t          map[(FRAGMENT_MAX_BLOCKS + 31) / 32];  ///< Received blocks
+
+    fragment_stats    counters;
+
+    handler_dispatch  dispatch_fn;   ///< Replaces direct handler calls, or nullptr
+    void*             dispatch_ctx;  ///< Context of dispatch_fn
+};
+
+#endif // PATHWIRE_INC_CORE_FRAGMENT_REASSEMBLER_H_
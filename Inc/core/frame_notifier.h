@@ -0,0 +1,32 @@
+/**
+ * @file frame_notifier.h
+ * @brief Frame-ready notification interface
+ *
+ * This file defines the callback a cmnd_parser fires whenever it queues
+ * a frame for the executer (see cmnd_parser::set_frame_notifier()). It
+ * is the RX counterpart of tx_notifier: instead of polling the frame
+ * queue, the executer's task sleeps until the parser signals work.
+ *
+ * Typical use cases:
+ * - RTOS task notification from the RX interrupt
+ * - eventfd or condition variable on a host
+ * - Wake-up flag for a bare-metal sleep loop
+ */
+#ifndef PATHWIRE_INC_CORE_FRAME_NOTIFIER_H_
+#define PATHWIRE_INC_CORE_FRAME_NOTIFIER_H_
+
+/**
+ * @typedef frame_notify_fn
+ * @brief Frame-ready notification callback type
+ *
+ * Called after every frame (or stream piece) pushed to the frame queue,
+ * in the context that runs cmnd_parser::poll().
+ *
+ * @param ctx Context pointer given at registration
+ *
+ * @note Must be non-blocking.
+ * @note Should execute quickly.
+ */
+typedef void (*frame_notify_fn)(void* ctx);
+
+#endif // PATHWIRE_INC_CORE_FRAME_NOTIFIER_H_
@@ -0,0 +1,352 @@
+/**
+ * @file frame_router.h
+ * @brief Path-prefix router that forwards raw frames between links
+ *
+ * This file defines the frame_router class, which lets a gateway bridge
+ * frames between one inbound link (e.g. the ground link) and several
+ * outbound links (e.g. on-board MCUs) without parsing and re-sending
+ * them.
+ *
+ * The router sits between the RX ring of the inbound link and the local
+ * parser:
+ *
+ *   RX ring → frame_router → local ring → cmnd_parser → cmnd_executer
+ *                 │
+ *                 └→ cmnd_sender::send_raw() of the outbound link
+ *
+ * Frames whose path starts with the prefix of a route are forwarded as
+ * they were received: the encoded bytes are handed to the outbound
+ * sender in one piece, straight from the RX ring when they are
+ * contiguous there. All other bytes are moved to the local ring and
+ * parsed as usual.
+ *
+ * A route may strip leading path characters and insert a new prefix,
+ * e.g. `mcu2/motor/set` → `motor/set`. The text CRC trailer is then
+ * checked and recomputed; a frame that fails the check is dropped, so
+ * inbound corruption is never hidden behind a fresh trailer.
+ *
+ * Always handled locally:
+ * - Batch frames ('m'), which may address several destinations
+ * - Frames that carry a path ID ('#' or binary path_len 0), since the
+ *   dictionary belongs to the inbound link
+ * - Malformed headers
+ *
+ * Routed frames tagged with an ARQ sequence number ('s') or a channel
+ * ('c') are forwarded with their tags, but belong to the inbound link's
+ * reliable_link and channel_credits. Give the router the same objects
+ * as the inbound executer (set_reliable_link(), set_channel_credits()):
+ * it then registers and acknowledges the sequence numbers and charges
+ * the frame sizes itself, and duplicates are not forwarded again.
+ *
+ * Design goals:
+ * - No dynamic memory allocation
+ * - No re-encoding of forwarded frames
+ * - Local frames keep streaming into the parser while they arrive
+ */
+#ifndef PATHWIRE_INC_CORE_FRAME_ROUTER_H_
+#define PATHWIRE_INC_CORE_FRAME_ROUTER_H_
+
+#include <stdint.h>
+
+#include "core/ring_buffer.h"
+#include "core/cmnd_frame.h"
+#include "core/crc.h"
+
+class cmnd_sender;
+class reliable_link;
+class channel_credits;
+
+
+/**
+ * @struct frame_route
+ * @brief Maps a path prefix to an outbound link
+ *
+ * Example table:
+ * @code
+ * static const frame_route routes[] = {
+ *     { "mcu1/", 0, 5, nullptr },   // mcu1/motor/set → motor/set
+ *     { "mcu2/", 1, 0, nullptr },   // forwarded unchanged
+ *     { "cam/",  2, 4, "gimbal/" }, // cam/tilt → gimbal/tilt
+ * };
+ * @endcode
+ */
+struct frame_route
+{
+    const char* prefix;  ///< Path prefix, e.g. "mcu2/"
+    uint8_t     link;    ///< Index of the outbound sender
+    uint8_t     strip;   ///< Leading path characters removed before forwarding
+    const char* add;     ///< Inserted in front of the remaining path (nullptr = none)
+};
+
+
+/**
+ * @struct router_stats
+ * @brief Cumulative router statistics
+ */
+struct router_stats
+{
+    uint32_t forwarded;  ///< Frames handed to outbound links
+    uint32_t local;      ///< Frames moved to the local ring
+    uint32_t stalls;     ///< poll() calls that stopped at a full outbound queue
+    uint32_t dropped;    ///< Routed frames that could not be forwarded or failed their CRC (see poll())
+    uint32_t duplicates; ///< Routed frames with an already received sequence number
+};
+
+
+/**
+ * @class frame_router
+ * @brief Forwards frames by path prefix, passes the rest to the parser
+ *
+ * Typical usage (gateway main loop):
+ * @code
+ * frame_router router(ground_rx, local_rx, route_scratch, sizeof(route_scratch));
+ * cmnd_parser  parser(local_rx, frames, work, sizeof(work));
+ *
+ * cmnd_sender* mcu_links[] = { &mcu1_sender, &mcu2_sender, &cam_sender };
+ * router.set_routes(routes, 3, mcu_links, 3);
+ *
+ * router.poll();
+ * parser.poll();
+ * while (!frames.empty())
+ *     executer.poll();
+ * @endcode
+ *
+ * One router serves one inbound link; a gateway that also routes the
+ * MCU links back to the ground link uses one router per MCU link.
+ */
+class frame_router
+{
+public:
+
+    /**
+     * @brief Constructs a router
+     *
+     * @param rx           RX ring of the inbound link
+     * @param local        Ring read by the local cmnd_parser
+     * @param scratch      Buffer for frames that wrap around the end of
+     *                     the RX ring or whose path is rewritten
+     * @param scratch_size Size of the scratch buffer (largest routed
+     *                     frame plus prefix growth)
+     */
+    frame_router(ring_buffer<uint8_t>& rx,
+                 ring_buffer<uint8_t>& local,
+                 char* scratch,
+                 uint16_t scratch_size);
+
+    /**
+     * @brief Installs the route table
+     *
+     * Routes are matched in table order; the first matching prefix wins.
+     *
+     * @param table      Route table (must outlive the router)
+     * @param count      Number of routes
+     * @param links      Outbound senders, indexed by frame_route::link
+     * @param link_count Number of outbound senders
+     *
+     * @return false if a route refers to a missing link
+     */
+    bool set_routes(const frame_route* table,
+                    uint8_t count,
+                    cmnd_sender* const* links,
+                    uint8_t link_count);
+
+    /**
+     * @brief Selects the wire encoding of the inbound link
+     *
+     * @note Binary packets are forwarded verbatim only; routed packets
+     *       whose route strips or adds a prefix are dropped.
+     */
+    void set_wire_mode(wire_mode mode);
+
+    /**
+     * @brief Selects the CRC trailer of inbound text frames
+     *
+     * Needed to find the end of a text frame, and to check and
+     * recompute the trailer of a frame whose path is rewritten. Use
+     * the same mode as the parser.
+     */
+    void set_crc_mode(crc_mode mode);
+
+    /**
+     * @brief Registers 's'-tagged routed frames with the inbound link's ARQ
+     *
+     * Use the reliable_link of the inbound executer. Forwarded frames
+     * are acknowledged like executed ones; duplicates are acknowledged
+     * again but not forwarded.
+     *
+     * @param link Reliable link of the inbound link (nullptr = none)
+     */
+    void set_reliable_link(reliable_link* link);
+
+    /**
+     * @brief Charges routed frames to the inbound link's channel credits
+     *
+     * Use the channel_credits of the inbound executer, so the sender's
+     * window refills for forwarded frames as well.
+     *
+     * @param credits Credit state of the inbound link (nullptr = none)
+     */
+    void set_channel_credits(channel_credits* credits);
+
+    /**
+     * @brief Moves available RX bytes to the local ring or outbound links
+     *
+     * A routed frame is forwarded once it is complete in the RX ring.
+     * poll() stops (and leaves the remaining bytes in the RX ring) when
+     * the local ring or the outbound queue of the next routed frame is
+     * full, so a stalled outbound link also holds back later frames of
+     * the inbound link.
+     *
+     * Routed frames are dropped if they fill the whole RX ring without
+     * being complete, do not fit the scratch buffer when needed, or
+     * fail their CRC check before a path rewrite.
+     */
+    void poll();
+
+    /**
+     * @brief Returns cumulative statistics
+     */
+    const router_stats& stats() const { return counters; }
+
+private:
+
+    /**
+     * @brief Router state between poll() calls
+     */
+    enum class state_t : uint8_t {
+        IDLE,   ///< At a frame start (binary) or a byte to classify (text)
+        LOCAL,  ///< Moving a local frame or gap bytes to the local ring
+        SKIP    ///< Discarding an oversize routed frame
+    };
+
+    /**
+     * @brief Outcome of classifying the frame at the head of the RX ring
+     */
+    enum class verdict : uint8_t {
+        WAIT,     ///< More bytes needed
+        LOCAL,    ///< Not routed
+        FORWARD,  ///< Routed and complete
+        SKIP,     ///< Routed but can never be complete
+        CORRUPT   ///< Routed, complete, and failed the CRC check (frame_len set)
+    };
+
+    /**
+     * @brief Returns the byte at offset i of the readable RX span
+     */
+    uint8_t at(uint16_t i) const
+    {
+        return i < first_len ? first[i] : second[i - first_len];
+    }
+
+    /**
+     * @brief Classifies the text frame at the head of the RX ring
+     */
+    verdict classify_text();
+
+    /**
+     * @brief Checks the CRC trailer of the complete text frame at the
+     *        head of the RX ring
+     *
+     * @param end Offset of the closing '}'
+     */
+    bool crc_matches(uint16_t end) const;
+
+    /**
+     * @brief Classifies the binary packet at the head of the RX ring
+     */
+    verdict classify_binary();
+
+    /**
+     * @brief Position of a COBS decoder within the readable RX span
+     */
+    struct cobs_cursor
+    {
+        uint16_t pos;   ///< Offset of the next encoded byte
+        uint8_t  left;  ///< Data bytes left in the current block
+        bool     zero;  ///< A zero is implied before the next block
+    };
+
+    /**
+     * @brief Decodes the next byte of the packet at the head of the RX ring
+     *
+     * @return false at the end of the packet (frame_len must be set)
+     */
+    bool next_decoded(cobs_cursor& c, uint8_t& out) const;
+
+    /**
+     * @brief Returns the first route matching the path, or nullptr
+     *
+     * @param path Path bytes (need not be null-terminated)
+     * @param len  Number of path bytes
+     */
+    const frame_route* match(const char* path, uint16_t len) const;
+
+    /**
+     * @brief Hands the classified frame to its outbound link
+     *
+     * @return false if the outbound queue is full
+     */
+    bool forward();
+
+    /**
+     * @brief Moves RX bytes to the local ring up to the next frame start
+     *
+     * @return false if the local ring is full
+     */
+    bool pass_local();
+
+    /**
+     * @brief Removes the classified routed frame from the RX ring
+     *
+     * Charges its channel credits and flushes a due ACK.
+     */
+    void release();
+
+    /**
+     * @brief Discards RX bytes up to the end of the current frame
+     */
+    void skip();
+
+    /**
+     * @brief Copies n RX bytes starting at offset from into the scratch buffer
+     */
+    void gather(uint16_t from, uint16_t n, uint16_t to);
+
+    ring_buffer<uint8_t>& rx_queue;
+    ring_buffer<uint8_t>& local_queue;
+
+    char*     scratch;
+    uint16_t  scratch_size;
+
+    const frame_route*  routes;
+    uint8_t             route_count;
+    cmnd_sender* const* links;
+
+    wire_mode mode;
+    crc_mode  crc;
+    state_t   state;
+
+    // Readable RX span, refreshed at the top of every poll() iteration
+    uint8_t*  first;
+    uint8_t*  second;
+    uint16_t  first_len;
+    uint16_t  second_len;
+    uint16_t  avail;
+
+    // Frame classified as FORWARD
+    const frame_route* route;   ///< Matching route
+    uint16_t  path_start;       ///< Offset of the path (text)
+    uint16_t  path_end;         ///< Offset of the ':' after the path (text)
+    uint16_t  frame_len;        ///< Encoded length including trailer/delimiter
+    uint8_t   frame_tags;       ///< FRAME_TAG_SEQ / FRAME_TAG_CHANNEL seen
+    uint16_t  frame_seq;        ///< Sequence number ('s')
+    uint8_t   frame_channel;    ///< Channel ('c', 0 if absent)
+    bool      accepted;         ///< frame_seq already registered (forward stalled)
+
+    reliable_link*   arq;
+    channel_credits* credits;
+
+    router_stats counters;
+};
+
+#endif // PATHWIRE_INC_CORE_FRAME_ROUTER_H_
@@ -0,0 +1,270 @@
+/**
+ * @file mp_ring_buffer.h
+ * @brief Multi-producer / single-consumer byte queue with reserve/commit
+ *
+ * This file defines mp_ring_buffer, a lock-free byte FIFO that allows
+ * several producers (tasks, threads, ISRs) to publish complete records
+ * without interleaving, while a single consumer (typically the TX ISR)
+ * drains bytes one at a time.
+ *
+ * Publishing a record is a three step operation:
+ * 1. reserve()  - atomically claim a contiguous (modulo wrap) byte range
+ * 2. write()    - copy the record into the claimed range
+ * 3. commit()   - mark the range as complete
+ *
+ * Commits may happen out of reservation order. The consumer only ever
+ * sees the longest committed prefix, so it never observes a half
+ * written record. A producer never waits for another producer: if an
+ * earlier reservation is still being written, the later commit is
+ * recorded and the earlier producer publishes both when it commits.
+ *
+ * Design characteristics:
+ * - Multiple producers / single consumer
+ * - No dynamic memory allocation
+ * - No locks, no spinning on other producers
+ * - Storage size must be a power of two (max 32768 bytes)
+ */
+#ifndef PATHWIRE_INC_CORE_MP_RING_BUFFER_H_
+#define PATHWIRE_INC_CORE_MP_RING_BUFFER_H_
+
+#include <stdint.h>
+#include <atomic>
+
+
+/**
+ * @def MP_RING_MAX_PENDING
+ * @brief Maximum number of reservations that may be in flight at once
+ *
+ * Bounds the number of producers that can be between reserve() and
+ * commit() simultaneously. reserve() fails while the limit is reached.
+ */
+#ifndef MP_RING_MAX_PENDING
+#define MP_RING_MAX_PENDING 8
+#endif
+
+// Tickets are 16-bit counters: ticket % MP_RING_MAX_PENDING only stays
+// continuous across their wrap for powers of two
+static_assert(MP_RING_MAX_PENDING > 0 &&
+              (MP_RING_MAX_PENDING & (MP_RING_MAX_PENDING - 1)) == 0,
+              "MP_RING_MAX_PENDING must be a power of two");
+
+
+/**
+ * @class mp_ring_buffer
+ * @brief Lock-free multi-producer byte FIFO
+ *
+ * Positions and reservation tickets are kept as 16-bit counters packed
+ * into 32-bit atomics, so every state transition is a single
+ * compare-and-swap on targets with 32-bit LDREX/STREX or CMPXCHG.
+ *
+ * @note The consumer side (pop(), count()) must be used by one context only.
+ */
+class mp_ring_buffer
+{
+public:
+
+    /**
+     * @brief Handle describing a claimed byte range
+     */
+    struct reservation
+    {
+        uint16_t ticket;  ///< Reservation sequence number
+        uint16_t start;   ///< Position of the first claimed byte
+        uint16_t len;     ///< Number of claimed bytes
+    };
+
+    /**
+     * @brief Constructs a multi-producer ring buffer
+     *
+     * @param buffer      Pointer to pre-allocated storage array
+     * @param bufferSize  Number of bytes in the buffer (power of two)
+     */
+    mp_ring_buffer(uint8_t* buffer, uint16_t bufferSize)
+        : buffer(buffer),
+          mask(static_cast<uint16_t>(bufferSize - 1U)),
+          head(0),
+          published(0),
+          tail(0)
+    {
+        for (uint16_t i = 0; i < MP_RING_MAX_PENDING; i++)
+        {
+            // Tag every slot with a ticket that cannot match before use.
+            uint16_t stale = static_cast<uint16_t>(i - MP_RING_MAX_PENDING);
+            done[i].store(static_cast<uint32_t>(stale) << 16,
+                          std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Claims len bytes for exclusive writing
+     *
+     * @param len Number of bytes to claim
+     * @param r   Receives the reservation handle
+     * @return true on success, false if there is not enough free space
+     *         or too many reservations are pending
+     */
+    bool reserve(uint16_t len, reservation& r)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            uint16_t pos    = static_cast<uint16_t>(h);
+            uint16_t ticket = static_cast<uint16_t>(h >> 16);
+
+            uint16_t used = static_cast<uint16_t>(
+                pos - tail.load(std::memory_order_acquire));
+
+            if (len > capacity() - used)
+                return false;
+
+            uint16_t oldest = static_cast<uint16_t>(published.load() >> 16);
+
+            if (static_cast<uint16_t>(ticket - oldest) >= MP_RING_MAX_PENDING)
+                return false;
+
+            uint32_t next =
+                (static_cast<uint32_t>(static_cast<uint16_t>(ticket + 1)) << 16) |
+                static_cast<uint16_t>(pos + len);
+
+            if (head.compare_exchange_weak(h, next))
+            {
+                r.ticket = ticket;
+                r.start  = pos;
+                r.len    = len;
+                return true;
+            }
+        }
+    }
+
+    /**
+     * @brief Copies bytes into a reservation
+     *
+     * @param r      Reservation returned by reserve()
+     * @param offset Offset inside the reservation
+     * @param data   Source bytes
+     * @param len    Number of bytes to copy
+     *
+     * @note offset + len must not exceed the reserved length.
+     */
+    void write(const reservation& r, uint16_t offset,
+               const uint8_t* data, uint16_t len)
+    {
+        uint16_t pos = static_cast<uint16_t>(r.start + offset);
+
+        for (uint16_t i = 0; i < len; i++)
+            buffer[static_cast<uint16_t>(pos + i) & mask] = data[i];
+    }
+
+    /**
+     * @brief Stores a single byte into a reservation
+     *
+     * @param r      Reservation returned by reserve()
+     * @param offset Offset inside the reservation
+     * @param byte   Byte to store
+     */
+    void put(const reservation& r, uint16_t offset, uint8_t byte)
+    {
+        buffer[static_cast<uint16_t>(r.start + offset) & mask] = byte;
+    }
+
+    /**
+     * @brief Publishes a reservation to the consumer
+     *
+     * Records the reservation as complete and advances the consumer
+     * visible position over every consecutive completed reservation.
+     *
+     * @param r Reservation returned by reserve()
+     */
+    void commit(const reservation& r)
+    {
+        uint16_t end = static_cast<uint16_t>(r.start + r.len);
+
+        done[r.ticket % MP_RING_MAX_PENDING].store(
+            (static_cast<uint32_t>(r.ticket) << 16) | end);
+
+        uint32_t p = published.load();
+
+        for (;;)
+        {
+            uint16_t ticket = static_cast<uint16_t>(p >> 16);
+            uint32_t d      = done[ticket % MP_RING_MAX_PENDING].load();
+
+            if (static_cast<uint16_t>(d >> 16) != ticket)
+                return; // Oldest reservation still being written
+
+            uint32_t next =
+                (static_cast<uint32_t>(static_cast<uint16_t>(ticket + 1)) << 16) |
+                (d & 0xFFFFU);
+
+            if (published.compare_exchange_weak(p, next))
+                p = next;
+        }
+    }
+
+    /**
+     * @brief Reserves, copies and commits a complete record
+     *
+     * @param data Source bytes
+     * @param len  Number of bytes
+     * @return true if the record was published, false if it did not fit
+     */
+    bool write(const uint8_t* data, uint16_t len)
+    {
+        reservation r;
+
+        if (!reserve(len, r))
+            return false;
+
+        write(r, 0, data, len);
+        commit(r);
+        return true;
+    }
+
+    /**
+     * @brief Pops one committed byte (consumer side)
+     *
+     * @param out Reference to receive the popped byte
+     * @return true if successful, false if no committed data is available
+     */
+    bool pop(uint8_t& out)
+    {
+        uint16_t t = tail.load(std::memory_order_relaxed);
+
+        if (t == static_cast<uint16_t>(published.load(std::memory_order_acquire)))
+            return false;
+
+        out = buffer[t & mask];
+        tail.store(static_cast<uint16_t>(t + 1), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Returns the number of committed bytes waiting for the consumer
+     */
+    uint16_t count() const
+    {
+        return static_cast<uint16_t>(
+            static_cast<uint16_t>(published.load(std::memory_order_acquire)) -
+            tail.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Returns the total number of bytes the buffer can hold
+     */
+    uint16_t capacity() const
+    {
+        return static_cast<uint16_t>(mask + 1U);
+    }
+
+private:
+    uint8_t*              buffer;     ///< Pointer to backing storage
+    uint16_t              mask;       ///< Storage size - 1
+    std::atomic<uint32_t> head;       ///< Next reservation (ticket << 16 | pos)
+    std::atomic<uint32_t> published;  ///< Oldest unpublished ticket << 16 | consumer limit
+    std::atomic<uint16_t> tail;       ///< Consumer position
+
+    std::atomic<uint32_t> done[MP_RING_MAX_PENDING]; ///< Completed reservations (ticket << 16 | end)
+};
+
+#endif // PATHWIRE_INC_CORE_MP_RING_BUFFER_H_
@@ -21,7 +21,11 @@
  * - **cmnd_sender**   → telemetry & command TX
  *
  * Platform-specific code is isolated under `/port`
- * and kept strictly separate from the core.
+ * and kept strictly separate from the core. `port/linux` drives
+ * serial/pty links from an epoll reactor or, for many links, an
+ * io_uring transport or a thread-per-core shard_runtime on a host and
+ * connects simulated firmware over Unix-domain sockets or shared memory.
+ * Slow host handlers can be moved off the decode loop onto a worker_pool.
  *
  * @section frame_format Frame Format
  *
@@ -34,12 +38,54 @@
  * - `{p:sens/IMU/gyro:d:0.01,0.02,0.03}`
  * - `{p:system/reset:d:}`
  *
+ * Block frames carry many samples of one path:
+ * - `{b:sens/IMU/gyro:d:1000,1,2,0.010,0.011,0.020,0.021,0.030,0.031}`
+ *
+ * In binary mode the same frames are sent as COBS-encoded packets
+ * `<kind><type><path_len><path><payload>` with little-endian values,
+ * delimited by `0x00`.
+ *
+ * After a `$dict` handshake has confirmed that both sides share the same
+ * path table, paths may be sent as table indices: `{p:#1:d:0.01}`.
+ *
+ * An optional CRC trailer follows the closing brace: `{p:ctrl/arm:d:1}0140`.
+ *
+ * Header tags may precede the kind, e.g. the sequence number of a
+ * reliable frame: `{s12:p:ctrl/arm:d:1}`.
+ *
+ * Large payloads are split into fragments tagged with offset, total size
+ * and transfer ID and collected by a fragment_reassembler:
+ * `{o32:t100:x7:p:cal/table:d:0A1B2C...}`.
+ *
+ * Text frames addressed to a STREAM path are handed to the handler in
+ * pieces while they arrive (see cmnd_parser::set_stream_paths()).
+ *
+ * Frames may be sent on logical channels with credit-based flow control
+ * (see channel_credits): `{c2:p:tel/imu:d:0.01,0.02,0.03}`.
+ *
+ * A receiver whose RX ring fills up pauses the peer with `$xoff` and
+ * resumes it with `$xon` (see flow_control).
+ *
+ * A gateway forwards frames to other links by path prefix without
+ * re-encoding them (see frame_router).
+ *
+ * A request carries a request ID that its reply echoes in a reply tag:
+ * `{q7:p:param/get:d:3}` → `{r7:p:param/value:d:3,250}`. Request
+ * handlers format the reply directly into the outgoing frame (see
+ * reply_writer).
+ *
  * @section threading Threading Model
  *
  * PathWire is not inherently thread-safe.
  * External synchronization (e.g. mutex) is required
  * when used in multi-task environments.
  *
+ * Several tasks may transmit concurrently without a mutex by giving
+ * each task its own staging cmnd_sender on a shared mp_ring_buffer.
+ *
+ * The parser can signal every queued frame (see frame_notifier), so the
+ * executer's task sleeps until there is work instead of polling.
+ *
  * @section usage Typical Usage
  *
  * - UART RX → `ring_buffer<uint8_t>`
@@ -48,8 +94,5 @@
  *
  * @section future Future Work
  *
- * - Binary transport
- * - CRC support
- * - Streaming frames
  * - C# / PC host library
  */
@@ -0,0 +1,248 @@
+/**
+ * @file reliable_link.h
+ * @brief Selective-repeat ARQ for critical PathWire commands
+ *
+ * This file defines the reliable_link class, an optional reliability
+ * layer for commands that must not be lost (arm, mode changes,
+ * calibration writes).
+ *
+ * Reliable frames carry a sequence number header tag (FRAME_TAG_SEQ).
+ * The sender keeps a copy of every unacknowledged frame in a sliding
+ * window and retransmits it when its timer expires. The receiving
+ * executer suppresses duplicates and answers with $ack frames:
+ *
+ *   {p:$ack:d:<next>,<mask>}
+ *
+ * where next is the lowest sequence number not yet received
+ * (cumulative ACK) and bit i of mask reports next + 1 + i as received
+ * (selective ACK). Only the frames that are actually missing are
+ * retransmitted, and up to window frames are in flight at a time.
+ *
+ * Each peer owns one reliable_link, which holds both its transmit
+ * window and the receive state for the frames sent by the other side.
+ *
+ * Design goals:
+ * - Fixed window, caller-provided frame storage
+ * - No dynamic memory allocation
+ * - Tick-driven timers, no clock dependency
+ *
+ * @note Frames are delivered exactly once, but a frame received after a
+ *       gap is dispatched immediately rather than held back until the
+ *       gap is filled.
+ */
+#ifndef PATHWIRE_INC_CORE_RELIABLE_LINK_H_
+#define PATHWIRE_INC_CORE_RELIABLE_LINK_H_
+
+#include <stdint.h>
+
+#include "core/cmnd_sender.h"
+
+
+/**
+ * @def RELIABLE_MAX_WINDOW
+ * @brief Maximum number of unacknowledged frames (at most 32)
+ */
+#ifndef RELIABLE_MAX_WINDOW
+#define RELIABLE_MAX_WINDOW 8
+#endif
+
+/**
+ * @def RELIABLE_ACK_EVERY
+ * @brief Received frames after which an ACK is sent even if more
+ *        frames are queued
+ */
+#ifndef RELIABLE_ACK_EVERY
+#define RELIABLE_ACK_EVERY 4
+#endif
+
+
+/**
+ * @struct reliable_stats
+ * @brief Cumulative reliability statistics
+ */
+struct reliable_stats
+{
+    uint32_t sent;          ///< Reliable frames queued for the first time
+    uint32_t acked;         ///< Frames confirmed by the peer
+    uint32_t retransmits;   ///< Frames sent again
+    uint32_t early_resends; ///< Retransmits before the timeout, after a later frame was acked
+    uint32_t received;      ///< Reliable frames delivered to handlers
+    uint32_t duplicates;    ///< Received frames suppressed as duplicates
+    uint32_t acks_sent;     ///< $ack frames sent
+};
+
+
+/**
+ * @class reliable_link
+ * @brief Sliding-window sender and duplicate filter for one peer
+ *
+ * Typical usage:
+ * @code
+ * static uint8_t arq_storage[8 * 64];
+ * reliable_link arq(sender, arq_storage, 64, 8, 50);
+ *
+ * executer.set_reply_sender(&sender);
+ * executer.set_reliable_link(&arq);
+ *
+ * int32_t on = 1;
+ * arq.send_int("ctrl/arm", &on, 1);
+ *
+ * // periodic task
+ * arq.tick();
+ * @endcode
+ *
+ * @note The sender must use a staging buffer no larger than slot_size;
+ *       otherwise every reliable send is refused.
+ * @note Both peers start with sequence number 0; call reset() on both
+ *       sides after a reconnect.
+ */
+class reliable_link
+{
+public:
+
+    /**
+     * @brief Constructs a reliable link
+     *
+     * @param sender    Staging sender used for data frames and ACKs
+     * @param storage   window * slot_size bytes for unacknowledged frames
+     * @param slot_size Maximum encoded frame size
+     * @param window    Frames in flight (1..RELIABLE_MAX_WINDOW)
+     * @param timeout   Ticks before an unacknowledged frame is resent
+     */
+    reliable_link(cmnd_sender& sender,
+                  uint8_t* storage,
+                  uint16_t slot_size,
+                  uint8_t window,
+                  uint16_t timeout);
+
+    /**
+     * @brief Sends a reliable trigger frame
+     * @return false if the window is full or the frame cannot be queued
+     */
+    bool send_trigger(const char* path);
+
+    /**
+     * @brief Sends reliable signed integers
+     * @return false if the window is full or the frame cannot be queued
+     */
+    bool send_int(const char* path, const int32_t* values, uint16_t count);
+
+    /**
+     * @brief Sends reliable floats
+     * @return false if the window is full or the frame cannot be queued
+     */
+    bool send_float(const char* path, const float* values, uint16_t count);
+
+    /**
+     * @brief Sends reliable strings
+     * @return false if the window is full or the frame cannot be queued
+     */
+    bool send_string(const char* path, const char* const* values, uint16_t count);
+
+    /**
+     * @brief Advances the retransmit timers by one tick
+     *
+     * Resends every unacknowledged frame whose timer has expired, and
+     * those on_ack() found lost.
+     * Does nothing while the sender has a batch open (its staging
+     * buffer holds the batch) or the peer sent XOFF.
+     */
+    void tick();
+
+    /**
+     * @brief Returns the number of unacknowledged frames
+     */
+    uint8_t in_flight() const { return (uint8_t)(tx_next - tx_base); }
+
+    /**
+     * @brief Returns true if another reliable frame can be sent
+     */
+    bool can_send() const { return in_flight() < window; }
+
+    /**
+     * @brief Drops all unacknowledged frames and restarts both sequences at 0
+     */
+    void reset();
+
+    /**
+     * @brief Returns cumulative statistics
+     */
+    const reliable_stats& stats() const { return counters; }
+
+    /**
+     * @brief Registers a received sequence number
+     *
+     * Called by cmnd_executer for frames with FRAME_TAG_SEQ.
+     *
+     * @param seq Received sequence number
+     * @return true if the frame is new and must be dispatched
+     */
+    bool accept(uint16_t seq);
+
+    /**
+     * @brief Processes an $ack from the peer
+     *
+     * An unacknowledged frame below one that was sent after it and is
+     * reported received is marked for resending on the next tick().
+     *
+     * @param next Lowest sequence number the peer has not received
+     * @param mask Bit i set: next + 1 + i was received
+     */
+    void on_ack(uint16_t next, uint32_t mask);
+
+    /**
+     * @brief Sends a pending ACK when it is due
+     *
+     * Called by cmnd_executer after every frame.
+     *
+     * @param idle true if no further frames are queued
+     */
+    void flush_ack(bool idle);
+
+private:
+
+    /**
+     * @brief Prepares the sender to tag the next frame with tx_next
+     *
+     * @return false if the window is full, or the sender is not staged
+     *         or its staging buffer exceeds slot_size
+     */
+    bool begin();
+
+    /**
+     * @brief Stores the frame just sent for retransmission
+     *
+     * @param sent Result of the cmnd_sender call
+     * @return true if the frame was queued and stored
+     */
+    bool finish(bool sent);
+
+    /**
+     * @brief Per-frame bookkeeping of the transmit window
+     */
+    struct slot
+    {
+        uint16_t len;    ///< Encoded frame length (0 = acknowledged)
+        uint16_t age;    ///< Ticks since the last transmission
+        bool     lost;   ///< A later frame was acked: resend on the next tick
+    };
+
+    cmnd_sender&   tx;
+    uint8_t*       frames;      ///< window * slot_size bytes
+    uint16_t       slot_size;
+    uint8_t        window;
+    uint16_t       timeout;
+
+    slot           slots[RELIABLE_MAX_WINDOW];
+    uint16_t       tx_base;     ///< Oldest unacknowledged sequence number
+    uint16_t       tx_next;     ///< Next sequence number to send
+    uint8_t        base_slot;   ///< Slot holding tx_base
+
+    uint16_t       rx_next;     ///< Lowest sequence number not yet received
+    uint32_t       rx_mask;     ///< Bit i: rx_next + 1 + i received
+    uint8_t        ack_due;     ///< Frames received since the last ACK
+
+    reliable_stats counters;
+};
+
+#endif // PATHWIRE_INC_CORE_RELIABLE_LINK_H_
@@ -0,0 +1,139 @@
+/**
+ * @file reply_writer.h
+ * @brief Reply to a request, formatted straight into the outgoing frame
+ *
+ * This file defines the reply_writer class, which request handlers use
+ * to answer a request frame ({q<id>:...}). The writer is bound to the
+ * executer's reply sender: begin() opens a reply frame ({r<id>:...}),
+ * each add_*() call encodes one value directly into that frame, and
+ * end() queues it.
+ *
+ * Example:
+ * @code
+ * static void on_param_get(data_type type, const void* data, uint16_t count,
+ *                          reply_writer& reply)
+ * {
+ *     const int32_t* ids = static_cast<const int32_t*>(data);
+ *
+ *     reply.begin("param/value", data_type::INT);
+ *     for (uint16_t i = 0; i < count; i++)
+ *         reply.add_int(params[ids[i]]);
+ *     reply.end();
+ * }
+ * @endcode
+ *
+ * Design goals:
+ * - No intermediate value arrays or formatting buffers
+ * - The reply carries the request's ID without handler bookkeeping
+ * - No dynamic memory allocation
+ */
+#ifndef PATHWIRE_INC_CORE_REPLY_WRITER_H_
+#define PATHWIRE_INC_CORE_REPLY_WRITER_H_
+
+#include <stdint.h>
+
+#include "core/cmnd_frame.h"
+
+class cmnd_sender;
+
+
+/**
+ * @class reply_writer
+ * @brief Builds the reply frame of one request
+ *
+ * Created by cmnd_executer for every request handled through its
+ * request table and valid only for the duration of the handler call.
+ * A reply left open by the handler is completed when the handler
+ * returns; a handler that never calls begin() sends no reply.
+ *
+ * The reply sender should use a staging buffer: a reply that does not
+ * fit its queue is then dropped as a whole.
+ */
+class reply_writer
+{
+public:
+
+    /**
+     * @brief Constructs a writer for one request
+     *
+     * @param sender  Reply sender (nullptr = replies are discarded)
+     * @param request Request ID to echo
+     */
+    reply_writer(cmnd_sender* sender, uint16_t request);
+
+    /**
+     * @brief Opens the reply frame
+     *
+     * @param path Reply path
+     * @param type Type of the values that follow (INT, FLOAT, STRING or
+     *             NONE for an empty reply)
+     *
+     * @return false if there is no reply sender, a reply was already
+     *         begun, or the frame header does not fit
+     */
+    bool begin(const char* path, data_type type);
+
+    /**
+     * @brief Appends one integer (INT replies)
+     *
+     * Values of the wrong type are refused without affecting the reply;
+     * a value that does not fit abandons it.
+     */
+    bool add_int(int32_t value);
+
+    /**
+     * @brief Appends one float (FLOAT replies)
+     */
+    bool add_float(float value);
+
+    /**
+     * @brief Appends one string (STRING replies; must not contain ',')
+     */
+    bool add_string(const char* value);
+
+    /**
+     * @brief Completes and queues the reply frame
+     *
+     * @return false if the reply failed at any point or does not fit
+     *         the TX queue
+     */
+    bool end();
+
+    /**
+     * @brief Returns the request ID being answered
+     */
+    uint16_t request() const { return id; }
+
+    /**
+     * @brief Returns true between begin() and end()
+     */
+    bool is_open() const { return state == state_t::OPEN; }
+
+private:
+
+    /**
+     * @brief Progress of the reply
+     */
+    enum class state_t : uint8_t {
+        IDLE,    ///< begin() not called yet
+        OPEN,    ///< Values are being added
+        DONE,    ///< Queued
+        FAILED   ///< Abandoned; nothing more is written
+    };
+
+    /**
+     * @brief Checks and separates the next value of the given type
+     *
+     * @return false if no reply of that type is open, or (and FAILED)
+     *         if the separator does not fit
+     */
+    bool next_value(data_type value_type);
+
+    cmnd_sender* tx;
+    uint16_t     id;
+    data_type    type;
+    uint16_t     count;
+    state_t      state;
+};
+
+#endif // PATHWIRE_INC_CORE_REPLY_WRITER_H_
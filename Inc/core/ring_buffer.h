@@ -54,13 +54,13 @@ public:
      */
     bool push(const T& item)
     {
-        uint16_t next = (prd + 1) % buffer_size;
+        uint16_t next = wrap(prd + 1U);
         if (next == cns)
         {
             return false; // Buffer full
         }
 
-        buffer[prd % buffer_size] = item;
+        buffer[prd] = item;
         prd = next;
         return true;
     }
@@ -78,12 +78,143 @@ public:
             return false; // Buffer empty
         }
 
-        out = buffer[cns % buffer_size];
-        cns = (cns + 1) % buffer_size;
+        out = buffer[cns];
+        cns = wrap(cns + 1U);
         return true;
     }
 
+    /**
+     * @brief Checks whether the buffer is empty
+     *
+     * @return true if no element is stored
+     */
+    bool empty() const
+    {
+        return cns == prd;
+    }
+
+    /**
+     * @brief Returns the number of stored elements
+     */
+    uint16_t count() const
+    {
+        return (uint16_t)(prd >= cns ? prd - cns : prd + buffer_size - cns);
+    }
+
+    /**
+     * @brief Returns the number of elements that can still be pushed
+     */
+    uint16_t space() const
+    {
+        return (uint16_t)(buffer_size - 1 - count());
+    }
+
+    /**
+     * @brief Returns the backing storage passed to the constructor
+     *
+     * For transports that register the storage with the kernel once
+     * (e.g. io_uring fixed buffers).
+     */
+    T* storage() const
+    {
+        return buffer;
+    }
+
+    /**
+     * @brief Returns the number of elements in the backing storage
+     */
+    uint16_t capacity() const
+    {
+        return buffer_size;
+    }
+
+    /**
+     * @brief Returns the stored elements as up to two contiguous regions
+     *
+     * Lets the consumer hand the contents to bulk operations (e.g.
+     * writev()) without copying. Call consume() afterwards.
+     *
+     * @param first      Receives the start of the oldest elements
+     * @param first_len  Receives the number of elements at first
+     * @param second     Receives the start of the wrapped-around part
+     * @param second_len Receives the number of elements at second (may be 0)
+     * @return Total number of stored elements
+     */
+    uint16_t readable(T*& first, uint16_t& first_len,
+                      T*& second, uint16_t& second_len) const
+    {
+        first      = &buffer[cns];
+        second     = buffer;
+        first_len  = (prd >= cns) ? (uint16_t)(prd - cns) : (uint16_t)(buffer_size - cns);
+        second_len = (prd >= cns) ? 0 : prd;
+        return (uint16_t)(first_len + second_len);
+    }
+
+    /**
+     * @brief Removes elements after they were read through readable()
+     *
+     * @param n Number of elements to remove (at most count())
+     */
+    void consume(uint16_t n)
+    {
+        cns = wrap((uint32_t)cns + n);
+    }
+
+    /**
+     * @brief Returns the free space as up to two contiguous regions
+     *
+     * Lets the producer fill the buffer with bulk operations (e.g.
+     * readv()) without copying. Call produce() afterwards.
+     *
+     * @param first      Receives the start of the free space
+     * @param first_len  Receives the number of free elements at first
+     * @param second     Receives the start of the wrapped-around part
+     * @param second_len Receives the number of free elements at second (may be 0)
+     * @return Total number of free elements
+     */
+    uint16_t writable(T*& first, uint16_t& first_len,
+                      T*& second, uint16_t& second_len) const
+    {
+        // One slot always stays empty to tell a full buffer from an empty one
+        first  = &buffer[prd];
+        second = buffer;
+
+        if (prd >= cns)
+        {
+            first_len  = (uint16_t)(buffer_size - prd - (cns == 0 ? 1 : 0));
+            second_len = (cns == 0) ? 0 : (uint16_t)(cns - 1);
+        }
+        else
+        {
+            first_len  = (uint16_t)(cns - prd - 1);
+            second_len = 0;
+        }
+
+        return (uint16_t)(first_len + second_len);
+    }
+
+    /**
+     * @brief Publishes elements written through writable()
+     *
+     * @param n Number of elements written (at most space())
+     */
+    void produce(uint16_t n)
+    {
+        prd = wrap((uint32_t)prd + n);
+    }
+
 private:
+    /**
+     * @brief Folds an index advanced by at most buffer_size back into range
+     *
+     * Avoids a division per element on targets without a fast divider
+     * (and on hosts, where it dominates bulk transfers).
+     */
+    uint16_t wrap(uint32_t i) const
+    {
+        return (uint16_t)(i >= buffer_size ? i - buffer_size : i);
+    }
+
     T*       buffer;      ///< Pointer to backing storage
     uint16_t buffer_size; ///< Number of elements in buffer
     uint16_t prd;         ///< Producer index
@@ -0,0 +1,155 @@
+/**
+ * @file sample_aggregator.h
+ * @brief Windowed decimation and aggregation of high-rate signals
+ *
+ * This file defines the sample_aggregator class, which sits between a
+ * high-rate producer (e.g. a 1 kHz IMU loop) and cmnd_sender.
+ *
+ * Samples are accumulated over a fixed window and summarized by a set of
+ * aggregation stages. One frame containing all enabled summaries is sent
+ * per window, so the link rate is reduced by the window length without
+ * losing peaks the way naive decimation does.
+ *
+ * Available stages:
+ * - MEAN : arithmetic mean over the window
+ * - MIN  : minimum over the window
+ * - MAX  : maximum over the window
+ * - RMS  : root mean square over the window
+ * - LAST : most recent sample
+ *
+ * Frame layout (stage-major, channel-minor):
+ *   {p:<path>:d:<stage0 ch0..chN>,<stage1 ch0..chN>,...}
+ * in the stage order listed above, enabled stages only.
+ *
+ * Design goals:
+ * - Fixed-size state, no dynamic memory allocation
+ * - Branch-light per-sample update (all accumulators always updated)
+ */
+#ifndef PATHWIRE_INC_CORE_SAMPLE_AGGREGATOR_H_
+#define PATHWIRE_INC_CORE_SAMPLE_AGGREGATOR_H_
+
+#include <stdint.h>
+
+#include "core/cmnd_sender.h"
+
+
+/**
+ * @def AGGREGATOR_MAX_CHANNELS
+ * @brief Maximum number of channels per aggregator
+ */
+#ifndef AGGREGATOR_MAX_CHANNELS
+#define AGGREGATOR_MAX_CHANNELS 4
+#endif
+
+
+/**
+ * @enum aggregate_stage
+ * @brief Aggregation stage flags (combine with |)
+ */
+enum aggregate_stage : uint8_t
+{
+    AGG_MEAN = 1U << 0,  ///< Window mean
+    AGG_MIN  = 1U << 1,  ///< Window minimum
+    AGG_MAX  = 1U << 2,  ///< Window maximum
+    AGG_RMS  = 1U << 3,  ///< Window root mean square
+    AGG_LAST = 1U << 4   ///< Last sample of the window
+};
+
+
+/**
+ * @class sample_aggregator
+ * @brief Accumulates samples and emits one summary frame per window
+ *
+ * Typical usage:
+ * @code
+ * sample_aggregator gyro_agg(sender, "sens/IMU/gyro", 3, 10, AGG_MIN | AGG_MAX);
+ *
+ * // 1 kHz loop -> 100 Hz frames
+ * gyro_agg.push(gyro_xyz);
+ * @endcode
+ *
+ * @note A frame carries channels * enabled stages values, which must not
+ *       exceed MAX_CSV_ITEMS; the constructor rejects larger layouts
+ *       (see valid()).
+ */
+class sample_aggregator
+{
+public:
+
+    /**
+     * @brief Constructs an aggregator
+     *
+     * @param sender   Sender used to emit summary frames
+     * @param path     Null-terminated telemetry path
+     * @param channels Number of values per sample (1..AGGREGATOR_MAX_CHANNELS)
+     * @param window   Number of samples per summary frame (>= 1)
+     * @param stages   Combination of aggregate_stage flags
+     *
+     * If no stage is enabled, or channels * enabled stages exceeds
+     * MAX_CSV_ITEMS, the aggregator is invalid and push() refuses every
+     * sample.
+     */
+    sample_aggregator(cmnd_sender& sender,
+                      const char* path,
+                      uint8_t channels,
+                      uint16_t window,
+                      uint8_t stages);
+
+    /**
+     * @brief Adds one multi-channel sample
+     *
+     * Emits a summary frame when the window is complete.
+     *
+     * @param sample Pointer to channels float values
+     * @return false if a summary frame was rejected by the sender or the
+     *         aggregator is invalid
+     */
+    bool push(const float* sample);
+
+    /**
+     * @brief Adds one single-channel sample
+     *
+     * @param sample Sample value
+     * @return false if a summary frame was rejected by the sender or the
+     *         aggregator is invalid
+     */
+    bool push(float sample) { return push(&sample); }
+
+    /**
+     * @brief Discards the partially accumulated window
+     */
+    void reset();
+
+    /**
+     * @brief Returns false if the constructor rejected the frame layout
+     */
+    bool valid() const { return stages != 0; }
+
+    /**
+     * @brief Returns the number of summary frames rejected by the sender
+     */
+    uint32_t dropped() const { return drop_count; }
+
+private:
+
+    /**
+     * @brief Builds and sends the summary frame of the current window
+     */
+    bool emit();
+
+    cmnd_sender& tx;
+    const char*  path;
+    uint8_t      channels;
+    uint8_t      stages;
+    uint16_t     window;
+    uint16_t     n;           ///< Samples in the current window
+    uint32_t     drop_count;  ///< Summary frames rejected by the sender
+
+    float sum[AGGREGATOR_MAX_CHANNELS];
+    float sum_sq[AGGREGATOR_MAX_CHANNELS];
+    float min_v[AGGREGATOR_MAX_CHANNELS];
+    float max_v[AGGREGATOR_MAX_CHANNELS];
+    float last[AGGREGATOR_MAX_CHANNELS];
+};
+
+#endif // PATHWIRE_INC_CORE_SAMPLE_AGGREGATOR_H_
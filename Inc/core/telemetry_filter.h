@@ -0,0 +1,220 @@
+/**
+ * @file telemetry_filter.h
+ * @brief Deadband and change-driven telemetry suppression
+ *
+ * This file defines the telemetry_filter class, a thin layer in front of
+ * cmnd_sender that suppresses telemetry frames whose values have not
+ * changed meaningfully since the last transmitted frame.
+ *
+ * Each filtered path owns a deadband_entry holding its configuration
+ * (absolute or relative deadband, maximum silence interval) and the
+ * cached last-sent values. A suppressed frame costs zero link bytes.
+ *
+ * Supported payloads:
+ * - INT    : deadband applied per element
+ * - FLOAT  : deadband applied per element
+ * - STRING : any change is sent (compared by hash)
+ *
+ * Design goals:
+ * - No dynamic memory allocation
+ * - Bounded, per-path state
+ * - Same call shape as cmnd_sender
+ */
+#ifndef PATHWIRE_INC_CORE_TELEMETRY_FILTER_H_
+#define PATHWIRE_INC_CORE_TELEMETRY_FILTER_H_
+
+#include <stdint.h>
+
+#include "core/cmnd_sender.h"
+#include "core/cmnd_executer.h"
+
+
+/**
+ * @def DEADBAND_MAX_ITEMS
+ * @brief Number of cached values per filtered path
+ *
+ * Integer and float payloads with more elements are refused, since
+ * the elements past the cache could never be compared.
+ */
+#ifndef DEADBAND_MAX_ITEMS
+#define DEADBAND_MAX_ITEMS MAX_CSV_ITEMS
+#endif
+
+
+/**
+ * @enum deadband_mode
+ * @brief How the deadband threshold is interpreted
+ */
+enum class deadband_mode : uint8_t
+{
+    ANY_CHANGE,  ///< Send on any change (threshold ignored)
+    ABSOLUTE,    ///< Send when |value - last| > threshold
+    RELATIVE     ///< Send when |value - last| > threshold * |last|
+};
+
+
+/**
+ * @struct deadband_entry
+ * @brief Per-path deadband configuration and state
+ *
+ * Only the configuration fields need to be initialized; the state
+ * fields must start zeroed (e.g. static storage or value-initialization):
+ * @code
+ * static deadband_entry temp_db = { "sys/temp", deadband_mode::ABSOLUTE, 0.5f, 1000 };
+ * @endcode
+ */
+struct deadband_entry
+{
+    // Configuration
+    const char*   path;         ///< Null-terminated telemetry path
+    deadband_mode mode;         ///< Threshold interpretation
+    float         threshold;    ///< Absolute units or relative fraction
+    uint32_t      max_silence;  ///< Forced refresh interval (0 = never)
+
+    // State
+    union
+    {
+        int32_t i[DEADBAND_MAX_ITEMS];
+        float   f[DEADBAND_MAX_ITEMS];
+    }             last;         ///< Cached last-sent values
+    uint32_t      last_hash;    ///< Hash of the last-sent string payload
+    uint32_t      last_time;    ///< Time of the last transmission
+    uint16_t      last_count;   ///< Element count of the last transmission
+    bool          has_last;     ///< At least one frame has been sent
+
+    // Statistics
+    uint32_t      sent;         ///< Frames transmitted
+    uint32_t      suppressed;   ///< Frames suppressed as unchanged
+};
+
+
+/**
+ * @class telemetry_filter
+ * @brief Change-detecting front end for cmnd_sender
+ *
+ * Every send function returns true when the frame was either
+ * transmitted or intentionally suppressed, and false when the
+ * underlying sender rejected the frame or a numeric payload exceeds
+ * DEADBAND_MAX_ITEMS elements. The cached values are updated
+ * only after a successful transmission.
+ *
+ * Time is supplied by the caller in any monotonic unit and is only
+ * used for the max_silence refresh.
+ */
+class telemetry_filter
+{
+public:
+
+    /**
+     * @brief Constructs a filter in front of a sender
+     *
+     * @param sender Sender used for frames that pass the filter
+     */
+    telemetry_filter(cmnd_sender& sender);
+
+    /**
+     * @brief Sends integer telemetry if it left the deadband
+     *
+     * @param entry  Per-path deadband entry
+     * @param values Pointer to an array of int32_t values
+     * @param count  Number of elements in the values array
+     * @param now    Current time
+     * @return false if the sender rejected the frame or count exceeds
+     *         DEADBAND_MAX_ITEMS
+     */
+    bool send_int(deadband_entry& entry,
+                  const int32_t* values,
+                  uint16_t count,
+                  uint32_t now)
+    {
+        return send_int(entry, entry.path, values, count, now);
+    }
+
+    /**
+     * @brief Same as above, sending on a path other than entry.path
+     *
+     * Lets one deadband_entry filter a channel registered elsewhere
+     * under its own path (e.g. a telemetry_scheduler entry).
+     */
+    bool send_int(deadband_entry& entry,
+                  const char* path,
+                  const int32_t* values,
+                  uint16_t count,
+                  uint32_t now);
+
+    /**
+     * @brief Sends floating-point telemetry if it left the deadband
+     *
+     * @param entry  Per-path deadband entry
+     * @param values Pointer to an array of float values
+     * @param count  Number of elements in the values array
+     * @param now    Current time
+     * @return false if the sender rejected the frame or count exceeds
+     *         DEADBAND_MAX_ITEMS
+     */
+    bool send_float(deadband_entry& entry,
+                    const float* values,
+                    uint16_t count,
+                    uint32_t now)
+    {
+        return send_float(entry, entry.path, values, count, now);
+    }
+
+    /**
+     * @brief Same as above, sending on a path other than entry.path
+     *
+     * Lets one deadband_entry filter a channel registered elsewhere
+     * under its own path (e.g. a telemetry_scheduler entry).
+     */
+    bool send_float(deadband_entry& entry,
+                    const char* path,
+                    const float* values,
+                    uint16_t count,
+                    uint32_t now);
+
+    /**
+     * @brief Sends string telemetry if it changed
+     *
+     * @param entry  Per-path deadband entry
+     * @param values Pointer to an array of string pointers
+     * @param count  Number of strings in the values array
+     * @param now    Current time
+     * @return false only if the sender rejected the frame
+     */
+    bool send_string(deadband_entry& entry,
+                     const char* const* values,
+                     uint16_t count,
+                     uint32_t now)
+    {
+        return send_string(entry, entry.path, values, count, now);
+    }
+
+    /**
+     * @brief Same as above, sending on a path other than entry.path
+     */
+    bool send_string(deadband_entry& entry,
+                     const char* path,
+                     const char* const* values,
+                     uint16_t count,
+                     uint32_t now);
+
+private:
+
+    /**
+     * @brief Checks the max_silence refresh and first-send conditions
+     *
+     * @return true if the frame must be sent regardless of its values
+     */
+    static bool refresh_due(const deadband_entry& entry,
+                            uint16_t count,
+                            uint32_t now);
+
+    /**
+     * @brief Records a successful transmission
+     */
+    static void mark_sent(deadband_entry& entry, uint16_t count, uint32_t now);
+
+    cmnd_sender& tx;
+};
+
+#endif // PATHWIRE_INC_CORE_TELEMETRY_FILTER_H_
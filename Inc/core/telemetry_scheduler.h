@@ -0,0 +1,195 @@
+/**
+ * @file telemetry_scheduler.h
+ * @brief Periodic telemetry scheduler with burst aggregation
+ *
+ * This file defines the telemetry_scheduler class, which replaces
+ * hand-rolled per-channel timers with a single tick-driven registry of
+ * periodic telemetry entries.
+ *
+ * On every tick() the scheduler emits all entries that are due as one
+ * back-to-back burst through a cmnd_sender, with a single TX-ready
+ * notification for the whole burst. Entries are phase-spread when
+ * registered so that channels with related rates do not all fall due
+ * on the same tick.
+ *
+ * Design goals:
+ * - Fixed capacity, caller-provided storage
+ * - No dynamic memory allocation
+ * - Constant work per registered entry per tick
+ */
+#ifndef PATHWIRE_INC_CORE_TELEMETRY_SCHEDULER_H_
+#define PATHWIRE_INC_CORE_TELEMETRY_SCHEDULER_H_
+
+#include <stdint.h>
+
+#include "core/cmnd_sender.h"
+#include "core/cmnd_executer.h"
+#include "core/telemetry_filter.h"
+
+
+/**
+ * @typedef telemetry_getter
+ * @brief Callback producing the current value array of an entry
+ *
+ * @param ctx   User context registered with the entry
+ * @param count Receives the number of elements in the returned array
+ * @return Pointer to the value array (type given by the entry), valid
+ *         until the callback returns to the scheduler
+ */
+typedef const void* (*telemetry_getter)(void* ctx, uint16_t& count);
+
+
+/**
+ * @struct telemetry_entry
+ * @brief Description of one periodic telemetry channel
+ *
+ * Values are read either directly from source/count or, when getter is
+ * set, from the getter callback at emission time.
+ *
+ * When deadband is set, due values are passed through a telemetry_filter
+ * (using the scheduler tick count as time) and unchanged values are not
+ * transmitted. Frames still go out on the entry's path; the deadband's
+ * own path is not used. Numeric payloads are then limited to
+ * DEADBAND_MAX_ITEMS elements.
+ */
+struct telemetry_entry
+{
+    const char*      path;     ///< Null-terminated telemetry path
+    data_type        type;     ///< Payload type (NONE sends a trigger frame)
+    const void*      source;   ///< Value array read at emission time
+    uint16_t         count;    ///< Number of elements in source
+    telemetry_getter getter;   ///< Optional value callback (overrides source)
+    void*            ctx;      ///< User context passed to getter
+    uint16_t         period;   ///< Emission period in ticks (>= 1)
+    deadband_entry*  deadband; ///< Optional change filter (nullptr = always send)
+};
+
+
+/**
+ * @struct telemetry_slot
+ * @brief Scheduler storage for one registered entry
+ *
+ * Provided by the caller as an array; the contents are managed by
+ * telemetry_scheduler.
+ */
+struct telemetry_slot
+{
+    telemetry_entry entry;      ///< Registered entry
+    uint16_t        countdown;  ///< Ticks until the entry is next due
+    bool            active;     ///< Slot in use
+};
+
+
+/**
+ * @struct telemetry_stats
+ * @brief Cumulative scheduler statistics
+ */
+struct telemetry_stats
+{
+    uint32_t ticks;              ///< Number of tick() calls
+    uint32_t bursts;             ///< Ticks that emitted at least one frame
+    uint32_t frames_sent;        ///< Frames successfully queued
+    uint32_t frames_dropped;     ///< Frames rejected by the sender
+    uint32_t frames_suppressed;  ///< Due frames suppressed by a deadband
+    uint16_t max_burst;          ///< Largest number of frames in one burst
+    uint32_t bytes_sent;         ///< Bytes queued by the sender for telemetry
+    uint16_t max_burst_bytes;    ///< Largest number of bytes queued in one burst
+};
+
+
+/**
+ * @class telemetry_scheduler
+ * @brief Tick-driven periodic telemetry emitter
+ *
+ * Typical usage:
+ * @code
+ * telemetry_slot slots[16];
+ * telemetry_scheduler sched(sender, slots, 16);
+ *
+ * sched.add({ "sens/IMU/gyro", data_type::FLOAT, gyro, 3, nullptr, nullptr, 10 });
+ * sched.add({ "sys/temp",      data_type::INT,   &temp, 1, nullptr, nullptr, 1000 });
+ *
+ * // 1 kHz timer / task
+ * sched.tick();
+ * @endcode
+ *
+ * @note tick() performs the actual sending and must run in a context
+ *       that is allowed to use the bound cmnd_sender.
+ */
+class telemetry_scheduler
+{
+public:
+
+    /**
+     * @brief Constructs a scheduler over caller-provided slots
+     *
+     * @param sender   Sender used to emit telemetry frames
+     * @param slots    Storage for registered entries
+     * @param capacity Number of elements in slots
+     */
+    telemetry_scheduler(cmnd_sender& sender,
+                        telemetry_slot* slots,
+                        uint16_t capacity);
+
+    /**
+     * @brief Registers a periodic entry
+     *
+     * The first emission is delayed by a phase offset derived from the
+     * slot index (bit-reversed fraction of the period), which spreads
+     * entries evenly over their period.
+     *
+     * @param entry Entry description (copied into the slot)
+     * @return Slot index, or -1 if the scheduler is full or entry is
+     *         invalid (including a deadband on more than
+     *         DEADBAND_MAX_ITEMS numeric source values)
+     */
+    int16_t add(const telemetry_entry& entry);
+
+    /**
+     * @brief Unregisters an entry
+     *
+     * @param index Slot index returned by add()
+     */
+    void remove(int16_t index);
+
+    /**
+     * @brief Changes the emission period of an entry
+     *
+     * @param index  Slot index returned by add()
+     * @param period New period in ticks (>= 1)
+     */
+    void set_period(int16_t index, uint16_t period);
+
+    /**
+     * @brief Advances scheduler time by one tick
+     *
+     * Emits every due entry in a single burst.
+     *
+     * @return Number of frames queued during this tick
+     */
+    uint16_t tick();
+
+    /**
+     * @brief Returns cumulative statistics
+     */
+    const telemetry_stats& stats() const { return counters; }
+
+private:
+
+    /**
+     * @brief Emits one entry through the sender or its deadband filter
+     *
+     * @param e          Entry to emit
+     * @param suppressed Set to true if the deadband suppressed the frame
+     * @return true if the frame was queued or suppressed
+     */
+    bool emit(const telemetry_entry& e, bool& suppressed);
+
+    cmnd_sender&     tx;
+    telemetry_filter filter;
+    telemetry_slot*  slot_table;
+    uint16_t         slot_count;
+    telemetry_stats  counters;
+};
+
+#endif // PATHWIRE_INC_CORE_TELEMETRY_SCHEDULER_H_
@@ -0,0 +1,177 @@
+/**
+ * @file tx_lanes.h
+ * @brief Prioritized transmit lanes drained at frame boundaries
+ *
+ * This file defines the tx_lanes class, which multiplexes several
+ * independent TX queues ("lanes") onto a single transport.
+ *
+ * Each lane carries complete frames only. The transport drains bytes
+ * through tx_lanes::pop(), which selects a new lane only when the
+ * previous frame has been fully transmitted. A command reply queued on
+ * a high-priority lane therefore waits for at most one frame of bulk
+ * telemetry instead of the whole TX backlog.
+ *
+ * Lane selection policies:
+ * - STRICT   : the lowest-numbered non-empty lane always wins
+ * - WEIGHTED : smooth weighted round-robin over non-empty lanes
+ *
+ * Design goals:
+ * - No dynamic memory allocation
+ * - Multi-producer safe publishing (lanes are mp_ring_buffer queues)
+ * - Constant-time per byte on the transport side
+ */
+#ifndef PATHWIRE_INC_CORE_TX_LANES_H_
+#define PATHWIRE_INC_CORE_TX_LANES_H_
+
+#include <stdint.h>
+#include <atomic>
+
+#include "core/mp_ring_buffer.h"
+
+
+/**
+ * @def TX_LANES_MAX
+ * @brief Maximum number of lanes per tx_lanes instance
+ */
+#ifndef TX_LANES_MAX
+#define TX_LANES_MAX 4
+#endif
+
+
+/**
+ * @enum lane_policy
+ * @brief Lane selection policy applied at every frame boundary
+ */
+enum class lane_policy : uint8_t
+{
+    STRICT,    ///< Highest priority (lowest index) non-empty lane first
+    WEIGHTED   ///< Non-empty lanes share the link in proportion to weight
+};
+
+
+/**
+ * @typedef tx_clock_fn
+ * @brief Monotonic time source used for queue wait statistics
+ *
+ * Any unit may be used (ticks, microseconds, ...); wait statistics are
+ * reported in the same unit. Only the low 16 bits are recorded per frame.
+ */
+typedef uint32_t (*tx_clock_fn)();
+
+
+/**
+ * @struct tx_lane_stats
+ * @brief Snapshot of per-lane queue statistics
+ */
+struct tx_lane_stats
+{
+    uint16_t depth_bytes;     ///< Bytes currently queued (including headers)
+    uint16_t depth_frames;    ///< Frames currently queued
+    uint32_t frames_sent;     ///< Frames handed to the transport
+    uint32_t frames_dropped;  ///< Frames rejected because the lane was full
+    uint32_t wait_total;      ///< Sum of queue wait times of sent frames
+    uint16_t wait_max;        ///< Largest observed queue wait time
+};
+
+
+/**
+ * @class tx_lanes
+ * @brief Frame-granular priority multiplexer for a single transport
+ *
+ * Frames are stored in the lane queue with a 4-byte header holding the
+ * frame length and the enqueue timestamp. The header is consumed by
+ * pop() and never reaches the transport.
+ *
+ * @note publish() may be called from any number of producers.
+ * @note pop() and get_stats() wait time fields belong to the transport context.
+ */
+class tx_lanes
+{
+public:
+
+    /**
+     * @brief Constructs an empty lane set
+     *
+     * @param policy Lane selection policy
+     * @param clock  Optional time source for wait statistics (may be nullptr)
+     */
+    tx_lanes(lane_policy policy, tx_clock_fn clock = nullptr);
+
+    /**
+     * @brief Appends a lane
+     *
+     * Lanes are prioritized in the order they are added: the first lane
+     * has the highest priority under STRICT policy.
+     *
+     * @param queue  Lane storage queue (must outlive this object)
+     * @param weight Relative share of the link under WEIGHTED policy (>= 1)
+     * @return Lane index, or -1 if TX_LANES_MAX lanes already exist
+     */
+    int8_t add_lane(mp_ring_buffer& queue, uint8_t weight = 1);
+
+    /**
+     * @brief Queues a complete frame on a lane
+     *
+     * @param lane  Lane index returned by add_lane()
+     * @param frame Frame bytes
+     * @param len   Frame length in bytes
+     * @return true if the frame was queued, false if the lane is full
+     */
+    bool publish(uint8_t lane, const uint8_t* frame, uint16_t len);
+
+    /**
+     * @brief Pops the next byte to transmit (transport side)
+     *
+     * Continues the frame currently in progress. At a frame boundary the
+     * next lane is chosen according to the configured policy.
+     *
+     * @param out Reference to receive the byte
+     * @return true if a byte is available, false if all lanes are empty
+     */
+    bool pop(uint8_t& out);
+
+    /**
+     * @brief Returns statistics for a lane
+     *
+     * @param lane Lane index
+     * @param out  Receives the statistics snapshot
+     */
+    void get_stats(uint8_t lane, tx_lane_stats& out) const;
+
+    /**
+     * @brief Returns the number of configured lanes
+     */
+    uint8_t lane_count() const { return count; }
+
+private:
+
+    /**
+     * @brief Chooses the lane holding the next frame
+     *
+     * @return Lane index, or -1 if no lane has a complete frame
+     */
+    int8_t select_lane();
+
+    struct lane
+    {
+        mp_ring_buffer*       queue;           ///< Lane storage
+        uint8_t               weight;          ///< WEIGHTED policy share
+        int16_t               credit;          ///< Smooth WRR running credit
+        std::atomic<uint16_t> queued;          ///< Frames published (wrapping)
+        uint16_t              sent;            ///< Frames popped (wrapping)
+        std::atomic<uint32_t> dropped;         ///< Frames rejected on publish
+        uint32_t              frames_sent;     ///< Frames handed to the transport
+        uint32_t              wait_total;      ///< Sum of wait times
+        uint16_t              wait_max;        ///< Maximum wait time
+    };
+
+    lane        lanes[TX_LANES_MAX];
+    uint8_t     count;       ///< Number of configured lanes
+    lane_policy policy;      ///< Selection policy
+    tx_clock_fn clock;       ///< Optional time source
+
+    int8_t      current;     ///< Lane of the frame in progress (-1 if none)
+    uint16_t    remaining;   ///< Bytes left in the frame in progress
+};
+
+#endif // PATHWIRE_INC_CORE_TX_LANES_H_
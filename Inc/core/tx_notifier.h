@@ -2,8 +2,10 @@
  * @file tx_notifier.h
  * @brief Transmission-ready notification interface
  *
- * This file defines a lightweight callback mechanism used to notify
- * the system when transmission resources are available.
+ * This file defines a lightweight callback object used to notify a
+ * transport when a sender has queued bytes for it. Every cmnd_sender
+ * holds its own notifier (see cmnd_sender::set_tx_notifier()), so
+ * several senders and links can drive different transports.
  *
  * Typical use cases:
  * - UART TX buffer ready
@@ -19,28 +21,37 @@
  *
  * Called when the system is ready to transmit data.
  *
+ * @param ctx Context pointer of the notifier (e.g. the UART)
+ *
  * @note Must be non-blocking.
  * @note Should execute quickly.
  */
-typedef void (*tx_notify_fn)();
+typedef void (*tx_notify_fn)(void* ctx);
 
 /**
- * @brief Registers a transmission-ready callback
- *
- * @param fn Callback function to register
+ * @struct tx_notifier
+ * @brief Transmission-ready callback bound to a context
  *
- * @note Only one notifier is supported.
- * @note Passing nullptr disables notifications.
+ * A plain function pointer and context: notify() is an inlined test
+ * and indirect call, with no virtual dispatch.
  */
-void register_tx_notifier(tx_notify_fn fn);
+struct tx_notifier
+{
+    tx_notify_fn fn;   ///< Callback (nullptr = notifications disabled)
+    void*        ctx;  ///< Context passed to fn
 
-/**
- * @brief Notifies that transmission is ready
- *
- * Invokes the registered callback, if any.
- *
- * @note Safe to call from ISR if implementation allows.
- */
-void notify_tx_ready();
+    /**
+     * @brief Notifies that transmission is ready
+     *
+     * Invokes the callback, if any.
+     *
+     * @note Safe to call from ISR if the callback allows.
+     */
+    void notify() const
+    {
+        if (fn)
+            fn(ctx);
+    }
+};
 
 #endif // PATHWIRE_INC_CORE_TX_NOTIFIER_H_
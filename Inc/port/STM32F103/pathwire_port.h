@@ -1,4 +1,6 @@
 #pragma once
 
+#include "core/cmnd_sender.h"
 
-void pathwire_port_init();
+/* Routes the TX notifications of sender to usart2_tx_kick(); once per sender on USART2 */
+void pathwire_port_init(cmnd_sender& sender);
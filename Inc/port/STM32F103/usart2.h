@@ -3,10 +3,16 @@
 
 #include "stm32f103xb.h"
 #include "core/ring_buffer.h"
+#include "core/mp_ring_buffer.h"
+#include "core/tx_lanes.h"
+#include "core/flow_control.h"
 
 extern uint8_t usart2_rx_storage[512];
 extern ring_buffer<uint8_t> usart2_rx_buffer;
 
+/* Bytes dropped because usart2_rx_buffer was full */
+extern volatile uint32_t usart2_rx_overruns;
+
 extern uint8_t usart2_tx_storage[512];
 extern ring_buffer<uint8_t> usart2_tx_buffer;
 
@@ -55,4 +61,13 @@ void usart2_tx_kick(void);
 }
 #endif
 
+/* Drain TX from a multi-producer queue instead of usart2_tx_buffer (nullptr restores it) */
+void usart2_attach_tx_queue(mp_ring_buffer* queue);
+
+/* Drain TX from a priority lane set instead of the queues above (nullptr restores them) */
+void usart2_attach_tx_lanes(tx_lanes* lanes);
+
+/* Flag XOFF from the RX interrupt at the high watermark; flow->poll() sends it (nullptr detaches) */
+void usart2_attach_rx_flow(flow_control* flow);
+
 #endif
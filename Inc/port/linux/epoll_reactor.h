@@ -0,0 +1,61 @@
+#ifndef PATHWIRE_INC_PORT_LINUX_EPOLL_REACTOR_H_
+#define PATHWIRE_INC_PORT_LINUX_EPOLL_REACTOR_H_
+
+#include <stdint.h>
+#include <atomic>
+
+/* Maximum number of file descriptors watched by one reactor */
+#ifndef REACTOR_MAX_SOURCES
+#define REACTOR_MAX_SOURCES 16
+#endif
+
+/* Called from run_once() with the ready epoll events of the descriptor */
+typedef void (*io_handler)(void* ctx, uint32_t events);
+
+/*
+ * Single-threaded epoll event loop.
+ *
+ * Descriptors are registered with a handler and a context pointer and
+ * dispatched from run_once()/run(). set_events() and stop() may be
+ * called from any thread; a running epoll_wait() picks up the change.
+ */
+class epoll_reactor
+{
+public:
+    epoll_reactor();
+    ~epoll_reactor();
+
+    epoll_reactor(const epoll_reactor&) = delete;
+    epoll_reactor& operator=(const epoll_reactor&) = delete;
+
+    /* false if the epoll or wake-up descriptor could not be created */
+    bool valid() const { return epfd >= 0 && wakefd >= 0; }
+
+    bool add(int fd, uint32_t events, io_handler handler, void* ctx);
+    bool set_events(int fd, uint32_t events);
+    bool remove(int fd);
+
+    /* Waits up to timeout_ms (-1 = forever); returns handled events or -1 */
+    int run_once(int timeout_ms);
+
+    /* Dispatches events until stop() */
+    void run();
+    void stop();
+
+private:
+    struct source
+    {
+        int        fd;       ///< -1 = free slot
+        io_handler handler;
+        void*      ctx;
+    };
+
+    source* find(int fd);
+
+    int               epfd;
+    int               wakefd;  ///< eventfd that interrupts epoll_wait()
+    std::atomic<bool> running;
+    source            sources[REACTOR_MAX_SOURCES];
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef PATHWIRE_INC_PORT_LINUX_FRAME_SIGNAL_H_
+#define PATHWIRE_INC_PORT_LINUX_FRAME_SIGNAL_H_
+
+#include <stdint.h>
+#include <atomic>
+
+#include "core/cmnd_parser.h"
+#include "port/linux/epoll_reactor.h"
+
+struct frame_signal_stats
+{
+    uint64_t notified;      ///< Frames signalled by the parser
+    uint64_t wakeups;       ///< Times the eventfd was written
+};
+
+/*
+ * eventfd-backed frame-ready notifier for a cmnd_parser.
+ *
+ *   frame_signal frames_ready;
+ *   frames_ready.attach(parser);
+ *   frames_ready.attach(reactor, drain_frames, &executer);
+ *
+ * The parser signals every queued frame; while a wake-up is pending
+ * further frames cost no system call. The executer then runs only when
+ * there is work: either from a reactor handler on fd(), or from a loop
+ * that sleeps in wait().
+ *
+ * On a host the parser and executer of one link stay on one thread
+ * (ring_buffer has no atomics, so the RX-interrupt split that
+ * cmnd_executer::poll() allows on a single-core MCU does not carry
+ * over to threads); typically the reactor's RX handler only
+ * parses and the signal's handler drains the executer.
+ */
+class frame_signal
+{
+public:
+    frame_signal();
+    ~frame_signal();
+
+    frame_signal(const frame_signal&) = delete;
+    frame_signal& operator=(const frame_signal&) = delete;
+
+    /* false if the eventfd could not be created */
+    bool valid() const { return efd >= 0; }
+
+    /* Readable while a frame-ready signal is pending */
+    int fd() const { return efd; }
+
+    /* Makes parser signal this object (set_frame_notifier()) */
+    void attach(cmnd_parser& parser);
+
+    /* Calls handler(ctx) from reactor whenever frames are ready */
+    bool attach(epoll_reactor& reactor, void (*handler)(void* ctx), void* ctx);
+
+    /* Sleeps up to timeout_ms (-1 = forever) for a signal; false on timeout */
+    bool wait(int timeout_ms = -1);
+
+    frame_signal_stats stats() const;
+
+    /* frame_notify_fn of the signal; ctx is the frame_signal */
+    static void notify(void* ctx);
+
+private:
+    static void on_ready(void* ctx, uint32_t events);
+
+    /* Consumes the pending signal before the queue is looked at */
+    void clear();
+
+    int                   efd;
+    std::atomic<bool>     pending;
+    epoll_reactor*        reactor;
+    void                (*ready_fn)(void* ctx);
+    void*                 ready_ctx;
+
+    std::atomic<uint64_t> notified;
+    std::atomic<uint64_t> wakeups;
+};
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef PATHWIRE_INC_PORT_LINUX_PATHWIRE_PORT_H_
+#define PATHWIRE_INC_PORT_LINUX_PATHWIRE_PORT_H_
+
+#include "core/cmnd_sender.h"
+#include "port/linux/serial_port.h"
+
+/* Routes the TX notifications of sender to port.arm_tx(); once per sender on the port */
+void pathwire_port_init(serial_port& port, cmnd_sender& sender);
+
+#endif
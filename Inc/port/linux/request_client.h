@@ -0,0 +1,199 @@
+#ifndef PATHWIRE_INC_PORT_LINUX_REQUEST_CLIENT_H_
+#define PATHWIRE_INC_PORT_LINUX_REQUEST_CLIENT_H_
+
+#include <stdint.h>
+#include <coroutine>
+#include <exception>
+
+#include "core/cmnd_executer.h"
+#include "core/cmnd_sender.h"
+#include "port/linux/epoll_reactor.h"
+
+/* Requests in flight at once (power of two); further requests wait their turn */
+#ifndef REQUEST_MAX_PENDING
+#define REQUEST_MAX_PENDING 64
+#endif
+
+/* Reply payload bytes kept per request (values, or strings with terminators) */
+#ifndef REQUEST_MAX_REPLY
+#define REQUEST_MAX_REPLY 256
+#endif
+
+/* Default timeout of a request */
+#ifndef REQUEST_TIMEOUT_MS
+#define REQUEST_TIMEOUT_MS 1000
+#endif
+
+/* Retry interval for requests refused by a full TX queue */
+#ifndef REQUEST_RETRY_US
+#define REQUEST_RETRY_US 500
+#endif
+
+static_assert((REQUEST_MAX_PENDING & (REQUEST_MAX_PENDING - 1)) == 0,
+              "REQUEST_MAX_PENDING must be a power of two");
+
+class request_client;
+
+enum class request_status : uint8_t
+{
+    OK,         ///< Reply received
+    TIMEOUT,    ///< No reply before the deadline (or the request could not be sent)
+    OVERSIZE    ///< Reply received but larger than REQUEST_MAX_REPLY
+};
+
+/* Reply to one request, owned by the awaiting coroutine */
+struct request_reply
+{
+    request_status status;
+    data_type      type;
+    uint16_t       count;       ///< Values or strings in data
+    uint64_t       rtt_ns;      ///< Time from sending the request to its reply
+
+    alignas(8) uint8_t data[REQUEST_MAX_REPLY];
+
+    const int32_t* ints() const   { return reinterpret_cast<const int32_t*>(data); }
+    const float*   floats() const { return reinterpret_cast<const float*>(data); }
+
+    /* String i of a STRING reply (nullptr if i >= count) */
+    const char* string(uint16_t i) const;
+};
+
+struct request_stats
+{
+    uint64_t sent;          ///< Requests written to the TX queue
+    uint64_t replies;       ///< Requests completed by their reply
+    uint64_t timeouts;      ///< Requests completed by their deadline
+    uint64_t stale;         ///< Replies that matched no request in flight (late or unknown)
+    uint64_t tx_full;       ///< Times sending stopped at a full TX queue
+};
+
+/*
+ * Pending request; returned by request_client::request() and awaited
+ * with co_await, which yields its request_reply.
+ */
+class request_op
+{
+public:
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h);
+    request_reply await_resume() { return result; }
+
+private:
+    friend class request_client;
+
+    request_op(request_client& client, const char* path, data_type type,
+               const void* values, uint16_t count, uint32_t timeout_ms);
+
+    request_client*         client;
+    const char*             path;
+    data_type               arg_type;
+    uint16_t                arg_count;
+    uint32_t                timeout_ms;
+    union
+    {
+        int32_t             i[MAX_CSV_ITEMS];
+        float               f[MAX_CSV_ITEMS];
+    }                       args;
+
+    uint16_t                id;
+    uint64_t                deadline_ns;
+    uint64_t                sent_ns;
+    request_op*             next;           ///< Next request waiting to be sent
+    std::coroutine_handle<> waiter;
+    request_reply           result;
+};
+
+/* Eagerly started, detached coroutine for code that awaits requests */
+struct request_task
+{
+    struct promise_type
+    {
+        request_task        get_return_object() { return {}; }
+        std::suspend_never  initial_suspend() noexcept { return {}; }
+        std::suspend_never  final_suspend() noexcept { return {}; }
+        void                return_void() {}
+        void                unhandled_exception() { std::terminate(); }
+    };
+};
+
+/*
+ * Coroutine request/response client on an epoll_reactor.
+ *
+ *   request_task read_gains(request_client& c)
+ *   {
+ *       request_reply r = co_await c.request("param/get", ids, 2);
+ *       if (r.status == request_status::OK) ...
+ *   }
+ *
+ * Each request is tagged with a request ID ({q<id>:p:...}) and the
+ * peer's reply carries the same ID in a reply tag ({r<id>:p:...}).
+ * Requests from the peer are still served by the executer's tables.
+ * Replies are taken from the link's executer (set_response_handler())
+ * and resume the waiting coroutine directly from executer.poll(), so no
+ * loop polls or sleeps for them.
+ *
+ * Up to REQUEST_MAX_PENDING requests are in flight at once; more wait
+ * in arrival order and go out as replies free their slots. Requests
+ * refused by a full TX queue are retried every REQUEST_RETRY_US. Every
+ * request has a deadline, tracked with one timerfd on the reactor; a
+ * reply that arrives after its deadline is counted as stale.
+ *
+ * Everything runs on the reactor thread. The sender must use a staging
+ * buffer, so that a refused request leaves nothing in the TX queue.
+ */
+class request_client
+{
+public:
+    request_client(epoll_reactor& reactor, cmnd_executer& executer, cmnd_sender& sender);
+    ~request_client();
+
+    request_client(const request_client&) = delete;
+    request_client& operator=(const request_client&) = delete;
+
+    /* false if the timer descriptor could not be created */
+    bool valid() const { return timer_fd >= 0; }
+
+    request_op request(const char* path, uint32_t timeout_ms = REQUEST_TIMEOUT_MS);
+    request_op request(const char* path, const int32_t* values, uint16_t count,
+                       uint32_t timeout_ms = REQUEST_TIMEOUT_MS);
+    request_op request(const char* path, const float* values, uint16_t count,
+                       uint32_t timeout_ms = REQUEST_TIMEOUT_MS);
+
+    /* Requests sent and not yet answered */
+    uint16_t in_flight() const { return pending; }
+
+    const request_stats& stats() const { return counters; }
+
+private:
+    friend class request_op;
+
+    static void on_response(void* ctx, uint16_t id, data_type type, const void* data, uint16_t count);
+    static void on_timer(void* ctx, uint32_t events);
+
+    void submit(request_op& op);
+    bool send(request_op& op);
+    void flush();
+    void expire();
+    void arm_timer(uint64_t at_ns);
+    void rearm();
+
+    epoll_reactor&  reactor;
+    cmnd_executer&  executer;
+    cmnd_sender&    sender;
+
+    int             timer_fd;
+    uint64_t        timer_ns;           ///< Armed expiry, 0 = disarmed
+    bool            tx_blocked;         ///< The head of the backlog was refused
+
+    request_op*     slots[REQUEST_MAX_PENDING];
+    uint16_t        generation[REQUEST_MAX_PENDING];
+    uint16_t        pending;
+    uint16_t        next_slot;
+
+    request_op*     backlog_head;       ///< Not sent yet, in arrival order
+    request_op*     backlog_tail;
+
+    request_stats   counters;
+};
+
+#endif
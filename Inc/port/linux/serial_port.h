@@ -0,0 +1,123 @@
+#ifndef PATHWIRE_INC_PORT_LINUX_SERIAL_PORT_H_
+#define PATHWIRE_INC_PORT_LINUX_SERIAL_PORT_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <atomic>
+
+#include "core/ring_buffer.h"
+#include "core/tx_lanes.h"
+#include "port/linux/epoll_reactor.h"
+
+/* Bytes taken from tx_lanes per write() */
+#ifndef SERIAL_TX_CHUNK
+#define SERIAL_TX_CHUNK 256
+#endif
+
+/* Called from the reactor after new bytes were placed in the RX ring */
+typedef void (*rx_ready_fn)(void* ctx);
+
+struct serial_stats
+{
+    uint64_t rx_bytes;   ///< Bytes read into the RX ring
+    uint64_t tx_bytes;   ///< Bytes written
+    uint32_t reads;      ///< read()/readv() calls that returned data
+    uint32_t writes;     ///< write()/writev() calls that wrote data
+    uint32_t rx_stalls;  ///< Times reading stopped because the RX ring was full
+    uint32_t hangups;    ///< Times the port was closed because the peer went away
+};
+
+/*
+ * Byte-stream transport driven by an epoll_reactor: a termios serial
+ * line, a pty, or any other stream descriptor passed to attach() (e.g.
+ * a Unix-domain socket, see unix_socket.h).
+ *
+ * RX: on EPOLLIN the port reads straight into the free regions of the
+ * RX ring with readv() and calls the rx handler, which typically runs
+ * cmnd_parser::poll() and cmnd_executer::poll(). Nothing runs while the
+ * line is idle.
+ *
+ * TX: arm_tx() (hooked to a sender's TX notifier, see notify_tx())
+ * enables EPOLLOUT; the port then drains the TX ring with writev() over
+ * its contiguous regions, or tx_lanes in SERIAL_TX_CHUNK pieces, and
+ * disarms EPOLLOUT once everything is written.
+ *
+ * The RX ring is filled and the TX ring drained from the reactor thread;
+ * senders on other threads should publish through tx_lanes.
+ */
+class serial_port
+{
+public:
+    serial_port(epoll_reactor& reactor,
+                ring_buffer<uint8_t>& rx,
+                ring_buffer<uint8_t>& tx);
+    ~serial_port();
+
+    serial_port(const serial_port&) = delete;
+    serial_port& operator=(const serial_port&) = delete;
+
+    /* Opens a tty in raw 8N1 mode */
+    bool open(const char* device, uint32_t baudrate);
+
+    /* Uses an already open descriptor (an openpty() end, a socket); the port closes it */
+    bool attach(int fd);
+
+    /* Raw 8N1 at baudrate (0 = keep the current speed) */
+    bool configure(uint32_t baudrate);
+
+    void close();
+
+    /* Stops watching the descriptor and returns it unclosed (e.g. for another reactor) */
+    int release();
+
+    void set_rx_handler(rx_ready_fn fn, void* ctx);
+
+    /* Drain TX from a priority lane set instead of the TX ring (nullptr restores it) */
+    void attach_tx_lanes(tx_lanes* lanes);
+
+    /* Requests EPOLLOUT; callable from any thread */
+    void arm_tx();
+
+    /* tx_notify_fn that calls arm_tx(); ctx is the port (cmnd_sender::set_tx_notifier()) */
+    static void notify_tx(void* ctx);
+
+    /* Reading stops while the RX ring is full; call once it has been drained */
+    void resume_rx();
+
+    /* false after close() or once the peer hung up */
+    bool is_open() const { return port_fd >= 0; }
+
+    int fd() const { return port_fd; }
+    const serial_stats& stats() const { return counters; }
+
+private:
+    static void on_event(void* ctx, uint32_t events);
+
+    void on_readable();
+    void on_writable();
+    ssize_t write_iov(struct iovec* iov, int count);
+    bool write_ring();
+    bool write_lanes();
+    void update_events();
+
+    epoll_reactor&        reactor;
+    ring_buffer<uint8_t>& rx_queue;
+    ring_buffer<uint8_t>& tx_queue;
+    tx_lanes*             lanes;
+
+    int                   port_fd;
+    bool                  is_socket;   ///< Writes use sendmsg() to avoid SIGPIPE
+    rx_ready_fn           rx_handler;
+    void*                 rx_ctx;
+
+    std::atomic<bool>     tx_armed;
+    std::atomic<bool>     rx_paused;
+
+    uint8_t               chunk[SERIAL_TX_CHUNK];  ///< Bytes taken from lanes
+    uint16_t              chunk_len;
+    uint16_t              chunk_pos;
+
+    serial_stats          counters;
+};
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef PATHWIRE_INC_PORT_LINUX_SHARD_RUNTIME_H_
+#define PATHWIRE_INC_PORT_LINUX_SHARD_RUNTIME_H_
+
+#include <stdint.h>
+#include <pthread.h>
+#include <atomic>
+
+#include "core/ring_buffer.h"
+#include "core/cmnd_frame.h"
+#include "port/linux/epoll_reactor.h"
+#include "port/linux/serial_port.h"
+
+class cmnd_parser;
+class cmnd_executer;
+class cmnd_sender;
+
+/* Worker threads (shards) of one runtime */
+#ifndef SHARD_MAX_SHARDS
+#define SHARD_MAX_SHARDS 8
+#endif
+
+/* Links of one runtime; a shard serves up to REACTOR_MAX_SOURCES - 1 of them */
+#ifndef SHARD_MAX_LINKS
+#define SHARD_MAX_LINKS 128
+#endif
+
+/* Bytes per mailbox (power of two); one mailbox per sender/receiver pair */
+#ifndef SHARD_MAILBOX_SIZE
+#define SHARD_MAILBOX_SIZE 8192
+#endif
+
+/* Largest task payload passed through a mailbox */
+#ifndef SHARD_MAX_PAYLOAD
+#define SHARD_MAX_PAYLOAD 1024
+#endif
+
+/* Everything that belongs to one link; owned by the runtime's shards */
+struct shard_link
+{
+    ring_buffer<uint8_t>*    rx;
+    ring_buffer<uint8_t>*    tx;
+    ring_buffer<cmnd_frame>* frames;
+    cmnd_parser*             parser;
+    cmnd_executer*           executer;
+    cmnd_sender*             sender;    ///< Sender on tx (single producer: the owning shard)
+};
+
+/* Runs on the shard that owns the link, with a copy of the posted payload */
+typedef void (*shard_task_fn)(const shard_link& link, const void* payload, uint16_t len);
+
+struct shard_load
+{
+    uint64_t busy_ns;       ///< CPU time of the shard thread
+    uint64_t idle_ns;       ///< Wall time since start() minus busy_ns
+    uint64_t frames;        ///< Frames executed
+    uint64_t tasks;         ///< Mailbox tasks run
+    uint32_t links;         ///< Links assigned to the shard
+    uint32_t mailbox_full;  ///< Posts to this shard refused because a mailbox was full
+    int      cpu;           ///< Core the shard is pinned to (-1 = not pinned)
+};
+
+struct shard_link_load
+{
+    uint64_t busy_ns;       ///< Time spent parsing and executing this link's frames
+    uint64_t frames;        ///< Frames executed
+    uint64_t rx_bytes;      ///< Bytes received
+    int      shard;         ///< Current owner
+};
+
+/*
+ * Thread-per-core host runtime for many links.
+ *
+ * Links are sharded across worker threads pinned to cores. Each shard
+ * runs its own epoll_reactor and owns the serial_port, parser, executer
+ * and sender of its links, so the hot path (read, parse, execute, reply,
+ * write) takes no locks and touches no shared state.
+ *
+ * Work for a link owned by another shard (typically a frame to send on
+ * it) is posted with post() or post_raw(). It travels through a
+ * single-producer/single-consumer mailbox per (sending thread, owning
+ * shard) pair and runs on the owner. One thread outside the shards (the
+ * control thread) may also add, move and post.
+ *
+ * load() and link_load() report cumulative busy/idle time and frame
+ * counts; compare two snapshots and move_link() busy links from an
+ * overloaded shard to an idle one.
+ *
+ * TX is armed by the shard after every loop iteration for links with
+ * queued bytes, so no TX notifier is needed.
+ *
+ * The object is large (mailboxes are embedded); define it static.
+ */
+class shard_runtime
+{
+public:
+    shard_runtime();
+    ~shard_runtime();
+
+    shard_runtime(const shard_runtime&) = delete;
+    shard_runtime& operator=(const shard_runtime&) = delete;
+
+    /* Starts count shards; shard i runs on cpus[i] (nullptr = core i) */
+    bool start(int count, const int* cpus = nullptr);
+
+    /* Stops and joins all shards; their links are closed */
+    void stop();
+
+    /* Control thread, after start(): hands fd (closed by the runtime) and link to a shard; returns the link id or -1 */
+    int add_link(int fd, const shard_link& link, int shard);
+
+    /* Control thread: moves a link to another shard; its rings travel along */
+    bool move_link(int link, int shard);
+
+    /* Runs fn(link, payload) on the owner of link; inline if that is the calling shard */
+    bool post(int link, shard_task_fn fn, const void* payload, uint16_t len);
+
+    /* Queues an encoded frame on link (cmnd_sender::send_raw() on the owner) */
+    bool post_raw(int link, const uint8_t* frame, uint16_t len);
+
+    /* Shard index of the calling thread, -1 outside the shards */
+    static int current_shard();
+
+    int shard_count() const { return shards_started; }
+    int shard_of(int link) const { return slots[link].owner.load(std::memory_order_acquire); }
+
+    shard_load      load(int shard) const;
+    shard_link_load link_load(int link) const;
+
+private:
+    enum class op : uint8_t { TASK, DETACH, PAD };
+
+    /* Record header in a mailbox, followed by the payload */
+    struct message
+    {
+        shard_task_fn fn;
+        uint16_t      link;
+        uint16_t      len;
+        op            kind;
+        uint8_t       arg;     ///< Target shard of DETACH
+    };
+
+    /* Records are 16-byte aligned, so a header always fits before the wrap */
+    static_assert(sizeof(message) <= 16, "message header must fit 16 bytes");
+
+    struct mailbox
+    {
+        alignas(64) std::atomic<uint32_t> head;   ///< Consumer position
+        alignas(64) std::atomic<uint32_t> tail;   ///< Producer position
+        alignas(64) uint8_t               data[SHARD_MAILBOX_SIZE];
+    };
+
+    struct link_slot
+    {
+        shard_link            link;
+        int                   fd;           ///< Held while no shard has the port open
+        std::atomic<int>      owner;        ///< -1 = unused
+        std::atomic<bool>     adopt;        ///< Owner must (re)open the port
+        serial_port*          port;         ///< Constructed in port_mem by the owner
+        alignas(serial_port) unsigned char port_mem[sizeof(serial_port)];
+        shard_runtime*        runtime;
+        uint64_t              rx_base;      ///< Bytes received by ports closed on moves
+        int                   assigned;     ///< Last shard chosen by the control thread
+
+        std::atomic<uint64_t> busy_ns;
+        std::atomic<uint64_t> frames;
+        std::atomic<uint64_t> rx_bytes;
+    };
+
+    struct shard
+    {
+        shard_runtime*        runtime;
+        int                   index;
+        std::atomic<int>      cpu;
+        pthread_t             thread;
+        uint64_t              started_ns;
+        epoll_reactor*        reactor;      ///< Lives on the shard's stack
+        int                   wake_fd;
+        std::atomic<bool>     wake_pending;
+        std::atomic<bool>     adopt;        ///< Some link_slot::adopt is set for this shard
+        std::atomic<bool>     running;
+
+        uint16_t              owned[SHARD_MAX_LINKS];
+        uint16_t              owned_count;
+
+        std::atomic<uint64_t> frames;
+        std::atomic<uint64_t> tasks;
+        std::atomic<uint32_t> links;        ///< Assigned by the control thread
+        std::atomic<uint32_t> mailbox_full;
+    };
+
+    static void* shard_main(void* arg);
+    static void  on_wake(void* ctx, uint32_t events);
+    static void  on_link_rx(void* ctx);
+    static void  send_raw_task(const shard_link& link, const void* payload, uint16_t len);
+
+    bool send(int to, const message& m, const void* payload);
+    void wake(int to);
+    void adopt(shard& s);
+    void drain(shard& s);
+    void dispatch(shard& s, const message& m, const void* payload);
+    void detach(shard& s, int link, int to);
+    void run(shard& s);
+
+    /* Mailbox written by producer (a shard, or SHARD_MAX_SHARDS = control) for shard to */
+    mailbox& box(int producer, int to) { return mailboxes[producer][to]; }
+
+    int        shards_started;
+    std::atomic<int> link_count;
+    shard      shards[SHARD_MAX_SHARDS];
+    link_slot  slots[SHARD_MAX_LINKS];
+    mailbox    mailboxes[SHARD_MAX_SHARDS + 1][SHARD_MAX_SHARDS];
+};
+
+#endif
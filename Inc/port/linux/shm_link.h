@@ -0,0 +1,96 @@
+#ifndef PATHWIRE_INC_PORT_LINUX_SHM_LINK_H_
+#define PATHWIRE_INC_PORT_LINUX_SHM_LINK_H_
+
+#include <stdint.h>
+#include <atomic>
+
+#include "core/ring_buffer.h"
+
+/* Default size of each direction's shared ring (power of two) */
+#ifndef SHM_LINK_RING_SIZE
+#define SHM_LINK_RING_SIZE (1U << 20)
+#endif
+
+struct shm_link_stats
+{
+    uint64_t rx_bytes;   ///< Bytes moved from the shared ring into the RX ring
+    uint64_t tx_bytes;   ///< Bytes moved from the TX ring into the shared ring
+    uint32_t rx_stalls;  ///< pump() calls that left data because the RX ring was full
+    uint32_t tx_stalls;  ///< pump() calls that left data because the peer fell behind
+};
+
+/*
+ * Shared-memory transport between two processes on one host.
+ *
+ * A POSIX shared memory object holds one single-producer/single-consumer
+ * byte ring per direction. pump() moves bytes between those rings and the
+ * process-local RX/TX ring buffers, so each side runs the usual
+ * cmnd_parser/cmnd_executer/cmnd_sender stack on top of it:
+ *
+ *   sender -> tx ring -> pump() -> shared ring -> pump() -> rx ring -> parser
+ *
+ * There is no wake-up; both sides call pump() from their main loop, the
+ * way a device polls its UART. create() and open() pick opposite
+ * directions, so exactly one process must create the object.
+ */
+class shm_link
+{
+public:
+    shm_link(ring_buffer<uint8_t>& rx, ring_buffer<uint8_t>& tx);
+    ~shm_link();
+
+    shm_link(const shm_link&) = delete;
+    shm_link& operator=(const shm_link&) = delete;
+
+    /* Creates (or replaces) the object name; ring_size is a power of two */
+    bool create(const char* name, uint32_t ring_size = SHM_LINK_RING_SIZE);
+
+    /* Maps an object made by create() in another process */
+    bool open(const char* name);
+
+    /* Unmaps; the creating side also removes the object */
+    void close();
+
+    bool is_open() const { return region != nullptr; }
+
+    /* Moves pending bytes in both directions; returns the number moved */
+    uint32_t pump();
+
+    const shm_link_stats& stats() const { return counters; }
+
+private:
+    struct ring_ctl
+    {
+        alignas(64) std::atomic<uint32_t> head;  ///< Producer position (free-running)
+        alignas(64) std::atomic<uint32_t> tail;  ///< Consumer position (free-running)
+    };
+
+    struct header
+    {
+        std::atomic<uint32_t> magic;      ///< Set last by create()
+        uint32_t              ring_size;
+        ring_ctl              ring[2];    ///< [0]: creator -> opener, [1]: opener -> creator
+    };
+
+    bool map(int fd, size_t size);
+    uint32_t send_pending();
+    uint32_t receive_pending();
+
+    ring_buffer<uint8_t>& rx_queue;
+    ring_buffer<uint8_t>& tx_queue;
+
+    header*   region;
+    size_t    region_size;
+    ring_ctl* out;
+    ring_ctl* in;
+    uint8_t*  out_data;
+    uint8_t*  in_data;
+    uint32_t  mask;
+
+    bool      owner;
+    char      shm_name[64];
+
+    shm_link_stats counters;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef PATHWIRE_INC_PORT_LINUX_UNIX_SOCKET_H_
+#define PATHWIRE_INC_PORT_LINUX_UNIX_SOCKET_H_
+
+/*
+ * Unix-domain stream sockets for links between processes on one host,
+ * e.g. simulated firmware and ground software. The descriptors are
+ * non-blocking and are driven like a serial line:
+ *
+ *   serial_port link(reactor, rx_buffer, tx_buffer);
+ *   link.attach(unix_connect("/tmp/pathwire.sock"));
+ *
+ * All functions return a descriptor, or -1 on failure.
+ */
+
+/* Binds and listens on path, replacing a stale socket file */
+int unix_listen(const char* path);
+
+/* Accepts one pending connection (-1 if none is pending) */
+int unix_accept(int listen_fd);
+
+int unix_connect(const char* path);
+
+#endif
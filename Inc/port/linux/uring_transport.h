@@ -0,0 +1,150 @@
+#ifndef PATHWIRE_INC_PORT_LINUX_URING_TRANSPORT_H_
+#define PATHWIRE_INC_PORT_LINUX_URING_TRANSPORT_H_
+
+#include <stdint.h>
+#include <atomic>
+
+#include "core/ring_buffer.h"
+
+/* Maximum number of links served by one transport */
+#ifndef URING_MAX_LINKS
+#define URING_MAX_LINKS 64
+#endif
+
+/* Submission queue entries (one read and one write per link, plus wake-up) */
+#ifndef URING_QUEUE_DEPTH
+#define URING_QUEUE_DEPTH 256
+#endif
+
+/* Called after new bytes were placed in the RX ring of a link */
+typedef void (*link_rx_fn)(void* ctx, int link);
+
+struct uring_link_stats
+{
+    uint64_t rx_bytes;   ///< Bytes read into the RX ring
+    uint64_t tx_bytes;   ///< Bytes written from the TX ring
+    uint32_t reads;      ///< Completed reads
+    uint32_t writes;     ///< Completed writes
+    uint32_t rx_stalls;  ///< Times reading stopped because the RX ring was full
+    uint32_t hangups;    ///< Times the link was closed because the peer went away
+};
+
+/*
+ * io_uring backend for many serial/pty/socket links on one thread.
+ *
+ * The RX and TX ring storage of every link is registered as fixed
+ * buffers, so the kernel reads straight into the parser's RX ring and
+ * writes straight from the sender's TX ring (READ_FIXED / WRITE_FIXED).
+ * Each link keeps one read outstanding; re-posted reads and new writes
+ * are queued during a loop iteration and submitted together with the
+ * wait for the next completions, i.e. one io_uring_enter() per
+ * iteration for all links.
+ *
+ * Usage: add_link() for every descriptor, start(), then run()/run_once().
+ * The rx handler typically runs cmnd_parser::poll() and
+ * cmnd_executer::poll() for the link. The TX rings are plain
+ * ring_buffers, so every sender of a link must run on the transport
+ * thread (in the handlers or between run_once() calls); its frames are
+ * picked up at the next iteration. A link whose RX ring is full is not
+ * read; its handler is called every iteration, without blocking, until
+ * it has made room.
+ */
+class uring_transport
+{
+public:
+    uring_transport();
+    ~uring_transport();
+
+    uring_transport(const uring_transport&) = delete;
+    uring_transport& operator=(const uring_transport&) = delete;
+
+    /* false if the kernel refused io_uring */
+    bool valid() const { return ring_fd >= 0; }
+
+    /* Takes ownership of fd; returns the link index or -1. Before start() only. */
+    int add_link(int fd,
+                 ring_buffer<uint8_t>& rx,
+                 ring_buffer<uint8_t>& tx,
+                 link_rx_fn handler,
+                 void* ctx);
+
+    /* Registers the ring storage and posts the first reads */
+    bool start();
+
+    /* Wakes a blocked run_once(); callable from any thread, but queueing TX data is not */
+    void arm_tx();
+
+    /* tx_notify_fn that calls arm_tx(); ctx is the transport */
+    static void notify_tx(void* ctx);
+
+    /* Waits up to timeout_ms (-1 = forever); returns completions handled or -1 */
+    int run_once(int timeout_ms);
+
+    /* Dispatches completions until stop() */
+    void run();
+    void stop();
+
+    bool is_open(int link) const { return links[link].fd >= 0; }
+    const uring_link_stats& stats(int link) const { return links[link].counters; }
+
+    /* io_uring_enter() calls so far */
+    uint64_t enters() const { return enter_count; }
+
+private:
+    struct link_state
+    {
+        int                   fd;          ///< -1 = closed or unused
+        ring_buffer<uint8_t>* rx;
+        ring_buffer<uint8_t>* tx;          ///< Filled on the transport thread only
+        link_rx_fn            handler;
+        void*                 ctx;
+        bool                  reading;     ///< Read in flight
+        bool                  writing;     ///< Write in flight
+        bool                  received;    ///< Bytes arrived in this iteration
+        bool                  stalled;     ///< No read posted, the RX ring was full
+        uring_link_stats      counters;
+    };
+
+    struct io_uring_sqe* get_sqe();
+    int  enter(uint32_t wait_nr, int timeout_ms);
+    void post_read(int i);
+    void post_write(int i);
+    void post_wake();
+    void hang_up(int i);
+    void complete(uint64_t data, int32_t res);
+
+    int        ring_fd;
+    int        wake_fd;
+
+    // Submission queue
+    uint32_t*  sq_head;
+    uint32_t*  sq_tail;
+    uint32_t*  sq_mask;
+    uint32_t*  sq_array;
+    struct io_uring_sqe* sqes;
+    uint32_t   sq_entries;
+    uint32_t   sq_local;      ///< Next SQE slot
+    uint32_t   sq_pending;    ///< Published entries not yet submitted
+
+    // Completion queue
+    uint32_t*  cq_head;
+    uint32_t*  cq_tail;
+    uint32_t*  cq_mask;
+    struct io_uring_cqe* cqes;
+
+    void*      sq_ring;
+    size_t     sq_ring_size;
+    size_t     sqes_size;
+
+    std::atomic<bool> running;
+    std::atomic<bool> wake_posted;  ///< arm_tx() already signalled wake_fd
+    uint64_t   wake_value;          ///< Target of the wake-up read
+    bool       started;
+    bool       rx_stalled;          ///< Some link is stalled: do not block in enter()
+    uint64_t   enter_count;
+
+    int        link_count;
+    link_state links[URING_MAX_LINKS];
+};
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef PATHWIRE_INC_PORT_LINUX_WORKER_POOL_H_
+#define PATHWIRE_INC_PORT_LINUX_WORKER_POOL_H_
+
+#include <stdint.h>
+#include <pthread.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "core/cmnd_executer.h"
+
+class fragment_reassembler;
+
+/* Worker threads of one pool */
+#ifndef WORKER_MAX_THREADS
+#define WORKER_MAX_THREADS 16
+#endif
+
+/* Pooled job buffers; the decode loop waits when all are in use */
+#ifndef WORKER_MAX_JOBS
+#define WORKER_MAX_JOBS 256
+#endif
+
+/* Payload bytes per job (decoded values, strings or bytes plus their descriptor) */
+#ifndef WORKER_JOB_SIZE
+#define WORKER_JOB_SIZE 512
+#endif
+
+/* Serial queues; calls with the same key % WORKER_MAX_QUEUES run in order */
+#ifndef WORKER_MAX_QUEUES
+#define WORKER_MAX_QUEUES 64
+#endif
+
+/* Jobs a worker runs from one serial queue before it moves on */
+#ifndef WORKER_BATCH
+#define WORKER_BATCH 16
+#endif
+
+/* Ordering key of a handler call; calls with equal keys run one after another */
+typedef uint32_t (*worker_key_fn)(const path_entry& entry, data_type type, const void* data, uint16_t count);
+
+struct worker_stats
+{
+    uint64_t queued;        ///< Handler calls handed to the pool
+    uint64_t executed;      ///< Handler calls completed by workers
+    uint64_t stolen;        ///< Serial queues taken from another worker's run queue
+    uint64_t waits;         ///< Times the decode loop waited for a free job buffer
+    uint64_t oversize;      ///< Calls run inline because the payload exceeds WORKER_JOB_SIZE
+};
+
+/*
+ * Work-stealing thread pool for slow host-side handlers.
+ *
+ * attach() makes an executer (and a reassembler) pass every handler
+ * call to the pool instead of running it inline, so poll() returns as
+ * soon as the frame is decoded. The decoded arguments are packed into
+ * a pooled job buffer and the handler later reads them there in place.
+ *
+ * Calls are ordered by key (default: the path table entry). Each key
+ * maps to a serial queue; a queue with pending calls sits in the run
+ * queue of one worker at a time, so calls of one path never overlap
+ * and run in arrival order, while different paths run in parallel.
+ * Idle workers steal queued serial queues from busy ones.
+ *
+ * Handler calls are dispatched from a single thread (the one calling
+ * executer.poll()). Handlers run on worker threads: they may block, and
+ * must reply through a sender that is safe to use from several threads
+ * (one cmnd_sender per worker on a shared mp_ring_buffer).
+ *
+ * A call whose payload does not fit WORKER_JOB_SIZE runs inline on the
+ * dispatching thread instead (counted in oversize). It keeps the order
+ * of its key: the dispatching thread first waits until the calls
+ * queued before it with the same key have run.
+ *
+ * Handlers on workers must not call executer.current_request(): by the
+ * time they run, the executer is on another frame. Requests that need
+ * their ID belong in the executer's request table, whose handlers
+ * always run inline.
+ *
+ * The object is large (job buffers are embedded); define it static.
+ */
+class worker_pool
+{
+public:
+    worker_pool();
+    ~worker_pool();
+
+    worker_pool(const worker_pool&) = delete;
+    worker_pool& operator=(const worker_pool&) = delete;
+
+    /* Starts count workers; until then (and after stop()) handlers run inline */
+    bool start(int count);
+
+    /* Runs all queued calls, then joins the workers */
+    void stop();
+
+    /* Routes the handler calls of executer (or reassembler) through the pool */
+    void attach(cmnd_executer& executer);
+    void attach(fragment_reassembler& reassembler);
+
+    /* Orders calls by fn() instead of by path (nullptr = by path) */
+    void set_key(worker_key_fn fn) { key_fn = fn; }
+
+    /* Free job buffers; poll the executer while this is nonzero to never wait */
+    uint32_t available() const { return free_jobs.load(std::memory_order_relaxed); }
+
+    /* Calls queued or running */
+    uint32_t in_flight() const { return WORKER_MAX_JOBS - available(); }
+
+    worker_stats stats() const;
+
+    /* handler_dispatch of the pool; ctx is the pool */
+    static void dispatch(void* ctx, const path_entry& entry, data_type type, const void* data, uint16_t count);
+
+private:
+    /* Pooled handler call: descriptor plus a copy of the decoded arguments */
+    struct job
+    {
+        job*              next;
+        const path_entry* entry;
+        const void*       data;         ///< Points into payload (or nullptr)
+        uint16_t          count;
+        data_type         type;
+        alignas(16) unsigned char payload[WORKER_JOB_SIZE];
+    };
+
+    /* Calls of one key in arrival order */
+    struct serial_queue
+    {
+        std::mutex        lock;
+        job*              head;
+        job*              tail;
+        bool              scheduled;    ///< In a run queue or being run
+    };
+
+    /* Serial queues ready to run; the owner takes the oldest, thieves the newest */
+    struct worker
+    {
+        worker_pool*      pool;
+        int               index;
+        pthread_t         thread;
+
+        alignas(64) std::mutex lock;
+        uint16_t          ready[WORKER_MAX_QUEUES];
+        uint16_t          first;
+        uint16_t          ready_count;
+    };
+
+    static void* worker_main(void* arg);
+
+    bool pack(job& j, data_type type, const void* data, uint16_t count);
+    job* take_job();
+    void free_job(job* j);
+    void schedule(worker& w, uint16_t queue);
+    int  next_queue(worker& w);
+    void run_queue(worker& w, uint16_t queue);
+    void run(worker& w);
+
+    std::atomic<int>       workers_started;
+    uint32_t               next_worker;      ///< Round robin for newly ready queues
+    worker_key_fn          key_fn;
+
+    job*                   spare;            ///< Free jobs owned by the dispatching thread
+    alignas(64) std::atomic<job*> returned;  ///< Free jobs pushed back by workers
+    std::atomic<uint32_t>  free_jobs;
+
+    std::atomic<int>       ready_total;      ///< Serial queues in all run queues
+    std::atomic<int>       sleepers;
+    std::atomic<bool>      running;
+    std::mutex             idle_lock;
+    std::condition_variable idle;
+
+    std::atomic<uint64_t>  queued;
+    std::atomic<uint64_t>  executed;
+    std::atomic<uint64_t>  stolen;
+    std::atomic<uint64_t>  waits;
+    std::atomic<uint64_t>  oversize;
+
+    worker                 workers[WORKER_MAX_THREADS];
+    serial_queue           queues[WORKER_MAX_QUEUES];
+    job                    jobs[WORKER_MAX_JOBS];
+};
+
+#endif
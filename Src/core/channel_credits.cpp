@@ -0,0 +1,109 @@
+#include "core/channel_credits.h"
+#include "core/cmnd_sender.h"
+
+
+channel_credits::channel_credits(cmnd_sender& reply)
+    : reply(reply),
+      channels(),
+      age(0)
+{
+}
+
+bool channel_credits::open(uint8_t ch, uint16_t window)
+{
+    if (ch == 0 || ch >= CHANNEL_MAX || window == 0)
+        return false;
+
+    channels[ch].rx_window = window;
+    advertise(false);
+    return true;
+}
+
+uint32_t channel_credits::credit(uint8_t ch) const
+{
+    if (ch == 0)
+        return 0xFFFFFFFFUL;
+
+    if (ch >= CHANNEL_MAX)
+        return 0;
+
+    // Limits wrap around; a limit behind the sent count means no credit
+    int32_t left = (int32_t)(channels[ch].tx_limit - channels[ch].tx_sent);
+    return left > 0 ? (uint32_t)left : 0;
+}
+
+uint32_t channel_credits::blocked(uint8_t ch) const
+{
+    return ch < CHANNEL_MAX ? channels[ch].tx_blocked : 0;
+}
+
+bool channel_credits::reserve(uint8_t ch, uint16_t len)
+{
+    if (credit(ch) >= len)
+        return true;
+
+    if (ch < CHANNEL_MAX)
+        channels[ch].tx_blocked++;
+    return false;
+}
+
+void channel_credits::commit(uint8_t ch, uint16_t len)
+{
+    if (ch != 0 && ch < CHANNEL_MAX)
+        channels[ch].tx_sent += len;
+}
+
+void channel_credits::grant(uint8_t ch, uint32_t limit)
+{
+    if (ch == 0 || ch >= CHANNEL_MAX)
+        return;
+
+    // Ignore stale advertisements that arrive out of order
+    if ((int32_t)(limit - channels[ch].tx_limit) > 0)
+        channels[ch].tx_limit = limit;
+}
+
+void channel_credits::received(uint8_t ch, uint16_t len)
+{
+    if (ch == 0 || ch >= CHANNEL_MAX || channels[ch].rx_window == 0)
+        return;
+
+    channel_state& c = channels[ch];
+    c.rx_consumed += len;
+
+    if (c.rx_consumed + c.rx_window - c.rx_limit >= c.rx_window / 2U)
+        advertise(false);
+}
+
+void channel_credits::tick()
+{
+    if (++age >= CHANNEL_REFRESH_TICKS)
+        advertise(true);
+}
+
+void channel_credits::advertise(bool all)
+{
+    // <channel>,<limit>,...
+    int32_t  v[2 * (CHANNEL_MAX - 1)];
+    uint16_t n = 0;
+
+    for (uint8_t ch = 1; ch < CHANNEL_MAX; ch++)
+    {
+        const channel_state& c = channels[ch];
+        uint32_t limit = c.rx_consumed + c.rx_window;
+
+        if (c.rx_window == 0 || (!all && limit == c.rx_limit))
+            continue;
+
+        v[n++] = ch;
+        v[n++] = (int32_t)limit;
+    }
+
+    if (n == 0 || !reply.send_int("$credit", v, n))
+        return;
+
+    for (uint16_t i = 0; i < n; i += 2)
+        channels[v[i]].rx_limit = (uint32_t)v[i + 1];
+
+    age = 0;
+}
@@ -1,4 +1,15 @@
 #include "core/cmnd_executer.h"
+#include "core/cmnd_sender.h"
+#include "core/reliable_link.h"
+#include "core/fragment_reassembler.h"
+#include "core/channel_credits.h"
+#include "core/flow_control.h"
+#include "core/reply_writer.h"
+
+// Binary payloads are handed to handlers as native arrays without conversion
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "PathWire binary frames require a little-endian target"
+#endif
 
 
 
@@ -8,8 +19,127 @@ cmnd_executer::cmnd_executer(
     uint16_t table_size)
     : frame_queue(frame_buffer),
       path_table(table),
-      path_count(table_size)
+      path_count(table_size),
+      block_buf(nullptr),
+      block_buf_size(0),
+      reply(nullptr),
+      link(nullptr),
+      fragments(nullptr),
+      credits(nullptr),
+      flow(nullptr),
+      stream_entry(nullptr),
+      stream_offset(0),
+      dict_hash(path_table_hash(table, table_size)),
+      dispatch_fn(nullptr),
+      dispatch_ctx(nullptr),
+      response_fn(nullptr),
+      response_ctx(nullptr),
+      current(nullptr),
+      request_table(nullptr),
+      request_count(0),
+      serving(nullptr)
+{
+}
+
+void cmnd_executer::set_block_buffer(float* buffer, uint16_t size)
+{
+    block_buf      = buffer;
+    block_buf_size = size;
+}
+
+void cmnd_executer::set_reply_sender(cmnd_sender* sender)
+{
+    reply = sender;
+}
+
+void cmnd_executer::set_reliable_link(reliable_link* arq)
+{
+    link = arq;
+}
+
+void cmnd_executer::set_reassembler(fragment_reassembler* reassembler)
+{
+    fragments = reassembler;
+}
+
+void cmnd_executer::set_channel_credits(channel_credits* state)
 {
+    credits = state;
+}
+
+void cmnd_executer::set_flow_control(flow_control* state)
+{
+    flow = state;
+}
+
+void cmnd_executer::set_handler_dispatch(handler_dispatch fn, void* ctx)
+{
+    dispatch_fn  = fn;
+    dispatch_ctx = ctx;
+}
+
+void cmnd_executer::set_response_handler(response_handler fn, void* ctx)
+{
+    response_fn  = fn;
+    response_ctx = ctx;
+}
+
+void cmnd_executer::set_request_table(const request_entry* table, uint16_t table_size)
+{
+    request_table = table;
+    request_count = table ? table_size : 0;
+}
+
+bool cmnd_executer::current_request(uint16_t& id) const
+{
+    if (current == nullptr || !(current->tags & FRAME_TAG_REQUEST))
+        return false;
+
+    id = current->request;
+    return true;
+}
+
+void cmnd_executer::invoke(const path_entry& entry, data_type type, const void* data, uint16_t count)
+{
+    if (serving)
+    {
+        // The reply is built in the sender's staged frame; one left open is sent here
+        reply_writer writer(reply, current->request);
+
+        serving->handler(type, data, count, writer);
+
+        if (writer.is_open())
+            writer.end();
+        return;
+    }
+
+    // Only replies reach the decoders with a reply tag while response_fn is set
+    if (response_fn && current && (current->tags & FRAME_TAG_REPLY))
+        response_fn(response_ctx, current->request, type, data, count);
+    else if (dispatch_fn)
+        dispatch_fn(dispatch_ctx, entry, type, data, count);
+    else
+        entry.handler(type, data, count);
+}
+
+
+uint32_t path_table_hash(const path_entry* table, uint16_t table_size)
+{
+    uint32_t h = 2166136261UL;
+
+    for (uint16_t i = 0; i < table_size; i++)
+    {
+        const char* p = table[i].path;
+
+        do
+        {
+            h = (h ^ (uint8_t)*p) * 16777619UL;
+        } while (*p++);
+
+        h = (h ^ (uint8_t)table[i].expected_type) * 16777619UL;
+    }
+
+    return h;
 }
 
 
@@ -91,90 +221,539 @@ static uint16_t parse_string_csv(char* data, char** out)
 
     return count;
 }
-void cmnd_executer::poll()
+static const char* next_csv(const char* data)
 {
-    cmnd_frame frame;
+    while (*data && *data != ',')
+        data++;
+
+    return (*data == ',') ? data + 1 : data;
+}
+void cmnd_executer::dispatch_block(const path_entry& entry, const cmnd_frame& frame)
+{
+    if (entry.expected_type != data_type::BLOCK || block_buf == nullptr ||
+        frame.data == nullptr)
+        return;
+
+    // <base_time>,<period>,<samples>,<values...>
+    const char* p = frame.data;
+    sample_block block;
+
+    block.base_time = strtoul(p, nullptr, 10);
+    p = next_csv(p);
+    block.period    = strtoul(p, nullptr, 10);
+    p = next_csv(p);
+    block.samples   = (uint16_t)strtoul(p, nullptr, 10);
+    p = next_csv(p);
+
+    uint16_t count = 0;
+
+    while (*p)
+    {
+        if (count >= block_buf_size)
+            return; // does not fit → drop block
+
+        block_buf[count++] = strtof(p, nullptr);
+        p = next_csv(p);
+    }
 
-    if (!frame_queue.pop(frame))
+    if (block.samples == 0 || count % block.samples != 0)
         return;
 
+    block.channels = count / block.samples;
+    block.values   = block_buf;
+
+    invoke(entry, data_type::BLOCK, &block, 1);
+}
+const path_entry* cmnd_executer::entry_by_id(uint16_t id) const
+{
+    return id < path_count ? &path_table[id] : nullptr;
+}
+const path_entry* cmnd_executer::find_entry(const char* path) const
+{
+    if (*path == '#')
+    {
+        // #<id>
+        uint32_t id = 0;
+
+        for (const char* p = path + 1; *p; p++)
+        {
+            if (*p < '0' || *p > '9' || id > PATH_ID_NONE)
+                return nullptr;
+
+            id = id * 10 + (*p - '0');
+        }
+
+        return (path[1] && id < PATH_ID_NONE) ? entry_by_id((uint16_t)id) : nullptr;
+    }
+
     for (uint16_t i = 0; i < path_count; i++)
     {
-        if (strcmp(frame.path, path_table[i].path) != 0)
-            continue;
+        if (strcmp(path, path_table[i].path) == 0)
+            return &path_table[i];
+    }
+
+    return nullptr;
+}
+void cmnd_executer::dispatch(const path_entry& entry, const char* data, uint16_t data_len)
+{
+    // 1.If no data
+    if (data == nullptr || data_len == 0)
+    {
+        invoke(
+            entry,
+            data_type::NONE,
+            nullptr,
+            0
+        );
+        return;
+    }
+
+    // 2.Dedect the data type.
+    data_type type = detect_type(data);
 
-        // 1.If no data
-        if (frame.data == nullptr || frame.data_len == 0)
+    if (type != entry.expected_type)
+    {
+        // mismatch → drop command
+        return;
+    }
+
+    // 3.CSV parse + dispatch
+    switch (type)
+    {
+		case data_type::INT:
+		{
+			int32_t values[MAX_CSV_ITEMS];
+			uint16_t count = parse_int_csv(data, values);
+
+			invoke(
+				entry,
+				data_type::INT,
+				values,
+				count
+			);
+			break;
+		}
+
+		case data_type::FLOAT:
+		{
+			float values[MAX_CSV_ITEMS];
+			uint16_t count = parse_float_csv(data, values);
+
+			invoke(
+				entry,
+				data_type::FLOAT,
+				values,
+				count
+			);
+			break;
+		}
+
+		case data_type::STRING:
+		{
+			char* values[MAX_CSV_ITEMS];
+			uint16_t count = parse_string_csv(
+				(char*)data,
+				values
+			);
+
+			invoke(
+				entry,
+				data_type::STRING,
+				values,
+				count
+			);
+			break;
+		}
+
+		default:
+			break;
+    }
+}
+void cmnd_executer::dispatch_batch(const cmnd_frame& frame)
+{
+    // path0 '\0' data0 '\0' path1 '\0' data1 '\0' ...
+    const char* p = frame.path;
+
+    for (uint16_t k = 0; k < frame.entries; k++)
+    {
+        const char* path = p;
+        p += strlen(p) + 1;
+
+        const char* data = p;
+        uint16_t    len  = (uint16_t)strlen(data);
+        p += len + 1;
+
+        const path_entry* entry = find_entry(path);
+
+        if (entry)
+            dispatch(*entry, data, len);
+    }
+}
+void cmnd_executer::dispatch_binary(const path_entry& entry, const cmnd_frame& frame)
+{
+    const char* data = frame.data;
+    uint16_t    len  = frame.data_len;
+
+    if (frame.kind == frame_kind::BLOCK)
+    {
+        // <base_time:u32><period:u32><samples:u16><channels:u16><float[]>
+        if (entry.expected_type != data_type::BLOCK || len < 12)
+            return;
+
+        sample_block block;
+        memcpy(&block.base_time, data + 0, 4);
+        memcpy(&block.period,    data + 4, 4);
+        memcpy(&block.samples,   data + 8, 2);
+        memcpy(&block.channels,  data + 10, 2);
+
+        if ((uint32_t)(len - 12) != (uint32_t)block.samples * block.channels * 4U)
+            return;
+
+        block.values = reinterpret_cast<const float*>(data + 12);
+        invoke(entry, data_type::BLOCK, &block, 1);
+        return;
+    }
+
+    if (frame.type == data_type::NONE || len == 0)
+    {
+        invoke(entry, data_type::NONE, nullptr, 0);
+        return;
+    }
+
+    if (frame.type != entry.expected_type)
+        return;
+
+    switch (frame.type)
+    {
+		case data_type::INT:
+		case data_type::FLOAT:
+		{
+			if (len % 4)
+				return;
+
+			// Payload is 4-byte aligned by the parser: pass it through
+			invoke(entry, frame.type, data, len / 4);
+			break;
+		}
+
+		case data_type::STRING:
+		{
+			char*       values[MAX_CSV_ITEMS];
+			uint16_t    count = 0;
+			const char* end   = data + len;
+
+			while (data < end && count < MAX_CSV_ITEMS)
+			{
+				const char* z = (const char*)memchr(data, '\0', end - data);
+				if (z == nullptr)
+					break;
+
+				values[count++] = (char*)data;
+				data = z + 1;
+			}
+
+			invoke(entry, data_type::STRING, values, count);
+			break;
+		}
+
+		default:
+			break;
+    }
+}
+
+static int8_t hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+void cmnd_executer::dispatch_fragment(const path_entry& entry, const cmnd_frame& frame)
+{
+    if (fragments == nullptr)
+        return;
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(frame.data);
+    uint16_t       len   = frame.data_len;
+
+    if (frame.wire == wire_mode::TEXT)
+    {
+        // Hex digits are decoded in place; the work buffer slice
+        // belongs to this frame until poll() returns.
+        if (len % 2)
+            return;
+
+        uint8_t* out = reinterpret_cast<uint8_t*>(const_cast<char*>(frame.data));
+
+        for (uint16_t i = 0; i < len / 2; i++)
+        {
+            int8_t hi = hex_value(frame.data[2 * i]);
+            int8_t lo = hex_value(frame.data[2 * i + 1]);
+
+            if (hi < 0 || lo < 0)
+                return;
+
+            out[i] = (uint8_t)((hi << 4) | lo);
+        }
+
+        len /= 2;
+    }
+
+    fragments->accept(entry, frame.xfer, frame.offset, frame.total, bytes, len);
+}
+
+void cmnd_executer::dispatch_stream(const cmnd_frame& frame)
+{
+    if (frame.stream == stream_phase::BEGIN)
+    {
+        // The previous stream lost its END piece
+        if (stream_entry)
+        {
+            stream_chunk abort { stream_phase::ABORT, stream_offset, nullptr, 0 };
+            invoke(*stream_entry, data_type::STREAM, &abort, 1);
+        }
+
+        stream_entry  = find_entry(frame.path);
+        stream_offset = 0;
+
+        if (stream_entry && stream_entry->expected_type != data_type::STREAM)
+            stream_entry = nullptr;
+    }
+
+    if (stream_entry == nullptr)
+        return;
+
+    stream_chunk chunk {
+        frame.stream,
+        stream_offset,
+        reinterpret_cast<const uint8_t*>(frame.data),
+        frame.data_len
+    };
+
+    const path_entry* entry = stream_entry;
+
+    stream_offset += frame.data_len;
+
+    if (frame.stream == stream_phase::END || frame.stream == stream_phase::ABORT)
+        stream_entry = nullptr;
+
+    invoke(*entry, data_type::STREAM, &chunk, 1);
+}
+
+void cmnd_executer::dispatch_response(const cmnd_frame& frame)
+{
+    // Replies have no table entry: the payload itself gives the type
+    data_type type = frame.type;
+
+    if (frame.wire == wire_mode::TEXT)
+        type = (frame.data && frame.data_len) ? detect_type(frame.data) : data_type::NONE;
+
+    const path_entry reply_entry { frame.path, type, nullptr };
+
+    if (frame.wire == wire_mode::BINARY)
+        dispatch_binary(reply_entry, frame);
+    else
+        dispatch(reply_entry, frame.data, frame.data_len);
+}
+
+void cmnd_executer::dispatch_request(const request_entry& entry, const cmnd_frame& frame)
+{
+    const path_entry request_path { entry.path, entry.expected_type, nullptr };
+
+    serving = &entry;
+
+    if (frame.wire == wire_mode::BINARY)
+        dispatch_binary(request_path, frame);
+    else
+        dispatch(request_path, frame.data, frame.data_len);
+
+    serving = nullptr;
+}
+
+const request_entry* cmnd_executer::find_request(const char* path) const
+{
+    for (uint16_t i = 0; i < request_count; i++)
+    {
+        if (strcmp(path, request_table[i].path) == 0)
+            return &request_table[i];
+    }
+
+    return nullptr;
+}
+
+void cmnd_executer::handle_control(const cmnd_frame& frame)
+{
+    if (strcmp(frame.path, "$ack") == 0)
+    {
+        if (link == nullptr)
+            return;
+
+        // <next>,<mask>
+        int32_t v[2];
+
+        if (frame.wire == wire_mode::BINARY)
+        {
+            if (frame.data_len != 8)
+                return;
+            memcpy(v, frame.data, 8);
+        }
+        else if (parse_int_csv(frame.data, v) != 2)
         {
-            path_table[i].handler(
-                data_type::NONE,
-                nullptr,
-                0
-            );
             return;
         }
 
-        // 2.Dedect the data type.
-        data_type type = detect_type(frame.data);
+        link->on_ack((uint16_t)v[0], (uint32_t)v[1]);
+        return;
+    }
+
+    if (strcmp(frame.path, "$xoff") == 0 || strcmp(frame.path, "$xon") == 0)
+    {
+        if (flow)
+            flow->on_peer(frame.path[3] == 'f');
+        return;
+    }
+
+    if (strcmp(frame.path, "$credit") == 0)
+    {
+        if (credits == nullptr)
+            return;
+
+        // <channel>,<limit>,...
+        int32_t  v[MAX_CSV_ITEMS];
+        uint16_t count;
 
-        if (type != path_table[i].expected_type)
+        if (frame.wire == wire_mode::BINARY)
+        {
+            if (frame.data_len > sizeof(v) || frame.data_len % 4)
+                return;
+            memcpy(v, frame.data, frame.data_len);
+            count = frame.data_len / 4;
+        }
+        else
         {
-            // mismatch → drop command
+            count = parse_int_csv(frame.data, v);
+        }
+
+        for (uint16_t i = 0; i + 1 < count; i += 2)
+            credits->grant((uint8_t)v[i], (uint32_t)v[i + 1]);
+        return;
+    }
+
+    if (reply == nullptr)
+        return;
+
+    if (strcmp(frame.path, "$dict") == 0)
+    {
+        if (frame.data_len == 0)
+        {
+            reply->announce_dictionary(dict_hash);
             return;
         }
 
-        // 3.CSV parse + dispatch
-        switch (type)
+        uint32_t peer_hash;
+
+        if (frame.wire == wire_mode::BINARY)
         {
-			case data_type::INT:
-			{
-				int32_t values[MAX_CSV_ITEMS];
-				uint16_t count = parse_int_csv(frame.data, values);
-
-				path_table[i].handler(
-					data_type::INT,
-					values,
-					count
-				);
-				break;
-			}
+            if (frame.data_len != 4)
+                return;
+            memcpy(&peer_hash, frame.data, 4);
+        }
+        else
+        {
+            peer_hash = strtoul(frame.data, nullptr, 10);
+        }
 
-			case data_type::FLOAT:
-			{
-				float values[MAX_CSV_ITEMS];
-				uint16_t count = parse_float_csv(frame.data, values);
-
-				path_table[i].handler(
-					data_type::FLOAT,
-					values,
-					count
-				);
-				break;
-			}
+        reply->accept_dictionary(peer_hash);
+    }
+}
+void cmnd_executer::execute(const cmnd_frame& frame)
+{
+    if (frame.stream != stream_phase::NONE)
+    {
+        dispatch_stream(frame);
+        return;
+    }
 
-			case data_type::STRING:
-			{
-				char* values[MAX_CSV_ITEMS];
-				uint16_t count = parse_string_csv(
-					(char*)frame.data,
-					values
-				);
-
-				path_table[i].handler(
-					data_type::STRING,
-					values,
-					count
-				);
-				break;
-			}
+    if (frame.kind == frame_kind::BATCH)
+    {
+        dispatch_batch(frame);
+        return;
+    }
+
+    if (response_fn && (frame.tags & FRAME_TAG_REPLY) && frame.kind == frame_kind::COMMAND)
+    {
+        dispatch_response(frame);
+        return;
+    }
+
+    if (request_count && (frame.tags & FRAME_TAG_REQUEST) &&
+        frame.kind == frame_kind::COMMAND && frame.path_id == PATH_ID_NONE)
+    {
+        const request_entry* req = find_request(frame.path);
 
-			default:
-				break;
+        if (req)
+        {
+            dispatch_request(*req, frame);
+            return;
         }
+    }
 
+    if (frame.path_id == PATH_ID_NONE && frame.path[0] == '$')
+    {
+        handle_control(frame);
         return;
     }
+
+    const path_entry* entry = (frame.path_id != PATH_ID_NONE)
+                            ? entry_by_id(frame.path_id)
+                            : find_entry(frame.path);
+
+    if (entry == nullptr)
+        return;
+
+    const uint8_t frag_tags = FRAME_TAG_OFFSET | FRAME_TAG_TOTAL | FRAME_TAG_XFER;
+
+    if ((frame.tags & frag_tags) == frag_tags)
+        dispatch_fragment(*entry, frame);
+    else if (frame.wire == wire_mode::BINARY)
+        dispatch_binary(*entry, frame);
+    else if (frame.kind == frame_kind::BLOCK)
+        dispatch_block(*entry, frame);
+    else
+        dispatch(*entry, frame.data, frame.data_len);
 }
+void cmnd_executer::poll()
+{
+    cmnd_frame* first;
+    cmnd_frame* second;
+    uint16_t    first_len, second_len;
+
+    // The frame is read in place and released only after its handlers
+    // have returned: until then the parser sees a non-empty queue and
+    // does not reuse the work buffer space the frame points into
+    if (frame_queue.readable(first, first_len, second, second_len) == 0)
+        return;
+
+    const cmnd_frame& frame    = *first;
+    const uint8_t     channel  = frame.channel;
+    const uint16_t    wire_len = frame.wire_len;
 
+    current = &frame;
 
+    if (link == nullptr)
+        execute(frame);
+    // Duplicates are acknowledged again but not executed
+    else if (!(frame.tags & FRAME_TAG_SEQ) || link->accept(frame.seq))
+        execute(frame);
 
+    current = nullptr;
+    frame_queue.consume(1);
+
+    if (link)
+        link->flush_ack(frame_queue.empty());
+
+    // The peer charged the frame's encoded size, duplicates included
+    if (credits)
+        credits->received(channel, wire_len);
+}
@@ -1,4 +1,5 @@
 #include "core/cmnd_parser.h"
+#include "core/cmnd_executer.h"
 
 cmnd_parser::cmnd_parser(ring_buffer<uint8_t>& rx_buffer,
                          ring_buffer<cmnd_frame>& frame_buffer,
@@ -9,30 +10,373 @@ cmnd_parser::cmnd_parser(ring_buffer<uint8_t>& rx_buffer,
       workBuffer(work_buffer),
       work_buf_size(work_buffer_size),
       idx(0),
+      frame_start(0),
       path_ptr(nullptr),
       path_len(0),
       data_ptr(nullptr),
       data_len(0),
+      kind(frame_kind::COMMAND),
+      entries(0),
+      mode(wire_mode::TEXT),
+      bin_type(data_type::NONE),
+      bin_path_len(0),
+      bin_path_id(PATH_ID_NONE),
+      bin_head(3),
+      bin_base(0),
+      bin_pos(0),
+      cobs_left(0),
+      cobs_zero(false),
+      crc(crc_mode::NONE),
+      crc_reg(0),
+      crc_value(0),
+      crc_digits(0),
+      crc_error_count(0),
+      tags(0),
+      seq(0),
+      offset(0),
+      total(0),
+      xfer(0),
+      channel(0),
+      request(0),
+      frame_bytes(0),
+      tag_letter(0),
+      tag_value(0),
+      stream_table(nullptr),
+      stream_table_size(0),
+      streaming(false),
+      stream_drain(false),
+      stream_base(0),
+      stream_sent(0),
+      frame_notify(nullptr),
+      frame_ctx(nullptr),
       state(state_t::WAIT_START)
 {
 }
 
 void cmnd_parser::reset()
 {
+    // A streamed frame that ends here was not completed
+    if (streaming)
+    {
+        streaming   = false;
+        stream_sent = idx;
+        push_piece(stream_phase::ABORT);
+    }
+
+    // Queued frames still point into the buffer; only rewind once the
+    // consumer has taken all of them.
+    if (frame_queue.empty())
+        frame_start = 0;
+
     state    = state_t::WAIT_START;
-    idx      = 0;
+    idx      = frame_start;
     path_ptr = nullptr;
     data_ptr = nullptr;
     path_len = 0;
     data_len = 0;
+    kind     = frame_kind::COMMAND;
+    entries  = 0;
+
+    bin_pos   = 0;
+    bin_base  = 0;
+    bin_head  = 3;   // <kind><type><path_len> until the path length is known
+
+    tags      = 0;
+    seq       = 0;
+    offset    = 0;
+    total     = 0;
+    xfer      = 0;
+    channel   = 0;
+    request   = 0;
+    cobs_left = 0;
+    cobs_zero = false;
+
+    // Text frames are checked from their opening '{', which has always
+    // been consumed by the time the frame body is parsed.
+    crc_reg    = (mode == wire_mode::TEXT) ? crc_update(crc, crc_init(crc), '{')
+                                           : crc_init(crc);
+    crc_value  = 0;
+    crc_digits = 0;
+
+    // Likewise the '{' is the first counted byte of a text frame
+    frame_bytes = (mode == wire_mode::TEXT) ? 1 : 0;
+}
+
+void cmnd_parser::set_wire_mode(wire_mode new_mode)
+{
+    mode = new_mode;
+    reset();
+}
+
+void cmnd_parser::set_crc_mode(crc_mode new_crc)
+{
+    crc = new_crc;
+    reset();
+}
+
+void cmnd_parser::set_stream_paths(const path_entry* table, uint16_t table_size)
+{
+    stream_table      = table;
+    stream_table_size = table ? table_size : 0;
+    reset();
+}
+
+void cmnd_parser::set_frame_notifier(frame_notify_fn fn, void* ctx)
+{
+    frame_notify = fn;
+    frame_ctx    = ctx;
+}
+
+bool cmnd_parser::queue_frame(const cmnd_frame& frame)
+{
+    if (!frame_queue.push(frame))
+        return false;
+
+    // Every push is signalled: a consumer that drains the queue
+    // concurrently must never miss the frame that follows
+    if (frame_notify)
+        frame_notify(frame_ctx);
+    return true;
+}
+
+bool cmnd_parser::is_stream_path() const
+{
+    const path_entry* entry = nullptr;
+
+    if (*path_ptr == '#')
+    {
+        // #<id>, see cmnd_executer::find_entry()
+        uint32_t id = 0;
+
+        for (const char* p = path_ptr + 1; *p; p++)
+        {
+            if (*p < '0' || *p > '9' || id >= stream_table_size)
+                return false;
+
+            id = id * 10 + (*p - '0');
+        }
+
+        if (path_ptr[1] && id < stream_table_size)
+            entry = &stream_table[id];
+    }
+    else
+    {
+        for (uint16_t i = 0; i < stream_table_size && entry == nullptr; i++)
+        {
+            if (strcmp(path_ptr, stream_table[i].path) == 0)
+                entry = &stream_table[i];
+        }
+    }
+
+    return entry && entry->expected_type == data_type::STREAM;
+}
+
+bool cmnd_parser::push_piece(stream_phase phase)
+{
+    cmnd_frame frame {
+        path_ptr,
+        path_len,
+        &workBuffer[stream_sent],
+        static_cast<uint16_t>(idx - stream_sent),
+        kind,
+        1,
+        data_type::NONE,
+        wire_mode::TEXT,
+        PATH_ID_NONE,
+        0,
+        0,
+        0,
+        0,
+        0,
+        0,
+        0,
+        phase,
+        0
+    };
+
+    if (!queue_frame(frame))
+        return false;
+
+    stream_sent = idx;
+    return true;
+}
+
+bool cmnd_parser::rewind_stream()
+{
+    if (idx > stream_sent && !push_piece(stream_phase::DATA))
+        return false;
+
+    // The path in front of the payload stays in place for later pieces
+    if (!frame_queue.empty())
+        return false;
+
+    idx         = stream_base;
+    stream_sent = stream_base;
+    return true;
+}
+
+/**
+ * @brief Maps a header tag letter to its frame_tag flag (0 = not a tag)
+ */
+static uint8_t tag_flag(uint8_t letter)
+{
+    switch (letter)
+    {
+    case 's': return FRAME_TAG_SEQ;
+    case 'o': return FRAME_TAG_OFFSET;
+    case 't': return FRAME_TAG_TOTAL;
+    case 'x': return FRAME_TAG_XFER;
+    case 'c': return FRAME_TAG_CHANNEL;
+    case 'q': return FRAME_TAG_REQUEST;
+    case 'r': return FRAME_TAG_REPLY;
+    default:  return 0;
+    }
+}
+
+void cmnd_parser::store_tag()
+{
+    tags |= tag_flag(tag_letter);
+
+    switch (tag_letter)
+    {
+    case 's': seq    = (uint16_t)tag_value; break;
+    case 'o': offset = (uint16_t)tag_value; break;
+    case 't': total  = (uint16_t)tag_value; break;
+    case 'x': xfer   = (uint16_t)tag_value; break;
+    case 'c': channel = (uint8_t)tag_value; break;
+    case 'q': request = (uint16_t)tag_value; break;
+    case 'r': request = (uint16_t)tag_value; break;
+    default:  break;
+    }
+}
+
+void cmnd_parser::emit_frame()
+{
+    if (streaming)
+    {
+        streaming = false;
+
+        if (!push_piece(stream_phase::END))
+        {
+            reset();
+            state = state_t::ERROR;
+            return;
+        }
+
+        // The pieces may end anywhere in the work buffer; the next
+        // frame starts at its beginning once they have been consumed
+        frame_start  = idx;
+        reset();
+        stream_drain = true;
+        return;
+    }
+
+    cmnd_frame frame {
+        path_ptr,
+        path_len,
+        data_ptr,
+        data_len,
+        kind,
+        entries,
+        data_type::NONE,
+        wire_mode::TEXT,
+        PATH_ID_NONE,
+        tags,
+        seq,
+        offset,
+        total,
+        xfer,
+        channel,
+        request,
+        stream_phase::NONE,
+        frame_bytes
+    };
+
+    if (!queue_frame(frame))
+    {
+        reset();
+        state = state_t::ERROR;
+        return;
+    }
+
+    frame_start = idx;
+    reset();
+}
+
+void cmnd_parser::compact()
+{
+    // Multiples of 4 keep binary payloads aligned
+    uint16_t shift = frame_start & ~3U;
+
+    if (shift == 0 || streaming || !frame_queue.empty())
+        return;
+
+    memmove(workBuffer, workBuffer + shift, idx - shift);
+
+    idx         -= shift;
+    frame_start -= shift;
+
+    if (path_ptr) path_ptr -= shift;
+    if (data_ptr) data_ptr -= shift;
+}
+
+bool cmnd_parser::hold_input(uint16_t need)
+{
+    if (frame_queue.space() == 0)
+        return true;
+
+    // Streamed payloads rewind on their own (see rewind_stream())
+    if (streaming || idx + need <= work_buf_size || !(frame_start & ~3U))
+        return false;
+
+    // The frame being parsed moves to the front once the executer
+    // has taken the frames queued before it
+    if (!frame_queue.empty())
+        return true;
+
+    compact();
+    return false;
 }
 
 void cmnd_parser::poll()
 {
+    // A frame split across poll() calls would otherwise never let the
+    // buffer rewind while frames keep arriving
+    compact();
+
+    if (mode == wire_mode::BINARY)
+    {
+        poll_binary();
+        return;
+    }
+
     uint8_t ch;
 
-    while (rx_queue.pop(ch))
+    for (;;)
     {
+        // A streamed payload that filled the work buffer continues at
+        // its start once the executer has consumed the queued pieces;
+        // until then the bytes wait in the RX buffer.
+        if (streaming && idx >= work_buf_size && !rewind_stream())
+            return;
+
+        if (stream_drain)
+        {
+            if (!frame_queue.empty())
+                return;
+
+            stream_drain = false;
+            reset();
+        }
+
+        if (hold_input(1))
+            return;
+
+        if (!rx_queue.pop(ch))
+            break;
+
+        frame_bytes++;
+
         // Overflow guard
     	if (idx >= work_buf_size)
     	{
@@ -41,21 +385,58 @@ void cmnd_parser::poll()
     	    continue;   // <<<<< ÇOK ÖNEMLİ
     	}
 
+        // Fold frame bytes into the trailer CRC while they are copied
+        if (state != state_t::WAIT_START && state != state_t::ERROR &&
+            state != state_t::WAIT_CRC)
+            crc_reg = crc_update(crc, crc_reg, ch);
+
         switch (state)
         {
         case state_t::WAIT_START:
             if (ch == '{')
             {
                 reset();
-                state = state_t::WAIT_P;
+                state = state_t::WAIT_KIND;
             }
             break;
 
-        case state_t::WAIT_P:
-            state = (ch == 'p') ? state_t::WAIT_P_COLON : state_t::ERROR;
+        case state_t::WAIT_KIND:
+            if (ch == 'p' || ch == 'b' || ch == 'm')
+            {
+                kind  = static_cast<frame_kind>(ch);
+                state = state_t::WAIT_KIND_COLON;
+            }
+            else if (tag_flag(ch) && !(tags & tag_flag(ch)))
+            {
+                tag_letter = ch;
+                tag_value  = 0;
+                state      = state_t::READ_TAG;
+            }
+            else
+            {
+                state = state_t::ERROR;
+            }
             break;
 
-        case state_t::WAIT_P_COLON:
+        case state_t::READ_TAG:
+            // <letter><decimal>:
+            if (ch >= '0' && ch <= '9' && tag_value <= 6553U)
+            {
+                tag_value = tag_value * 10U + (ch - '0');
+                state = (tag_value <= 0xFFFFU) ? state_t::READ_TAG : state_t::ERROR;
+            }
+            else if (ch == ':')
+            {
+                store_tag();
+                state = state_t::WAIT_KIND;
+            }
+            else
+            {
+                state = state_t::ERROR;
+            }
+            break;
+
+        case state_t::WAIT_KIND_COLON:
             state = (ch == ':') ? state_t::READ_PATH : state_t::ERROR;
             if (state == state_t::READ_PATH)
                 path_ptr = &workBuffer[idx];
@@ -65,9 +446,19 @@ void cmnd_parser::poll()
             if (ch == ':')
             {
                 workBuffer[idx++] = '\0';
-                path_len = idx - 1;
+                if (entries == 0)
+                    path_len = idx - 1 - (path_ptr - workBuffer);
                 state = state_t::WAIT_D;
             }
+            else if (ch == '}')
+            {
+                state = state_t::ERROR;
+            }
+            else if (ch == '{')
+            {
+                reset();
+                state = state_t::WAIT_KIND;
+            }
             else
             {
                 workBuffer[idx++] = ch;
@@ -81,8 +472,21 @@ void cmnd_parser::poll()
         case state_t::WAIT_D_COLON:
             if (ch == ':')
             {
-                data_ptr = &workBuffer[idx];
+                if (entries == 0)
+                    data_ptr = &workBuffer[idx];
                 state = state_t::READ_DATA;
+
+                if (stream_table && kind == frame_kind::COMMAND && tags == 0 &&
+                    is_stream_path())
+                {
+                    stream_base = idx;
+                    stream_sent = idx;
+
+                    if (push_piece(stream_phase::BEGIN))
+                        streaming = true;
+                    else
+                        state = state_t::ERROR;
+                }
             }
             else
             {
@@ -91,38 +495,77 @@ void cmnd_parser::poll()
             break;
 
         case state_t::READ_DATA:
-            if (ch == '}')
+            if (ch == ';' && kind == frame_kind::BATCH)
             {
+                // Terminate this entry in place and read the next path
                 workBuffer[idx++] = '\0';
-                data_len = idx - (data_ptr - workBuffer) - 1;
-
-                cmnd_frame frame {
-                    path_ptr,
-                    path_len,
-                    data_ptr,
-                    data_len
-                };
-
-                if (!frame_queue.push(frame)){
-                    reset();
-                    state = state_t::ERROR;
-                    continue;
+                if (entries++ == 0)
+                    data_len = idx - (data_ptr - workBuffer) - 1;
+                state = state_t::READ_PATH;
+            }
+            else if (ch == '}')
+            {
+                // Streamed pieces carry their length and may end at the
+                // last byte of the work buffer
+                if (!streaming)
+                    workBuffer[idx++] = '\0';
+                if (entries++ == 0)
+                    data_len = idx - (data_ptr - workBuffer) - 1;
+
+                if (crc == crc_mode::NONE)
+                {
+                    emit_frame();
                 }
+                else
+                {
+                    crc_reg = crc_final(crc, crc_reg);
+                    state   = state_t::WAIT_CRC;
+                }
+            }
+            else
+            {
+                workBuffer[idx++] = ch;
+            }
+            break;
 
+        case state_t::WAIT_CRC:
+        {
+            // <hex digits>, upper case
+            uint8_t nibble;
+
+            if (ch >= '0' && ch <= '9')      nibble = ch - '0';
+            else if (ch >= 'A' && ch <= 'F') nibble = ch - 'A' + 10;
+            else
+            {
+                crc_error_count++;
                 reset();
+                state = (ch == '{') ? state_t::WAIT_KIND : state_t::ERROR;
+                break;
+            }
+
+            crc_value = (crc_value << 4) | nibble;
+
+            if (++crc_digits < 2U * crc_size(crc))
+                break;
+
+            if (crc_value == crc_reg)
+            {
+                emit_frame();
             }
             else
             {
-                workBuffer[idx++] = ch;
+                crc_error_count++;
+                reset();
             }
             break;
+        }
 
         case state_t::ERROR:
-        	idx = 0;
+        	idx = frame_start;
             if (ch == '{')
             {
                 reset();
-                state = state_t::WAIT_P;
+                state = state_t::WAIT_KIND;
             }
             break;
 
@@ -131,4 +574,216 @@ void cmnd_parser::poll()
             break;
         }
     }
+
+    // Hand over what has arrived so far, so the handler can work on it
+    // while the rest of the frame is received
+    if (streaming && state == state_t::READ_DATA && idx > stream_sent)
+        push_piece(stream_phase::DATA);
+}
+
+bool cmnd_parser::accept_binary(uint8_t b)
+{
+    uint16_t pos = bin_pos++;
+
+    // First byte of a packet: rewind like '{' does in text mode
+    if (pos == 0 && frame_queue.empty())
+        frame_start = 0;
+
+    // <tag:1><value:2 LE> in front of the kind byte
+    if (pos < bin_base)
+    {
+        if (pos == bin_base - 2U)
+        {
+            tag_value = b;
+        }
+        else
+        {
+            tag_value |= (uint16_t)(b << 8);
+            store_tag();
+        }
+        return true;
+    }
+
+    switch (pos - bin_base)
+    {
+    case 0:
+        if (tag_flag(b) && !(tags & tag_flag(b)))
+        {
+            tag_letter = b;
+            bin_base   = pos + 3U;
+            bin_head   = bin_base + 3U;
+            return true;
+        }
+
+        kind = static_cast<frame_kind>(b);
+        return kind == frame_kind::COMMAND || kind == frame_kind::BLOCK;
+
+    case 1:
+        bin_type = static_cast<data_type>(b);
+        return b <= static_cast<uint8_t>(data_type::BYTES);
+
+    case 2:
+        bin_path_len = b;
+        bin_path_id  = PATH_ID_NONE;
+        bin_head     = bin_base + 3U + (b ? b : 2U);   // path, or 2-byte path ID
+
+        // Place the path so that the payload after its terminator is
+        // 4-byte aligned; handlers then read values in place. ID packets
+        // only store the (empty) terminator.
+        idx = frame_start;
+        while (reinterpret_cast<uintptr_t>(&workBuffer[idx + bin_path_len + 1]) & 3U)
+            idx++;
+
+        if (idx + bin_path_len + 1 > work_buf_size)
+            return false;
+
+        path_ptr = &workBuffer[idx];
+
+        if (bin_path_len == 0)
+        {
+            workBuffer[idx++] = '\0';
+            data_ptr = &workBuffer[idx];
+        }
+        return true;
+
+    default:
+        if (pos < bin_head)
+        {
+            if (bin_path_len == 0)
+            {
+                // <path_id:2>, little-endian
+                bin_path_id = (pos == bin_base + 3U) ? b : (uint16_t)(bin_path_id | (b << 8));
+                return true;
+            }
+
+            workBuffer[idx++] = b;
+
+            if (pos == bin_head - 1U)
+            {
+                workBuffer[idx++] = '\0';
+                data_ptr = &workBuffer[idx];
+            }
+            return true;
+        }
+
+        if (idx >= work_buf_size)
+            return false;
+
+        workBuffer[idx++] = b;
+        return true;
+    }
+}
+
+void cmnd_parser::finish_binary()
+{
+    uint8_t trailer = crc_size(crc);
+
+    if (bin_pos < bin_head + trailer)
+        return; // truncated header
+
+    if (trailer)
+    {
+        // packet + trailer leaves a constant residue
+        if (crc_reg != crc_residue(crc))
+        {
+            crc_error_count++;
+            return;
+        }
+
+        idx -= trailer;
+    }
+
+    cmnd_frame frame {
+        path_ptr,
+        bin_path_len,
+        data_ptr,
+        static_cast<uint16_t>(idx - (data_ptr - workBuffer)),
+        kind,
+        1,
+        bin_type,
+        wire_mode::BINARY,
+        bin_path_id,
+        tags,
+        seq,
+        offset,
+        total,
+        xfer,
+        channel,
+        request,
+        stream_phase::NONE,
+        frame_bytes
+    };
+
+    if (queue_frame(frame))
+        frame_start = idx;
+}
+
+void cmnd_parser::poll_binary()
+{
+    uint8_t ch;
+
+    for (;;)
+    {
+        // The path length byte places up to 3 alignment bytes, the path
+        // and its terminator; any other byte stores at most one. Inside
+        // a COBS block the next raw byte is the length itself.
+        uint16_t need = 1;
+
+        if (bin_pos == bin_base + 2U)
+        {
+            uint8_t* first;
+            uint8_t* second;
+            uint16_t first_len, second_len;
+
+            if (rx_queue.readable(first, first_len, second, second_len) == 0)
+                break;
+
+            need = (uint16_t)(3U + (cobs_left ? *first : 0U) + 1U);
+        }
+
+        if (hold_input(need) || !rx_queue.pop(ch))
+            break;
+
+        frame_bytes++;
+
+        // 0x00 delimits packets and never occurs inside one
+        if (ch == 0x00)
+        {
+            if (state != state_t::ERROR && bin_pos > 0)
+                finish_binary();
+
+            reset();
+            continue;
+        }
+
+        if (state == state_t::ERROR)
+            continue;
+
+        bool ok = true;
+
+        if (cobs_left == 0)
+        {
+            // COBS code byte: the previous block ended with an implicit zero
+            if (cobs_zero)
+            {
+                crc_reg = crc_update(crc, crc_reg, 0);
+                ok = accept_binary(0);
+            }
+
+            cobs_left = ch - 1;
+            cobs_zero = (ch != 0xFF);
+        }
+        else
+        {
+            cobs_left--;
+            crc_reg = crc_update(crc, crc_reg, ch);
+            ok = accept_binary(ch);
+        }
+
+        if (!ok)
+        {
+            reset();
+            state = state_t::ERROR;  // skip to the next delimiter
+        }
+    }
 }
@@ -1,10 +1,134 @@
 #include "core/cmnd_sender.h"
 #include <cstdio>
+#include <string.h>
 
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "binary wire mode assumes a little-endian target"
+#endif
 
 
+/**
+ * @brief COBS-encodes a packet in place
+ *
+ * buf[0] is a placeholder for the first code byte and the packet
+ * occupies buf[1..len-1]. Each zero is replaced by the distance to the
+ * next one; runs of 254 non-zero bytes need an extra code byte, which
+ * is inserted by shifting the rest of the packet.
+ *
+ * @return Encoded length, or 0 if cap is exceeded
+ */
+static uint16_t cobs_encode_in_place(uint8_t* buf, uint16_t len, uint16_t cap)
+{
+    uint16_t code_pos = 0;
+    uint16_t i        = 1;
+
+    while (i < len)
+    {
+        if (buf[i] == 0)
+        {
+            buf[code_pos] = (uint8_t)(i - code_pos);
+            code_pos = i++;
+        }
+        else if (i - code_pos == 0xFF)
+        {
+            if (len >= cap)
+                return 0;
+
+            memmove(&buf[i + 1], &buf[i], len - i);
+            len++;
+            buf[code_pos] = 0xFF;
+            code_pos = i++;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    buf[code_pos] = (uint8_t)(i - code_pos);
+    return len;
+}
+
+
+bool cmnd_sender::set_wire_mode(wire_mode m)
+{
+    if (m == wire_mode::BINARY && !stage)
+        return false;
+
+    mode = m;
+    return true;
+}
+
+
+bool cmnd_sender::set_channel(channel_credits* state, uint8_t channel)
+{
+    if (channel >= CHANNEL_MAX || (state && channel && !stage))
+        return false;
+
+    credits    = state;
+    channel_id = channel;
+    return true;
+}
+
+void cmnd_sender::set_path_dictionary(const path_entry* table, uint16_t table_size)
+{
+    dict_table = table;
+    dict_size  = table_size;
+    dict_hash  = path_table_hash(table, table_size);
+    ids_active = false;
+}
+
+bool cmnd_sender::request_dictionary()
+{
+    return send_trigger("$dict");
+}
+
+bool cmnd_sender::announce_dictionary(uint32_t hash)
+{
+    if (mode == wire_mode::BINARY)
+    {
+        if (!begin_packet("$dict", frame_kind::COMMAND, data_type::INT)) return false;
+        if (!push_bytes(&hash, 4)) return false;
+        return end_packet();
+    }
+
+    if (!begin_frame("$dict")) return false;
+    if (!push_uint(hash)) return false;
+    return end_frame();
+}
+
+bool cmnd_sender::accept_dictionary(uint32_t peer_hash)
+{
+    ids_active = (dict_table != nullptr) && (peer_hash == dict_hash);
+    return ids_active;
+}
+
+bool cmnd_sender::lookup_id(const char* path, uint16_t& id) const
+{
+    if (!ids_active)
+        return false;
+
+    // Callers usually pass the same string literal as the table
+    for (uint16_t i = 0; i < dict_size; i++)
+    {
+        if (dict_table[i].path == path || strcmp(dict_table[i].path, path) == 0)
+        {
+            id = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool cmnd_sender::send_trigger(const char* path)
 {
+    if (mode == wire_mode::BINARY)
+    {
+        if (!begin_packet(path, frame_kind::COMMAND, data_type::NONE)) return false;
+        return end_packet();
+    }
+
     if (!begin_frame(path)) return false;
     return end_frame();
 }
@@ -15,6 +139,13 @@ bool cmnd_sender::send_int(
     const int32_t* values,
     uint16_t count)
 {
+    if (mode == wire_mode::BINARY)
+    {
+        if (!begin_packet(path, frame_kind::COMMAND, data_type::INT)) return false;
+        if (!push_bytes(values, (uint32_t)count * sizeof(int32_t))) return false;
+        return end_packet();
+    }
+
     if (!begin_frame(path)) return false;
 
     for (uint16_t i = 0; i < count; ++i)
@@ -30,6 +161,13 @@ bool cmnd_sender::send_float(
     const float* values,
     uint16_t count)
 {
+    if (mode == wire_mode::BINARY)
+    {
+        if (!begin_packet(path, frame_kind::COMMAND, data_type::FLOAT)) return false;
+        if (!push_bytes(values, (uint32_t)count * sizeof(float))) return false;
+        return end_packet();
+    }
+
     if (!begin_frame(path)) return false;
 
     for (uint16_t i = 0; i < count; ++i)
@@ -45,6 +183,18 @@ bool cmnd_sender::send_string(
     const char* const* values,
     uint16_t count)
 {
+    if (mode == wire_mode::BINARY)
+    {
+        if (!begin_packet(path, frame_kind::COMMAND, data_type::STRING)) return false;
+
+        // <str0>\0<str1>\0...
+        for (uint16_t i = 0; i < count; ++i)
+        {
+            if (!push_bytes(values[i], strlen(values[i]) + 1)) return false;
+        }
+        return end_packet();
+    }
+
     if (!begin_frame(path)) return false;
 
     for (uint16_t i = 0; i < count; ++i)
@@ -55,13 +205,155 @@ bool cmnd_sender::send_string(
 
     return end_frame();
 }
+bool cmnd_sender::send_block(
+    const char* path,
+    uint32_t base_time,
+    uint32_t period,
+    const float* values,
+    uint16_t samples,
+    uint16_t channels)
+{
+    if (mode == wire_mode::BINARY)
+    {
+        // <base_time:4><period:4><samples:2><channels:2><values>
+        if (!begin_packet(path, frame_kind::BLOCK, data_type::BLOCK)) return false;
+        if (!push_bytes(&base_time, 4)) return false;
+        if (!push_bytes(&period, 4))    return false;
+        if (!push_bytes(&samples, 2))   return false;
+        if (!push_bytes(&channels, 2))  return false;
+        if (!push_bytes(values, (uint32_t)samples * channels * sizeof(float))) return false;
+        return end_packet();
+    }
+
+    if (!begin_frame(path, 'b')) return false;
+
+    // <base_time>,<period>,<samples>
+    if (!push_uint(base_time)) return false;
+    if (!push_char(','))       return false;
+    if (!push_uint(period))    return false;
+    if (!push_char(','))       return false;
+    if (!push_uint(samples))   return false;
+
+    uint32_t total = (uint32_t)samples * channels;
+
+    for (uint32_t i = 0; i < total; ++i)
+    {
+        if (!push_char(',')) return false;
+        if (!push_float(values[i])) return false;
+    }
+
+    return end_frame();
+}
+
+bool cmnd_sender::send_bytes(
+    const char* path,
+    const uint8_t* data,
+    uint16_t len,
+    uint16_t chunk)
+{
+    chunk -= chunk % FRAGMENT_BLOCK;
+
+    if (len == 0 || chunk == 0 || batch_open)
+        return false;
+
+    next_xfer++;
+
+    for (uint32_t off = 0; off < len; off += chunk)
+    {
+        uint16_t n = (uint16_t)((len - off < chunk) ? len - off : chunk);
+
+        next_tags   = FRAME_TAG_OFFSET | FRAME_TAG_TOTAL | FRAME_TAG_XFER;
+        next_offset = (uint16_t)off;
+        next_total  = len;
+
+        if (mode == wire_mode::BINARY)
+        {
+            if (!begin_packet(path, frame_kind::COMMAND, data_type::BYTES)) return false;
+            if (!push_bytes(data + off, n)) return false;
+            if (!end_packet()) return false;
+            continue;
+        }
+
+        if (!begin_frame(path)) return false;
+
+        // Two hex digits per byte keep the text framing intact
+        for (uint16_t i = 0; i < n; i++)
+        {
+            if (!push_char("0123456789ABCDEF"[data[off + i] >> 4]))   return false;
+            if (!push_char("0123456789ABCDEF"[data[off + i] & 0xFU])) return false;
+        }
+
+        if (!end_frame()) return false;
+    }
+
+    return true;
+}
+
+bool cmnd_sender::begin_batch()
+{
+    if (mode == wire_mode::BINARY)
+        return false;
+
+    stage_len     = 0;
+    crc_reg       = crc_init(crc);
+    batch_open    = true;
+    batch_entries = 0;
+
+    // {m:
+    if (!push_char('{')) return false;
+    if (!push_char('m')) return false;
+    return push_char(':');
+}
+
+bool cmnd_sender::end_batch()
+{
+    batch_open = false;
+    return end_frame();
+}
+
+void cmnd_sender::begin_burst()
+{
+	burst_open    = true;
+	burst_pending = false;
+}
+
+void cmnd_sender::end_burst()
+{
+	burst_open = false;
+
+	if (burst_pending)
+	{
+		burst_pending = false;
+		tx_ready.notify();
+	}
+}
+
+void cmnd_sender::signal_tx()
+{
+	if (burst_open)
+		burst_pending = true;
+	else
+		tx_ready.notify();
+}
 
 bool cmnd_sender::push_char(char c)
 {
-	if (!tx_queue.push(static_cast<uint8_t>(c)))
+	if (stage)
+	{
+		if (stage_len >= stage_size)
+			return false;
+
+		stage[stage_len++] = c;
+		return true;
+	}
+
+	if (!tx_queue->push(static_cast<uint8_t>(c)))
 		return false;
 
-	notify_tx_ready();   // HER BYTE SONRASI
+	queued_total++;
+	crc_reg = crc_update(crc, crc_reg, static_cast<uint8_t>(c));
+
+	signal_tx();   // HER BYTE SONRASI
 	return true;
 }
 bool cmnd_sender::push_string(const char* s)
@@ -109,6 +401,26 @@ bool cmnd_sender::push_int(int32_t v)
     return true;
 }
 
+bool cmnd_sender::push_uint(uint32_t v)
+{
+    char buf[10]; // 4294967295
+    int i = 0;
+
+    do
+    {
+        buf[i++] = '0' + (v % 10);
+        v /= 10;
+    } while (v > 0);
+
+    while (i--)
+    {
+        if (!push_char(buf[i]))
+            return false;
+    }
+
+    return true;
+}
+
 bool cmnd_sender::push_float(float v)
 {
     if (v < 0.0f)
@@ -146,13 +458,49 @@ bool cmnd_sender::push_float(float v)
 
     return push_int(frac_part);
 }
-bool cmnd_sender::begin_frame(const char* path)
+bool cmnd_sender::held_back(const char* path)
 {
-    // {p:<path>:d:
-    if (!push_char('{')) return false;
-    if (!push_char('p')) return false;
-    if (!push_char(':')) return false;
-    if (!push_string(path)) return false;
+    if (flow_ctl == nullptr || !flow_ctl->peer_paused() || path[0] == '$')
+        return false;
+
+    next_tags = 0;
+    flow_ctl->held();
+    return true;
+}
+
+bool cmnd_sender::begin_frame(const char* path, char kind)
+{
+    if (batch_open)
+    {
+        // [;]<path>:d:
+        if (kind != 'p') return false;
+        if (batch_entries++ && !push_char(';')) return false;
+    }
+    else
+    {
+        if (held_back(path)) return false;
+
+        stage_len = 0;
+        crc_reg   = crc_init(crc);
+
+        // {[<tag><value>:]...<kind>:
+        if (!push_char('{')) return false;
+
+        if ((next_tags || channel_id) && !push_tags()) return false;
+
+        if (!push_char(kind)) return false;
+        if (!push_char(':')) return false;
+    }
+
+    // <path>:d: or #<id>:d:
+    uint16_t id;
+    if (lookup_id(path, id))
+    {
+        if (!push_char('#')) return false;
+        if (!push_uint(id)) return false;
+    }
+    else if (!push_string(path)) return false;
+
     if (!push_char(':')) return false;
     if (!push_char('d')) return false;
     if (!push_char(':')) return false;
@@ -161,8 +509,186 @@ bool cmnd_sender::begin_frame(const char* path)
 
 bool cmnd_sender::end_frame()
 {
+	if (batch_open)
+		return true;
+
 	if (!push_char('}'))
 		return false;
 
+	if (crc != crc_mode::NONE && !push_crc())
+		return false;
+
+	if (stage)
+		return publish_stage();
+
+	return true;
+}
+
+bool cmnd_sender::begin_packet(const char* path, frame_kind kind, data_type type)
+{
+	if (held_back(path)) return false;
+
+	stage_len = 1;   // stage[0] = COBS code byte
+
+	if ((next_tags || channel_id) && !push_tags()) return false;
+
+	uint8_t  hdr[3] = { static_cast<uint8_t>(kind), static_cast<uint8_t>(type), 0 };
+	uint16_t id;
+
+	if (lookup_id(path, id))
+	{
+		// <kind><type><0><path_id:2>
+		if (!push_bytes(hdr, sizeof(hdr))) return false;
+		return push_bytes(&id, 2);
+	}
+
+	size_t path_len = strlen(path);
+	if (path_len == 0 || path_len > 0xFF)
+		return false;
+
+	hdr[2] = static_cast<uint8_t>(path_len);
+
+	if (!push_bytes(hdr, sizeof(hdr))) return false;
+	return push_bytes(path, path_len);
+}
+
+bool cmnd_sender::push_tags()
+{
+	const struct { uint8_t flag; char letter; uint16_t value; } tag[] = {
+		{ FRAME_TAG_SEQ,    's', next_seq    },
+		{ FRAME_TAG_OFFSET, 'o', next_offset },
+		{ FRAME_TAG_TOTAL,  't', next_total  },
+		{ FRAME_TAG_XFER,   'x', next_xfer   },
+		{ FRAME_TAG_CHANNEL, 'c', channel_id },
+		{ FRAME_TAG_REQUEST, 'q', next_request },
+		{ FRAME_TAG_REPLY,  'r', next_request },
+	};
+
+	uint8_t pending = next_tags | (channel_id ? FRAME_TAG_CHANNEL : 0);
+	next_tags = 0;
+
+	for (const auto& t : tag)
+	{
+		if (!(pending & t.flag))
+			continue;
+
+		if (mode == wire_mode::BINARY)
+		{
+			// <letter><value:2>
+			if (!push_bytes(&t.letter, 1)) return false;
+			if (!push_bytes(&t.value, 2))  return false;
+		}
+		else
+		{
+			// <letter><value>:
+			if (!push_char(t.letter))  return false;
+			if (!push_uint(t.value))   return false;
+			if (!push_char(':'))       return false;
+		}
+	}
+	return true;
+}
+
+bool cmnd_sender::push_crc()
+{
+	const uint8_t* frame = reinterpret_cast<const uint8_t*>(stage);
+
+	if (mode == wire_mode::BINARY)
+	{
+		// Whole decoded packet, after the COBS code byte placeholder
+		uint32_t v = crc_final(crc, crc_block(crc, crc_init(crc), frame + 1, stage_len - 1U));
+
+		if (crc == crc_mode::CRC16_CCITT)
+		{
+			uint8_t be[2] = { (uint8_t)(v >> 8), (uint8_t)v };
+			return push_bytes(be, 2);
+		}
+		return push_bytes(&v, 4);
+	}
+
+	uint32_t reg = stage ? crc_block(crc, crc_init(crc), frame, stage_len) : crc_reg;
+	uint32_t v   = crc_final(crc, reg);
+
+	for (int8_t shift = (int8_t)(crc_size(crc) * 8 - 4); shift >= 0; shift -= 4)
+	{
+		if (!push_char("0123456789ABCDEF"[(v >> shift) & 0xFU]))
+			return false;
+	}
+	return true;
+}
+
+bool cmnd_sender::end_packet()
+{
+	if (crc != crc_mode::NONE && !push_crc())
+		return false;
+
+	uint16_t len = cobs_encode_in_place(reinterpret_cast<uint8_t*>(stage),
+	                                    stage_len, stage_size);
+	if (len == 0 || len >= stage_size)
+		return false;
+
+	stage[len++] = 0x00;   // packet delimiter
+	stage_len = len;
+
+	return publish_stage();
+}
+
+bool cmnd_sender::push_bytes(const void* data, uint32_t len)
+{
+	if (len > (uint32_t)(stage_size - stage_len))
+		return false;
+
+	memcpy(&stage[stage_len], data, len);
+	stage_len += (uint16_t)len;
+	return true;
+}
+
+bool cmnd_sender::publish(const uint8_t* frame, uint16_t len)
+{
+	bool ok;
+
+	if (lanes)
+		ok = lanes->publish(lane, frame, len);
+	else if (mp_queue)
+		ok = mp_queue->write(frame, len);
+	else if (tx_queue->space() < len)
+		ok = false;
+	else
+	{
+		for (uint16_t i = 0; i < len; i++)
+			tx_queue->push(frame[i]);
+		ok = true;
+	}
+
+	if (ok)
+		queued_total += len;
+	return ok;
+}
+
+bool cmnd_sender::publish_stage()
+{
+	if (credits && !credits->reserve(channel_id, stage_len))
+		return false;
+
+	if (!publish(reinterpret_cast<const uint8_t*>(stage), stage_len))
+		return false;
+
+	if (credits)
+		credits->commit(channel_id, stage_len);
+
+	signal_tx();   // once per frame
+	return true;
+}
+
+bool cmnd_sender::send_raw(const uint8_t* frame, uint16_t len)
+{
+	// Forwarded frames are never control frames of this link
+	if (held_back(""))
+		return false;
+
+	if (!publish(frame, len))
+		return false;
+
+	signal_tx();
 	return true;
 }
@@ -0,0 +1,109 @@
+#include "core/crc.h"
+
+
+#if PATHWIRE_CRC_SLICE8
+
+uint16_t crc16_table[8][256];
+uint32_t crc32c_table[8][256];
+
+/**
+ * @brief Builds the slice-by-8 tables during static initialization
+ *
+ * @note CRC frames must not be sent from other static constructors.
+ */
+static struct crc_table_builder
+{
+    crc_table_builder()
+    {
+        for (uint32_t b = 0; b < 256; b++)
+        {
+            uint16_t c16 = (uint16_t)(b << 8);
+            uint32_t c32 = b;
+
+            for (int i = 0; i < 8; i++)
+            {
+                c16 = (c16 & 0x8000U) ? (uint16_t)((c16 << 1) ^ 0x1021U) : (uint16_t)(c16 << 1);
+                c32 = (c32 & 1U) ? (c32 >> 1) ^ 0x82F63B78U : (c32 >> 1);
+            }
+
+            crc16_table[0][b]  = c16;
+            crc32c_table[0][b] = c32;
+        }
+
+        // table[k][b] = CRC of b followed by k zero bytes
+        for (int k = 1; k < 8; k++)
+        {
+            for (uint32_t b = 0; b < 256; b++)
+            {
+                uint16_t p16 = crc16_table[k - 1][b];
+                uint32_t p32 = crc32c_table[k - 1][b];
+
+                crc16_table[k][b]  = (uint16_t)((p16 << 8) ^ crc16_table[0][p16 >> 8]);
+                crc32c_table[k][b] = (p32 >> 8) ^ crc32c_table[0][p32 & 0xFFU];
+            }
+        }
+    }
+} crc_tables;
+
+
+uint32_t crc_block(crc_mode mode, uint32_t reg, const uint8_t* p, uint32_t len)
+{
+    if (mode == crc_mode::CRC16_CCITT)
+    {
+        uint16_t crc = (uint16_t)reg;
+
+        for (; len >= 8; len -= 8, p += 8)
+        {
+            uint16_t x = crc ^ (uint16_t)((p[0] << 8) | p[1]);
+
+            crc = crc16_table[7][x >> 8]   ^ crc16_table[6][x & 0xFFU] ^
+                  crc16_table[5][p[2]]     ^ crc16_table[4][p[3]]      ^
+                  crc16_table[3][p[4]]     ^ crc16_table[2][p[5]]      ^
+                  crc16_table[1][p[6]]     ^ crc16_table[0][p[7]];
+        }
+        reg = crc;
+    }
+    else if (mode == crc_mode::CRC32C)
+    {
+        for (; len >= 8; len -= 8, p += 8)
+        {
+            uint32_t lo = reg ^ ((uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                                 ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+
+            reg = crc32c_table[7][lo & 0xFFU]         ^ crc32c_table[6][(lo >> 8) & 0xFFU] ^
+                  crc32c_table[5][(lo >> 16) & 0xFFU] ^ crc32c_table[4][lo >> 24]          ^
+                  crc32c_table[3][p[4]]               ^ crc32c_table[2][p[5]]              ^
+                  crc32c_table[1][p[6]]               ^ crc32c_table[0][p[7]];
+        }
+    }
+
+    while (len--)
+        reg = crc_update(mode, reg, *p++);
+
+    return reg;
+}
+
+#else
+
+const uint16_t crc16_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+const uint32_t crc32c_nibble[16] = {
+    0x00000000, 0x105EC76F, 0x20BD8EDE, 0x30E349B1,
+    0x417B1DBC, 0x5125DAD3, 0x61C69362, 0x7198540D,
+    0x82F63B78, 0x92A8FC17, 0xA24BB5A6, 0xB21572C9,
+    0xC38D26C4, 0xD3D3E1AB, 0xE330A81A, 0xF36E6F75
+};
+
+
+uint32_t crc_block(crc_mode mode, uint32_t reg, const uint8_t* p, uint32_t len)
+{
+    while (len--)
+        reg = crc_update(mode, reg, *p++);
+
+    return reg;
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include "core/flow_control.h"
+#include "core/cmnd_sender.h"
+
+
+flow_control::flow_control(
+    cmnd_sender& reply,
+    ring_buffer<uint8_t>& rx,
+    uint16_t high,
+    uint16_t low)
+    : reply(reply),
+      rx_queue(rx),
+      high(high),
+      low(low < high ? low : (uint16_t)(high / 2U)),
+      xoff(false),
+      xoff_due(false),
+      peer_xoff(false),
+      announced(false),
+      age(0),
+      counters()
+{
+}
+
+void flow_control::send(bool pause)
+{
+    announced = true;
+
+    if (!reply.send_trigger(pause ? "$xoff" : "$xon"))
+        return;     // repeated by tick()
+
+    if (pause)
+        counters.xoff_sent++;
+    else
+        counters.xon_sent++;
+
+    age = 0;
+}
+
+void flow_control::on_rx()
+{
+    // Interrupt context: the sender belongs to poll() and tick()
+    if (!xoff && rx_queue.count() >= high)
+    {
+        xoff     = true;
+        xoff_due = true;
+    }
+}
+
+void flow_control::poll()
+{
+    uint16_t level = rx_queue.count();
+
+    if (!xoff && level >= high)
+    {
+        xoff     = true;
+        xoff_due = true;
+    }
+    // on_rx() only sets xoff_due while xoff is false, so neither flag
+    // can change under us from here on
+    if (xoff_due)
+    {
+        xoff_due = false;
+        send(true);
+    }
+    else if (xoff && level <= low)
+    {
+        xoff = false;
+        send(false);
+    }
+}
+
+void flow_control::tick()
+{
+    if (announced && ++age >= FLOW_REFRESH_TICKS)
+        send(xoff);
+}
+
+void flow_control::on_peer(bool pause)
+{
+    if (pause && !peer_xoff)
+        counters.peer_pauses++;
+
+    peer_xoff = pause;
+}
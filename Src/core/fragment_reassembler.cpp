@@ -0,0 +1,154 @@
+#include "core/fragment_reassembler.h"
+#include <string.h>
+
+
+fragment_reassembler::fragment_reassembler(
+    uint8_t* buffer,
+    uint16_t size,
+    uint16_t timeout)
+    : buf(buffer),
+      buf_size(size),
+      timeout(timeout ? timeout : 1),
+      active(nullptr),
+      xfer(0),
+      total(0),
+      missing(0),
+      age(0),
+      done(nullptr),
+      done_xfer(0),
+      counters(),
+      dispatch_fn(nullptr),
+      dispatch_ctx(nullptr)
+{
+    memset(map, 0, sizeof(map));
+}
+
+void fragment_reassembler::set_handler_dispatch(handler_dispatch fn, void* ctx)
+{
+    dispatch_fn  = fn;
+    dispatch_ctx = ctx;
+}
+
+uint16_t fragment_reassembler::mark(uint16_t offset, uint16_t len)
+{
+    uint16_t first = offset / FRAGMENT_BLOCK;
+    uint16_t last  = (uint16_t)((offset + len + FRAGMENT_BLOCK - 1U) / FRAGMENT_BLOCK);
+    uint16_t added = 0;
+
+    for (uint16_t b = first; b < last; b++)
+    {
+        uint32_t bit = 1UL << (b % 32);
+
+        if (!(map[b / 32] & bit))
+        {
+            map[b / 32] |= bit;
+            added++;
+        }
+    }
+
+    missing -= added;
+    return added;
+}
+
+void fragment_reassembler::accept(
+    const path_entry& entry,
+    uint16_t id,
+    uint16_t offset,
+    uint16_t size,
+    const uint8_t* data,
+    uint16_t len)
+{
+    uint32_t blocks = ((uint32_t)size + FRAGMENT_BLOCK - 1U) / FRAGMENT_BLOCK;
+    uint32_t end    = (uint32_t)offset + len;
+
+    bool whole = (entry.expected_type == data_type::BYTES && buf && size <= buf_size) ||
+                 (entry.expected_type == data_type::CHUNK);
+
+    // Fragments start on a block boundary and only the last may be short
+    bool valid = whole && len > 0 && end <= size &&
+                 blocks <= FRAGMENT_MAX_BLOCKS &&
+                 offset % FRAGMENT_BLOCK == 0 &&
+                 (end == size || len % FRAGMENT_BLOCK == 0);
+
+    if (!valid)
+    {
+        counters.rejected++;
+        return;
+    }
+
+    // Late copy of a payload that was already delivered or dropped
+    if (done == &entry && done_xfer == id)
+    {
+        counters.duplicates++;
+        return;
+    }
+
+    // Payloads are sent one after another, so a new transfer means
+    // the current one will not be completed
+    if (active && (active != &entry || xfer != id || total != size))
+    {
+        active = nullptr;
+        counters.abandoned++;
+    }
+
+    if (active == nullptr)
+    {
+        active  = &entry;
+        xfer    = id;
+        total   = size;
+        missing = (uint16_t)blocks;
+        memset(map, 0, sizeof(map));
+    }
+
+    if (mark(offset, len) == 0)
+    {
+        counters.duplicates++;
+        return;
+    }
+
+    counters.fragments++;
+    age = 0;
+
+    bool complete = (missing == 0);
+
+    if (entry.expected_type == data_type::CHUNK)
+    {
+        payload_chunk chunk { offset, size, data, len, complete };
+
+        if (dispatch_fn)
+            dispatch_fn(dispatch_ctx, entry, data_type::CHUNK, &chunk, 1);
+        else
+            entry.handler(data_type::CHUNK, &chunk, 1);
+    }
+    else
+    {
+        memcpy(&buf[offset], data, len);
+
+        if (complete && dispatch_fn)
+            dispatch_fn(dispatch_ctx, entry, data_type::BYTES, buf, size);
+        else if (complete)
+            entry.handler(data_type::BYTES, buf, size);
+    }
+
+    if (complete)
+    {
+        finish();
+        counters.completed++;
+    }
+}
+
+void fragment_reassembler::tick()
+{
+    if (active && ++age >= timeout)
+    {
+        finish();
+        counters.timeouts++;
+    }
+}
+
+void fragment_reassembler::finish()
+{
+    done      = active;
+    done_xfer = xfer;
+    active    = nullptr;
+}
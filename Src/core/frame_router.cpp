@@ -0,0 +1,563 @@
+#include "core/frame_router.h"
+#include "core/cmnd_sender.h"
+#include "core/reliable_link.h"
+#include "core/channel_credits.h"
+
+#include <string.h>
+
+
+static bool is_tag_letter(uint8_t c)
+{
+    return c == 's' || c == 'o' || c == 't' || c == 'x' || c == 'c' || c == 'q' || c == 'r';
+}
+
+frame_router::frame_router(
+    ring_buffer<uint8_t>& rx,
+    ring_buffer<uint8_t>& local,
+    char* scratch,
+    uint16_t scratch_size)
+    : rx_queue(rx),
+      local_queue(local),
+      scratch(scratch),
+      scratch_size(scratch_size),
+      routes(nullptr),
+      route_count(0),
+      links(nullptr),
+      mode(wire_mode::TEXT),
+      crc(crc_mode::NONE),
+      state(state_t::IDLE),
+      first(nullptr),
+      second(nullptr),
+      first_len(0),
+      second_len(0),
+      avail(0),
+      route(nullptr),
+      path_start(0),
+      path_end(0),
+      frame_len(0),
+      frame_tags(0),
+      frame_seq(0),
+      frame_channel(0),
+      accepted(false),
+      arq(nullptr),
+      credits(nullptr),
+      counters()
+{
+}
+
+bool frame_router::set_routes(
+    const frame_route* table,
+    uint8_t count,
+    cmnd_sender* const* out,
+    uint8_t link_count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (table[i].link >= link_count || out[table[i].link] == nullptr)
+            return false;
+    }
+
+    routes      = table;
+    route_count = count;
+    links       = out;
+    return true;
+}
+
+void frame_router::set_wire_mode(wire_mode new_mode)
+{
+    mode  = new_mode;
+    state = state_t::IDLE;
+}
+
+void frame_router::set_crc_mode(crc_mode new_crc)
+{
+    crc = new_crc;
+}
+
+void frame_router::set_reliable_link(reliable_link* link)
+{
+    arq = link;
+}
+
+void frame_router::set_channel_credits(channel_credits* channel_credits)
+{
+    credits = channel_credits;
+}
+
+// Keeps the tags the inbound link's ARQ and credits need
+static void note_tag(uint8_t letter, uint16_t value,
+                     uint8_t& tags, uint16_t& seq, uint8_t& channel)
+{
+    if (letter == 's')
+    {
+        tags |= FRAME_TAG_SEQ;
+        seq   = value;
+    }
+    else if (letter == 'c')
+    {
+        tags   |= FRAME_TAG_CHANNEL;
+        channel = (uint8_t)value;
+    }
+}
+
+const frame_route* frame_router::match(const char* path, uint16_t len) const
+{
+    for (uint8_t i = 0; i < route_count; i++)
+    {
+        const char* prefix = routes[i].prefix;
+        uint16_t    n      = 0;
+
+        while (prefix[n] != '\0' && n < len && prefix[n] == path[n])
+            n++;
+
+        if (prefix[n] == '\0')
+            return &routes[i];
+    }
+    return nullptr;
+}
+
+void frame_router::gather(uint16_t from, uint16_t n, uint16_t to)
+{
+    if (from < first_len)
+    {
+        uint16_t head = (uint16_t)(first_len - from);
+        if (head > n)
+            head = n;
+
+        memcpy(&scratch[to], &first[from], head);
+        from = (uint16_t)(from + head);
+        to   = (uint16_t)(to + head);
+        n    = (uint16_t)(n - head);
+    }
+
+    if (n)
+        memcpy(&scratch[to], &second[from - first_len], n);
+}
+
+frame_router::verdict frame_router::classify_text()
+{
+    // A header or frame that cannot grow any more is never routed
+    const bool full = rx_queue.space() == 0;
+
+    // {[<tag><value>:]...<kind>:<path>:
+    uint16_t i = 1;
+
+    frame_tags    = 0;
+    frame_channel = 0;
+
+    while (i < avail && is_tag_letter(at(i)))
+    {
+        uint8_t  letter = at(i);
+        uint32_t value  = 0;
+
+        for (i++; i < avail && at(i) >= '0' && at(i) <= '9'; i++)
+            value = value * 10U + (uint32_t)(at(i) - '0');
+
+        if (i < avail && at(i) != ':')
+            return verdict::LOCAL;
+        i++;
+
+        note_tag(letter, (uint16_t)value, frame_tags, frame_seq, frame_channel);
+    }
+
+    if ((uint16_t)(i + 1) >= avail)
+        return full ? verdict::LOCAL : verdict::WAIT;
+
+    if ((at(i) != 'p' && at(i) != 'b') || at(i + 1) != ':')
+        return verdict::LOCAL;   // batch or malformed
+
+    path_start = (uint16_t)(i + 2);
+
+    for (i = path_start; i < avail && at(i) != ':'; i++)
+    {
+        if (at(i) == '{' || at(i) == '}')
+            return verdict::LOCAL;
+    }
+
+    if (i >= avail)
+        return full ? verdict::LOCAL : verdict::WAIT;
+
+    path_end = i;
+
+    if (path_end == path_start || at(path_start) == '#')
+        return verdict::LOCAL;
+
+    // Prefixes are short; the head of the path is enough to match
+    uint16_t n = (uint16_t)(path_end - path_start);
+    if (n > scratch_size)
+        n = scratch_size;
+
+    gather(path_start, n, 0);
+
+    route = match(scratch, n);
+    if (route == nullptr)
+        return verdict::LOCAL;
+
+    // Routed frames are forwarded in one piece: '}' plus the hex trailer
+    for (; i < avail && at(i) != '}'; i++)
+    {
+        if (at(i) == '{')
+            return verdict::LOCAL;   // truncated; the parser resyncs
+    }
+
+    frame_len = (uint16_t)(i + 1U + 2U * crc_size(crc));
+
+    if (i >= avail || frame_len > avail)
+        return full ? verdict::SKIP : verdict::WAIT;
+
+    // A rewrite gets a fresh trailer, so the received one is checked
+    // first; verbatim frames keep theirs for the outbound parser
+    if ((route->strip || route->add) && !crc_matches(i))
+        return verdict::CORRUPT;
+
+    return verdict::FORWARD;
+}
+
+bool frame_router::crc_matches(uint16_t end) const
+{
+    if (crc == crc_mode::NONE)
+        return true;
+
+    uint32_t reg = crc_init(crc);
+
+    for (uint16_t k = 0; k <= end; k++)
+        reg = crc_update(crc, reg, at(k));
+
+    uint32_t rx_crc = 0;
+
+    for (uint16_t k = 0; k < 2U * crc_size(crc); k++)
+    {
+        uint8_t  c = at((uint16_t)(end + 1U + k));
+        uint32_t d;
+
+        if (c >= '0' && c <= '9')      d = (uint32_t)(c - '0');
+        else if (c >= 'A' && c <= 'F') d = (uint32_t)(c - 'A' + 10);
+        else return false;   // upper case only, as in the parser
+
+        rx_crc = (rx_crc << 4) | d;
+    }
+
+    return crc_final(crc, reg) == rx_crc;
+}
+
+bool frame_router::next_decoded(cobs_cursor& c, uint8_t& out) const
+{
+    const uint16_t end = (uint16_t)(frame_len - 1U);   // delimiter
+
+    for (;;)
+    {
+        if (c.pos >= end)
+            return false;
+
+        if (c.left)
+        {
+            out = at(c.pos++);
+            c.left--;
+            return true;
+        }
+
+        // Block boundary: the implied zero, unless the packet ends here
+        if (c.zero)
+        {
+            c.zero = false;
+            out    = 0;
+            return true;
+        }
+
+        uint8_t code = at(c.pos++);
+        c.left = (uint8_t)(code - 1U);
+        c.zero = (code != 0xFF);
+    }
+}
+
+frame_router::verdict frame_router::classify_binary()
+{
+    uint16_t end = 0;
+
+    while (end < avail && at(end) != 0)
+        end++;
+
+    if (end >= avail)
+        return rx_queue.space() == 0 ? verdict::LOCAL : verdict::WAIT;
+
+    frame_len = (uint16_t)(end + 1U);
+
+    // [<tag:1><value:2>]...<kind><type><path_len><path>
+    cobs_cursor c = { 0, 0, false };
+    uint8_t     b;
+
+    if (!next_decoded(c, b))
+        return verdict::LOCAL;
+
+    frame_tags    = 0;
+    frame_channel = 0;
+
+    while (is_tag_letter(b))
+    {
+        uint8_t letter = b, lo, hi;
+
+        // <value:2>, little-endian
+        if (!next_decoded(c, lo) || !next_decoded(c, hi) || !next_decoded(c, b))
+            return verdict::LOCAL;
+
+        note_tag(letter, (uint16_t)(lo | (hi << 8)), frame_tags, frame_seq, frame_channel);
+    }
+
+    uint8_t path_len;
+
+    if ((b != 'p' && b != 'b') ||
+        !next_decoded(c, b) ||            // type
+        !next_decoded(c, path_len) ||
+        path_len == 0)                    // path ID
+        return verdict::LOCAL;
+
+    uint16_t n = 0;
+
+    while (n < path_len && n < scratch_size && next_decoded(c, b))
+        scratch[n++] = (char)b;
+
+    route = match(scratch, n);
+    if (route == nullptr)
+        return verdict::LOCAL;
+
+    if (route->strip || route->add)
+        return verdict::SKIP;   // would need re-encoding
+
+    return verdict::FORWARD;
+}
+
+void frame_router::release()
+{
+    rx_queue.consume(frame_len);
+    accepted = false;
+
+    // The peer charged the encoded size, duplicates included
+    if (credits)
+        credits->received(frame_channel, frame_len);
+    if (arq && (frame_tags & FRAME_TAG_SEQ))
+        arq->flush_ack(rx_queue.empty());
+}
+
+bool frame_router::forward()
+{
+    cmnd_sender* out = links[route->link];
+
+    // Registered once, even if the outbound queue stalls the frame
+    if (arq && (frame_tags & FRAME_TAG_SEQ) && !accepted)
+    {
+        if (!arq->accept(frame_seq))
+        {
+            counters.duplicates++;   // acknowledged again, not forwarded
+            release();
+            return true;
+        }
+        accepted = true;
+    }
+
+    if (route->strip == 0 && route->add == nullptr)
+    {
+        bool ok;
+
+        if (frame_len <= first_len)
+        {
+            // Straight from the RX ring
+            ok = out->send_raw(first, frame_len);
+        }
+        else if (frame_len <= scratch_size)
+        {
+            gather(0, frame_len, 0);
+            ok = out->send_raw(reinterpret_cast<const uint8_t*>(scratch), frame_len);
+        }
+        else
+        {
+            counters.dropped++;
+            release();
+            return true;
+        }
+
+        if (!ok)
+            return false;
+    }
+    else
+    {
+        // Text only: <head><add><path after strip><rest up to '}'><new trailer>
+        uint16_t trailer = (uint16_t)(2U * crc_size(crc));
+        uint16_t body    = (uint16_t)(frame_len - trailer);
+        uint16_t strip   = route->strip;
+        uint16_t add_len = route->add ? (uint16_t)strlen(route->add) : 0;
+
+        if (strip > path_end - path_start)
+            strip = (uint16_t)(path_end - path_start);
+
+        uint32_t new_body = (uint32_t)body - strip + add_len;
+
+        if (new_body + trailer > scratch_size)
+        {
+            counters.dropped++;
+            release();
+            return true;
+        }
+
+        gather(0, path_start, 0);
+        if (add_len)
+            memcpy(&scratch[path_start], route->add, add_len);
+        gather((uint16_t)(path_start + strip),
+               (uint16_t)(body - path_start - strip),
+               (uint16_t)(path_start + add_len));
+
+        if (crc != crc_mode::NONE)
+        {
+            uint32_t v = crc_final(crc, crc_block(crc, crc_init(crc),
+                reinterpret_cast<const uint8_t*>(scratch), new_body));
+
+            for (uint16_t k = 0; k < trailer; k++)
+                scratch[new_body + k] = "0123456789ABCDEF"[(v >> (4U * (trailer - 1U - k))) & 0xFU];
+        }
+
+        if (!out->send_raw(reinterpret_cast<const uint8_t*>(scratch),
+                           (uint16_t)(new_body + trailer)))
+            return false;
+    }
+
+    counters.forwarded++;
+    release();
+    return true;
+}
+
+bool frame_router::pass_local()
+{
+    // Text: up to the next '{' (byte 0 always goes, it may be one); the
+    // byte after the run is classified again in any case.
+    // Binary: up to and including the delimiter.
+    uint16_t n   = 1;
+    bool     end = false;
+
+    if (mode == wire_mode::TEXT)
+    {
+        while (n < avail && at(n) != '{')
+            n++;
+        end = true;
+    }
+    else
+    {
+        for (n = 0; n < avail && !end; n++)
+            end = at(n) == 0;
+    }
+
+    uint8_t* dst_first;
+    uint8_t* dst_second;
+    uint16_t dst_first_len;
+    uint16_t dst_second_len;
+    uint16_t space = local_queue.writable(dst_first, dst_first_len, dst_second, dst_second_len);
+
+    if (space == 0)
+        return false;
+
+    if (n > space)
+    {
+        n   = space;
+        end = mode == wire_mode::TEXT;
+    }
+
+    // Segment-wise copy between the two rings
+    for (uint16_t done = 0; done < n; )
+    {
+        const uint8_t* src     = done < first_len ? &first[done] : &second[done - first_len];
+        uint16_t       src_len = (uint16_t)(done < first_len ? first_len - done
+                                                             : second_len - (done - first_len));
+        uint8_t*       dst     = done < dst_first_len ? &dst_first[done]
+                                                      : &dst_second[done - dst_first_len];
+        uint16_t       dst_len = (uint16_t)(done < dst_first_len ? dst_first_len - done
+                                                                 : dst_second_len - (done - dst_first_len));
+        uint16_t       chunk   = (uint16_t)(n - done);
+
+        if (chunk > src_len) chunk = src_len;
+        if (chunk > dst_len) chunk = dst_len;
+
+        memcpy(dst, src, chunk);
+        done = (uint16_t)(done + chunk);
+    }
+
+    local_queue.produce(n);
+    rx_queue.consume(n);
+
+    if (end)
+        state = state_t::IDLE;
+    return true;
+}
+
+void frame_router::skip()
+{
+    const uint8_t last = (mode == wire_mode::TEXT) ? '}' : 0;
+    uint16_t      n    = 0;
+
+    while (n < avail && at(n) != last)
+        n++;
+
+    if (n < avail)
+    {
+        n++;
+        state = state_t::IDLE;
+    }
+
+    rx_queue.consume(n);
+}
+
+void frame_router::poll()
+{
+    for (;;)
+    {
+        avail = rx_queue.readable(first, first_len, second, second_len);
+        if (avail == 0)
+            return;
+
+        switch (state)
+        {
+        case state_t::LOCAL:
+            if (!pass_local())
+                return;
+            break;
+
+        case state_t::SKIP:
+            skip();
+            break;
+
+        case state_t::IDLE:
+        default:
+        {
+            if (mode == wire_mode::TEXT && at(0) != '{')
+            {
+                state = state_t::LOCAL;   // bytes between frames
+                break;
+            }
+
+            verdict v = (mode == wire_mode::TEXT) ? classify_text() : classify_binary();
+
+            if (v == verdict::WAIT)
+                return;
+
+            if (v == verdict::LOCAL)
+            {
+                counters.local++;
+                state = state_t::LOCAL;
+            }
+            else if (v == verdict::SKIP)
+            {
+                counters.dropped++;
+                state = state_t::SKIP;
+            }
+            else if (v == verdict::CORRUPT)
+            {
+                counters.dropped++;
+                rx_queue.consume(frame_len);
+            }
+            else if (!forward())
+            {
+                counters.stalls++;
+                return;
+            }
+            break;
+        }
+        }
+    }
+}
@@ -0,0 +1,244 @@
+#include "core/reliable_link.h"
+#include <string.h>
+
+
+reliable_link::reliable_link(
+    cmnd_sender& sender,
+    uint8_t* storage,
+    uint16_t slot_size,
+    uint8_t window,
+    uint16_t timeout)
+    : tx(sender),
+      frames(storage),
+      slot_size(slot_size),
+      window(window == 0 ? 1 : (window > RELIABLE_MAX_WINDOW ? RELIABLE_MAX_WINDOW : window)),
+      timeout(timeout ? timeout : 1)
+{
+    reset();
+}
+
+void reliable_link::reset()
+{
+    tx_base   = 0;
+    tx_next   = 0;
+    base_slot = 0;
+    rx_next   = 0;
+    rx_mask   = 0;
+    ack_due   = 0;
+
+    for (uint8_t i = 0; i < RELIABLE_MAX_WINDOW; i++)
+        slots[i] = slot{ 0, 0, false };
+
+    counters = reliable_stats{};
+}
+
+bool reliable_link::begin()
+{
+    // Every frame the stage can hold must fit a slot: the frame is on
+    // the wire with tx_next before finish() sees its size
+    if (!can_send() || tx.stage == nullptr || tx.stage_size > slot_size || tx.batch_open)
+        return false;
+
+    tx.next_tags |= FRAME_TAG_SEQ;
+    tx.next_seq  = tx_next;
+    return true;
+}
+
+bool reliable_link::finish(bool sent)
+{
+    tx.next_tags = 0;
+
+    if (!sent)
+        return false;
+
+    // The staging buffer still holds the encoded frame (at most slot_size bytes)
+    uint8_t k = (uint8_t)((base_slot + in_flight()) % window);
+
+    memcpy(&frames[(uint32_t)k * slot_size], tx.stage, tx.stage_len);
+    slots[k] = slot{ tx.stage_len, 0, false };
+
+    tx_next++;
+    counters.sent++;
+    return true;
+}
+
+bool reliable_link::send_trigger(const char* path)
+{
+    if (!begin()) return false;
+    return finish(tx.send_trigger(path));
+}
+
+bool reliable_link::send_int(const char* path, const int32_t* values, uint16_t count)
+{
+    if (!begin()) return false;
+    return finish(tx.send_int(path, values, count));
+}
+
+bool reliable_link::send_float(const char* path, const float* values, uint16_t count)
+{
+    if (!begin()) return false;
+    return finish(tx.send_float(path, values, count));
+}
+
+bool reliable_link::send_string(const char* path, const char* const* values, uint16_t count)
+{
+    if (!begin()) return false;
+    return finish(tx.send_string(path, values, count));
+}
+
+void reliable_link::tick()
+{
+    uint8_t n = in_flight();
+
+    // Retransmissions wait for the peer's XON, and for an open batch to
+    // release the staging buffer
+    if ((tx.flow_ctl && tx.flow_ctl->peer_paused()) || tx.batch_open)
+        n = 0;
+
+    tx.begin_burst();
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        slot& s = slots[(base_slot + i) % window];
+
+        if (s.len == 0)
+            continue;
+
+        // Early: a frame sent after this one has been acknowledged
+        if (++s.age < timeout && !s.lost)
+            continue;
+
+        // Resend the stored encoded frame unchanged
+        memcpy(tx.stage, &frames[(uint32_t)((base_slot + i) % window) * slot_size], s.len);
+        tx.stage_len = s.len;
+
+        if (tx.publish_stage())
+        {
+            if (s.lost && s.age < timeout)
+                counters.early_resends++;
+
+            s.age  = 0;
+            s.lost = false;
+            counters.retransmits++;
+        }
+    }
+
+    tx.end_burst();
+}
+
+void reliable_link::on_ack(uint16_t next, uint32_t mask)
+{
+    uint8_t  n        = in_flight();
+    uint32_t selected = 0;      // bit i: slot base + i acked by the mask now
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        slot&    s   = slots[(base_slot + i) % window];
+        uint16_t seq = (uint16_t)(tx_base + i);
+
+        if (s.len == 0)
+            continue;
+
+        uint16_t behind = (uint16_t)(next - seq);   // > 0: cumulatively acked
+        uint16_t ahead  = (uint16_t)(seq - next);   // > 0: selective bit ahead - 1
+
+        bool cumulative = behind != 0 && behind < 0x8000U;
+        bool selective  = ahead != 0 && ahead <= 32U && ((mask >> (ahead - 1U)) & 1U);
+
+        if (cumulative || selective)
+        {
+            s.len = 0;
+            counters.acked++;
+        }
+        if (selective)
+            selected |= 1UL << i;
+    }
+
+    // A gap below a frame that was sent later (younger) and has arrived
+    // is lost, not late: resend it on the next tick() without waiting
+    // for its timer. Frames sent after the gap's last transmission do
+    // not count, so a retransmission still in flight is not sent again.
+    uint16_t youngest = 0xFFFFU;
+
+    for (uint8_t i = n; i-- > 0; )
+    {
+        slot& s = slots[(base_slot + i) % window];
+
+        if ((selected >> i) & 1U)
+        {
+            if (s.age < youngest)
+                youngest = s.age;
+        }
+        else if (s.len != 0 && s.age > youngest)
+        {
+            s.lost = true;
+        }
+    }
+
+    // Slide the window over the acknowledged prefix
+    while (tx_base != tx_next && slots[base_slot].len == 0)
+    {
+        tx_base++;
+        base_slot = (uint8_t)((base_slot + 1) % window);
+    }
+}
+
+bool reliable_link::accept(uint16_t seq)
+{
+    uint16_t d = (uint16_t)(seq - rx_next);
+
+    if (d >= 0x8000U)
+    {
+        // Already delivered; the ACK was lost
+        ack_due++;
+        counters.duplicates++;
+        return false;
+    }
+
+    if (d == 0)
+    {
+        rx_next++;
+
+        while (rx_mask & 1U)
+        {
+            rx_mask >>= 1;
+            rx_next++;
+        }
+        rx_mask >>= 1;
+    }
+    else if (d <= 32U)
+    {
+        uint32_t bit = 1UL << (d - 1U);
+
+        if (rx_mask & bit)
+        {
+            ack_due++;
+            counters.duplicates++;
+            return false;
+        }
+        rx_mask |= bit;
+    }
+    else
+    {
+        return false;   // outside any valid window
+    }
+
+    ack_due++;
+    counters.received++;
+    return true;
+}
+
+void reliable_link::flush_ack(bool idle)
+{
+    if (ack_due == 0 || (!idle && ack_due < RELIABLE_ACK_EVERY))
+        return;
+
+    // <next>,<mask>
+    int32_t v[2] = { (int32_t)rx_next, (int32_t)rx_mask };
+
+    if (tx.send_int("$ack", v, 2))
+    {
+        ack_due = 0;
+        counters.acks_sent++;
+    }
+}
@@ -0,0 +1,96 @@
+#include "core/reply_writer.h"
+#include "core/cmnd_sender.h"
+
+#include <string.h>
+
+
+reply_writer::reply_writer(cmnd_sender* sender, uint16_t request)
+    : tx(sender),
+      id(request),
+      type(data_type::NONE),
+      count(0),
+      state(state_t::IDLE)
+{
+}
+
+bool reply_writer::begin(const char* path, data_type value_type)
+{
+    if (tx == nullptr || state != state_t::IDLE || tx->batch_open)
+        return false;
+
+    type  = value_type;
+    count = 0;
+
+    tx->tag_reply(id);
+
+    bool ok = (tx->mode == wire_mode::BINARY)
+            ? tx->begin_packet(path, frame_kind::COMMAND, value_type)
+            : tx->begin_frame(path);
+
+    state = ok ? state_t::OPEN : state_t::FAILED;
+    return ok;
+}
+
+bool reply_writer::next_value(data_type value_type)
+{
+    if (state != state_t::OPEN || value_type != type)
+        return false;
+
+    if (tx->mode == wire_mode::TEXT && count && !tx->push_char(','))
+    {
+        state = state_t::FAILED;
+        return false;
+    }
+
+    count++;
+    return true;
+}
+
+bool reply_writer::add_int(int32_t value)
+{
+    if (!next_value(data_type::INT))
+        return false;
+
+    bool ok = (tx->mode == wire_mode::BINARY) ? tx->push_bytes(&value, 4)
+                                              : tx->push_int(value);
+    if (!ok)
+        state = state_t::FAILED;
+    return ok;
+}
+
+bool reply_writer::add_float(float value)
+{
+    if (!next_value(data_type::FLOAT))
+        return false;
+
+    bool ok = (tx->mode == wire_mode::BINARY) ? tx->push_bytes(&value, 4)
+                                              : tx->push_float(value);
+    if (!ok)
+        state = state_t::FAILED;
+    return ok;
+}
+
+bool reply_writer::add_string(const char* value)
+{
+    if (!next_value(data_type::STRING))
+        return false;
+
+    // Binary: <str>\0 per value
+    bool ok = (tx->mode == wire_mode::BINARY) ? tx->push_bytes(value, strlen(value) + 1)
+                                              : tx->push_string(value);
+    if (!ok)
+        state = state_t::FAILED;
+    return ok;
+}
+
+bool reply_writer::end()
+{
+    if (state != state_t::OPEN)
+        return false;
+
+    bool ok = (tx->mode == wire_mode::BINARY) ? tx->end_packet()
+                                              : tx->end_frame();
+
+    state = ok ? state_t::DONE : state_t::FAILED;
+    return ok;
+}
@@ -0,0 +1,103 @@
+#include "core/sample_aggregator.h"
+#include "core/cmnd_executer.h"
+#include <math.h>
+#include <float.h>
+
+
+sample_aggregator::sample_aggregator(
+    cmnd_sender& sender,
+    const char* path,
+    uint8_t channels,
+    uint16_t window,
+    uint8_t stages)
+    : tx(sender),
+      path(path),
+      channels(channels > AGGREGATOR_MAX_CHANNELS ? AGGREGATOR_MAX_CHANNELS
+                                                  : (channels ? channels : 1)),
+      stages(stages),
+      window(window ? window : 1),
+      n(0),
+      drop_count(0)
+{
+    uint8_t enabled = 0;
+
+    for (uint8_t s = AGG_MEAN; s <= AGG_LAST; s = (uint8_t)(s << 1))
+        if (stages & s)
+            enabled++;
+
+    // The receiver parses at most MAX_CSV_ITEMS values per frame
+    if (enabled * this->channels > MAX_CSV_ITEMS)
+        this->stages = 0;
+    else
+        this->stages = (uint8_t)(stages & (AGG_MEAN | AGG_MIN | AGG_MAX | AGG_RMS | AGG_LAST));
+
+    reset();
+}
+
+void sample_aggregator::reset()
+{
+    n = 0;
+
+    for (uint8_t c = 0; c < AGGREGATOR_MAX_CHANNELS; c++)
+    {
+        sum[c]    = 0.0f;
+        sum_sq[c] = 0.0f;
+        min_v[c]  = FLT_MAX;
+        max_v[c]  = -FLT_MAX;
+        last[c]   = 0.0f;
+    }
+}
+
+bool sample_aggregator::push(const float* sample)
+{
+    if (!valid())
+        return false;
+
+    // Every accumulator is updated unconditionally; min/max compile to
+    // conditional selects, so the loop body has no data-dependent branch.
+    for (uint8_t c = 0; c < channels; c++)
+    {
+        float v = sample[c];
+
+        sum[c]    += v;
+        sum_sq[c] += v * v;
+        min_v[c]   = v < min_v[c] ? v : min_v[c];
+        max_v[c]   = v > max_v[c] ? v : max_v[c];
+        last[c]    = v;
+    }
+
+    if (++n < window)
+        return true;
+
+    bool ok = emit();
+    reset();
+    return ok;
+}
+
+bool sample_aggregator::emit()
+{
+    float    out[5 * AGGREGATOR_MAX_CHANNELS];
+    uint16_t k   = 0;
+    float    inv = 1.0f / (float)n;
+
+    if (stages & AGG_MEAN)
+        for (uint8_t c = 0; c < channels; c++) out[k++] = sum[c] * inv;
+
+    if (stages & AGG_MIN)
+        for (uint8_t c = 0; c < channels; c++) out[k++] = min_v[c];
+
+    if (stages & AGG_MAX)
+        for (uint8_t c = 0; c < channels; c++) out[k++] = max_v[c];
+
+    if (stages & AGG_RMS)
+        for (uint8_t c = 0; c < channels; c++) out[k++] = sqrtf(sum_sq[c] * inv);
+
+    if (stages & AGG_LAST)
+        for (uint8_t c = 0; c < channels; c++) out[k++] = last[c];
+
+    if (tx.send_float(path, out, k))
+        return true;
+
+    drop_count++;
+    return false;
+}
@@ -0,0 +1,174 @@
+#include "core/telemetry_filter.h"
+
+
+telemetry_filter::telemetry_filter(cmnd_sender& sender)
+    : tx(sender)
+{
+}
+
+
+static float abs_f(float v)
+{
+    return v < 0.0f ? -v : v;
+}
+
+// FNV-1a over all strings, with the separator included so that
+// {"ab","c"} and {"a","bc"} hash differently.
+static uint32_t hash_strings(const char* const* values, uint16_t count)
+{
+    uint32_t h = 2166136261U;
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        for (const char* p = values[i]; *p; p++)
+        {
+            h ^= static_cast<uint8_t>(*p);
+            h *= 16777619U;
+        }
+        h ^= ',';
+        h *= 16777619U;
+    }
+
+    return h;
+}
+
+bool telemetry_filter::refresh_due(
+    const deadband_entry& entry,
+    uint16_t count,
+    uint32_t now)
+{
+    if (!entry.has_last || entry.last_count != count)
+        return true;
+
+    return entry.max_silence && (now - entry.last_time) >= entry.max_silence;
+}
+
+void telemetry_filter::mark_sent(deadband_entry& entry, uint16_t count, uint32_t now)
+{
+    entry.has_last   = true;
+    entry.last_count = count;
+    entry.last_time  = now;
+    entry.sent++;
+}
+
+bool telemetry_filter::send_int(
+    deadband_entry& entry,
+    const char* path,
+    const int32_t* values,
+    uint16_t count,
+    uint32_t now)
+{
+    // Elements past the cache could never be compared
+    if (count > DEADBAND_MAX_ITEMS)
+        return false;
+
+    bool change = refresh_due(entry, count, now);
+
+    for (uint16_t i = 0; i < count && !change; i++)
+    {
+        int64_t diff = static_cast<int64_t>(values[i]) - entry.last.i[i];
+        float   d    = static_cast<float>(diff < 0 ? -diff : diff);
+
+        switch (entry.mode)
+        {
+            case deadband_mode::ABSOLUTE:
+                change = d > entry.threshold;
+                break;
+
+            case deadband_mode::RELATIVE:
+                change = d > entry.threshold * abs_f(static_cast<float>(entry.last.i[i]));
+                break;
+
+            default:
+                change = diff != 0;
+                break;
+        }
+    }
+
+    if (!change)
+    {
+        entry.suppressed++;
+        return true;
+    }
+
+    if (!tx.send_int(path, values, count))
+        return false;
+
+    for (uint16_t i = 0; i < count; i++)
+        entry.last.i[i] = values[i];
+
+    mark_sent(entry, count, now);
+    return true;
+}
+
+bool telemetry_filter::send_float(
+    deadband_entry& entry,
+    const char* path,
+    const float* values,
+    uint16_t count,
+    uint32_t now)
+{
+    // Elements past the cache could never be compared
+    if (count > DEADBAND_MAX_ITEMS)
+        return false;
+
+    bool change = refresh_due(entry, count, now);
+
+    for (uint16_t i = 0; i < count && !change; i++)
+    {
+        float d = abs_f(values[i] - entry.last.f[i]);
+
+        switch (entry.mode)
+        {
+            case deadband_mode::ABSOLUTE:
+                change = d > entry.threshold;
+                break;
+
+            case deadband_mode::RELATIVE:
+                change = d > entry.threshold * abs_f(entry.last.f[i]);
+                break;
+
+            default:
+                change = values[i] != entry.last.f[i];
+                break;
+        }
+    }
+
+    if (!change)
+    {
+        entry.suppressed++;
+        return true;
+    }
+
+    if (!tx.send_float(path, values, count))
+        return false;
+
+    for (uint16_t i = 0; i < count; i++)
+        entry.last.f[i] = values[i];
+
+    mark_sent(entry, count, now);
+    return true;
+}
+
+bool telemetry_filter::send_string(
+    deadband_entry& entry,
+    const char* path,
+    const char* const* values,
+    uint16_t count,
+    uint32_t now)
+{
+    uint32_t h = hash_strings(values, count);
+
+    if (!refresh_due(entry, count, now) && h == entry.last_hash)
+    {
+        entry.suppressed++;
+        return true;
+    }
+
+    if (!tx.send_string(path, values, count))
+        return false;
+
+    entry.last_hash = h;
+    mark_sent(entry, count, now);
+    return true;
+}
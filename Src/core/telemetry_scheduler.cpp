@@ -0,0 +1,172 @@
+#include "core/telemetry_scheduler.h"
+
+
+telemetry_scheduler::telemetry_scheduler(
+    cmnd_sender& sender,
+    telemetry_slot* slots,
+    uint16_t capacity)
+    : tx(sender),
+      filter(sender),
+      slot_table(slots),
+      slot_count(capacity),
+      counters()
+{
+    for (uint16_t i = 0; i < slot_count; i++)
+        slot_table[i].active = false;
+}
+
+
+// Van der Corput sequence: bit-reversed index as a fraction of 256.
+// Consecutive indices land far apart (0, 1/2, 1/4, 3/4, ...).
+static uint16_t phase_offset(uint16_t index, uint16_t period)
+{
+    uint8_t r = 0;
+
+    for (uint8_t b = 0; b < 8; b++)
+    {
+        if (index & (1U << b))
+            r |= static_cast<uint8_t>(0x80U >> b);
+    }
+
+    return static_cast<uint16_t>((static_cast<uint32_t>(period) * r) >> 8);
+}
+
+int16_t telemetry_scheduler::add(const telemetry_entry& entry)
+{
+    if (entry.path == nullptr || entry.period == 0)
+        return -1;
+
+    // The filter refuses numeric payloads it cannot fully compare
+    if (entry.deadband && entry.getter == nullptr &&
+        (entry.type == data_type::INT || entry.type == data_type::FLOAT) &&
+        entry.count > DEADBAND_MAX_ITEMS)
+        return -1;
+
+    for (uint16_t i = 0; i < slot_count; i++)
+    {
+        if (slot_table[i].active)
+            continue;
+
+        slot_table[i].entry     = entry;
+        slot_table[i].countdown = static_cast<uint16_t>(
+            1U + phase_offset(i, entry.period));
+        slot_table[i].active    = true;
+        return static_cast<int16_t>(i);
+    }
+
+    return -1;
+}
+
+void telemetry_scheduler::remove(int16_t index)
+{
+    if (index >= 0 && static_cast<uint16_t>(index) < slot_count)
+        slot_table[index].active = false;
+}
+
+void telemetry_scheduler::set_period(int16_t index, uint16_t period)
+{
+    if (index < 0 || static_cast<uint16_t>(index) >= slot_count || period == 0)
+        return;
+
+    telemetry_slot& s = slot_table[index];
+
+    s.entry.period = period;
+    if (s.countdown > period)
+        s.countdown = period;
+}
+
+bool telemetry_scheduler::emit(const telemetry_entry& e, bool& suppressed)
+{
+    const void* values = e.source;
+    uint16_t    count  = e.count;
+
+    suppressed = false;
+
+    if (e.getter)
+        values = e.getter(e.ctx, count);
+
+    if (e.deadband && e.type != data_type::NONE)
+    {
+        deadband_entry& db   = *e.deadband;
+        uint32_t        sent = db.sent;
+        bool            ok;
+
+        if (e.type == data_type::INT)
+            ok = filter.send_int(db, e.path, static_cast<const int32_t*>(values), count, counters.ticks);
+        else if (e.type == data_type::FLOAT)
+            ok = filter.send_float(db, e.path, static_cast<const float*>(values), count, counters.ticks);
+        else
+            ok = filter.send_string(db, e.path, static_cast<const char* const*>(values), count, counters.ticks);
+
+        suppressed = ok && db.sent == sent;
+        return ok;
+    }
+
+    switch (e.type)
+    {
+        case data_type::INT:
+            return tx.send_int(e.path, static_cast<const int32_t*>(values), count);
+
+        case data_type::FLOAT:
+            return tx.send_float(e.path, static_cast<const float*>(values), count);
+
+        case data_type::STRING:
+            return tx.send_string(e.path, static_cast<const char* const*>(values), count);
+
+        default:
+            return tx.send_trigger(e.path);
+    }
+}
+
+uint16_t telemetry_scheduler::tick()
+{
+    uint16_t sent  = 0;
+    uint32_t start = tx.queued_bytes();
+
+    counters.ticks++;
+    tx.begin_burst();
+
+    for (uint16_t i = 0; i < slot_count; i++)
+    {
+        telemetry_slot& s = slot_table[i];
+
+        if (!s.active || --s.countdown)
+            continue;
+
+        s.countdown = s.entry.period;
+
+        bool suppressed;
+
+        if (!emit(s.entry, suppressed))
+        {
+            counters.frames_dropped++;
+        }
+        else if (suppressed)
+        {
+            counters.frames_suppressed++;
+        }
+        else
+        {
+            sent++;
+            counters.frames_sent++;
+        }
+    }
+
+    tx.end_burst();
+
+    // Includes what a failed direct-mode frame left in the queue
+    uint32_t bytes = tx.queued_bytes() - start;
+
+    counters.bytes_sent += bytes;
+    if (bytes > counters.max_burst_bytes)
+        counters.max_burst_bytes = bytes > 0xFFFFU ? 0xFFFFU : (uint16_t)bytes;
+
+    if (sent)
+    {
+        counters.bursts++;
+        if (sent > counters.max_burst)
+            counters.max_burst = sent;
+    }
+
+    return sent;
+}
@@ -0,0 +1,151 @@
+#include "core/tx_lanes.h"
+
+
+// Per-frame lane header: length (LE16) + enqueue timestamp (LE16)
+static const uint16_t LANE_HEADER_SIZE = 4;
+
+
+tx_lanes::tx_lanes(lane_policy policy, tx_clock_fn clock)
+    : count(0),
+      policy(policy),
+      clock(clock),
+      current(-1),
+      remaining(0)
+{
+}
+
+int8_t tx_lanes::add_lane(mp_ring_buffer& queue, uint8_t weight)
+{
+    if (count >= TX_LANES_MAX)
+        return -1;
+
+    lane& l = lanes[count];
+
+    l.queue       = &queue;
+    l.weight      = weight ? weight : 1;
+    l.credit      = 0;
+    l.queued.store(0);
+    l.sent        = 0;
+    l.dropped.store(0);
+    l.frames_sent = 0;
+    l.wait_total  = 0;
+    l.wait_max    = 0;
+
+    return static_cast<int8_t>(count++);
+}
+
+bool tx_lanes::publish(uint8_t lane_idx, const uint8_t* frame, uint16_t len)
+{
+    if (lane_idx >= count || len == 0)
+        return false;
+
+    lane& l = lanes[lane_idx];
+    mp_ring_buffer::reservation r;
+
+    if (len > 0xFFFFU - LANE_HEADER_SIZE ||
+        !l.queue->reserve(static_cast<uint16_t>(len + LANE_HEADER_SIZE), r))
+    {
+        l.dropped.fetch_add(1);
+        return false;
+    }
+
+    uint16_t stamp = clock ? static_cast<uint16_t>(clock()) : 0;
+
+    l.queue->put(r, 0, static_cast<uint8_t>(len));
+    l.queue->put(r, 1, static_cast<uint8_t>(len >> 8));
+    l.queue->put(r, 2, static_cast<uint8_t>(stamp));
+    l.queue->put(r, 3, static_cast<uint8_t>(stamp >> 8));
+    l.queue->write(r, LANE_HEADER_SIZE, frame, len);
+
+    l.queued.fetch_add(1);
+    l.queue->commit(r);
+    return true;
+}
+
+int8_t tx_lanes::select_lane()
+{
+    if (policy == lane_policy::STRICT)
+    {
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (lanes[i].queue->count())
+                return static_cast<int8_t>(i);
+        }
+        return -1;
+    }
+
+    // Smooth weighted round-robin over non-empty lanes
+    int8_t  best  = -1;
+    int16_t total = 0;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (!lanes[i].queue->count())
+            continue;
+
+        lanes[i].credit = static_cast<int16_t>(lanes[i].credit + lanes[i].weight);
+        total = static_cast<int16_t>(total + lanes[i].weight);
+
+        if (best < 0 || lanes[i].credit > lanes[best].credit)
+            best = static_cast<int8_t>(i);
+    }
+
+    if (best >= 0)
+        lanes[best].credit = static_cast<int16_t>(lanes[best].credit - total);
+
+    return best;
+}
+
+bool tx_lanes::pop(uint8_t& out)
+{
+    if (remaining == 0)
+    {
+        current = select_lane();
+        if (current < 0)
+            return false;
+
+        lane& l = lanes[current];
+        uint8_t hdr[LANE_HEADER_SIZE];
+
+        // Header and frame are committed together; the pops cannot fail.
+        for (uint16_t i = 0; i < LANE_HEADER_SIZE; i++)
+            l.queue->pop(hdr[i]);
+
+        remaining = static_cast<uint16_t>(hdr[0] | (hdr[1] << 8));
+
+        if (clock)
+        {
+            uint16_t stamp = static_cast<uint16_t>(hdr[2] | (hdr[3] << 8));
+            uint16_t wait  = static_cast<uint16_t>(static_cast<uint16_t>(clock()) - stamp);
+
+            l.wait_total += wait;
+            if (wait > l.wait_max)
+                l.wait_max = wait;
+        }
+
+        l.sent++;
+        l.frames_sent++;
+    }
+
+    lanes[current].queue->pop(out);
+    remaining--;
+    return true;
+}
+
+void tx_lanes::get_stats(uint8_t lane_idx, tx_lane_stats& out) const
+{
+    if (lane_idx >= count)
+    {
+        out = tx_lane_stats();
+        return;
+    }
+
+    const lane& l = lanes[lane_idx];
+
+    out.depth_bytes    = l.queue->count();
+    out.depth_frames   = static_cast<uint16_t>(l.queued.load() - l.sent);
+    out.frames_sent    = l.frames_sent;
+    out.frames_dropped = l.dropped.load();
+    out.wait_total     = l.wait_total;
+    out.wait_max       = l.wait_max;
+}
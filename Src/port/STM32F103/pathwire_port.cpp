@@ -1,14 +1,13 @@
 #include "port/STM32F103/pathwire_port.h"
-#include "core/tx_notifier.h"
 
 extern "C" void usart2_tx_kick(void);
 
-static void tx_ready_handler()
+static void usart2_tx_ready(void*)
 {
     usart2_tx_kick();
 }
 
-void pathwire_port_init()
+void pathwire_port_init(cmnd_sender& sender)
 {
-    register_tx_notifier(tx_ready_handler);
+    sender.set_tx_notifier(usart2_tx_ready, nullptr);
 }
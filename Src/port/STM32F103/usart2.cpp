@@ -9,6 +9,8 @@ ring_buffer<uint8_t> usart2_rx_buffer(
     sizeof(usart2_rx_storage)
 );
 
+volatile uint32_t usart2_rx_overruns = 0;
+
 /* -------- TX BUFFER -------- */
 uint8_t usart2_tx_storage[512];
 ring_buffer<uint8_t> usart2_tx_buffer(
@@ -16,6 +18,30 @@ ring_buffer<uint8_t> usart2_tx_buffer(
     sizeof(usart2_tx_storage)
 );
 
+/* -------- OPTIONAL MULTI-PRODUCER TX QUEUE -------- */
+static mp_ring_buffer* usart2_tx_queue = nullptr;
+
+void usart2_attach_tx_queue(mp_ring_buffer* queue)
+{
+    usart2_tx_queue = queue;
+}
+
+/* -------- OPTIONAL TX LANES -------- */
+static tx_lanes* usart2_tx_lanes = nullptr;
+
+void usart2_attach_tx_lanes(tx_lanes* lanes)
+{
+    usart2_tx_lanes = lanes;
+}
+
+/* -------- OPTIONAL RX FLOW CONTROL -------- */
+static flow_control* usart2_rx_flow = nullptr;
+
+void usart2_attach_rx_flow(flow_control* flow)
+{
+    usart2_rx_flow = flow;
+}
+
 usart2::usart2(uint32_t baudrate) : baudrate(baudrate) {}
 
 void usart2::init()
@@ -72,13 +98,21 @@ extern "C" void USART2_IRQHandler(void)
     if (USART2->SR & USART_SR_RXNE)
     {
         uint8_t data = (uint8_t)USART2->DR;
-        usart2_rx_buffer.push(data);
+
+        if (!usart2_rx_buffer.push(data))
+            usart2_rx_overruns++;
+
+        if (usart2_rx_flow)
+            usart2_rx_flow->on_rx();
     }
 
     if (USART2->SR & USART_SR_TXE)
     {
         uint8_t byte;
-        if (usart2_tx_buffer.pop(byte))
+        bool have = usart2_tx_lanes ? usart2_tx_lanes->pop(byte)
+                  : usart2_tx_queue ? usart2_tx_queue->pop(byte)
+                                    : usart2_tx_buffer.pop(byte);
+        if (have)
         {
             USART2->DR = byte;
         }
@@ -0,0 +1,136 @@
+#include "port/linux/epoll_reactor.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+
+/* Events handled per epoll_wait() call */
+#define REACTOR_BATCH 16
+
+epoll_reactor::epoll_reactor()
+    : epfd(epoll_create1(EPOLL_CLOEXEC)),
+      wakefd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      running(false)
+{
+    for (int i = 0; i < REACTOR_MAX_SOURCES; i++)
+        sources[i] = source{ -1, nullptr, nullptr };
+
+    if (valid())
+    {
+        epoll_event ev {};
+        ev.events   = EPOLLIN;
+        ev.data.ptr = nullptr;   // wake-up descriptor
+        epoll_ctl(epfd, EPOLL_CTL_ADD, wakefd, &ev);
+    }
+}
+
+epoll_reactor::~epoll_reactor()
+{
+    if (wakefd >= 0) close(wakefd);
+    if (epfd >= 0)   close(epfd);
+}
+
+epoll_reactor::source* epoll_reactor::find(int fd)
+{
+    for (int i = 0; i < REACTOR_MAX_SOURCES; i++)
+    {
+        if (sources[i].fd == fd)
+            return &sources[i];
+    }
+    return nullptr;
+}
+
+bool epoll_reactor::add(int fd, uint32_t events, io_handler handler, void* ctx)
+{
+    if (!valid() || fd < 0 || handler == nullptr || find(fd))
+        return false;
+
+    source* s = find(-1);
+    if (s == nullptr)
+        return false;
+
+    epoll_event ev {};
+    ev.events   = events;
+    ev.data.ptr = s;
+
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0)
+        return false;
+
+    *s = source{ fd, handler, ctx };
+    return true;
+}
+
+bool epoll_reactor::set_events(int fd, uint32_t events)
+{
+    source* s = find(fd);
+    if (s == nullptr)
+        return false;
+
+    epoll_event ev {};
+    ev.events   = events;
+    ev.data.ptr = s;
+    return epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+bool epoll_reactor::remove(int fd)
+{
+    source* s = find(fd);
+    if (s == nullptr)
+        return false;
+
+    epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+    s->fd = -1;
+    return true;
+}
+
+int epoll_reactor::run_once(int timeout_ms)
+{
+    epoll_event ev[REACTOR_BATCH];
+
+    int n = epoll_wait(epfd, ev, REACTOR_BATCH, timeout_ms);
+    if (n < 0)
+        return (errno == EINTR) ? 0 : -1;
+
+    int handled = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        source* s = static_cast<source*>(ev[i].data.ptr);
+
+        if (s == nullptr)
+        {
+            uint64_t v;
+            while (read(wakefd, &v, sizeof(v)) > 0) {}
+            continue;
+        }
+
+        // A handler may have removed this or another source
+        if (s->fd < 0)
+            continue;
+
+        s->handler(s->ctx, ev[i].events);
+        handled++;
+    }
+
+    return handled;
+}
+
+void epoll_reactor::run()
+{
+    running = true;
+
+    while (running)
+    {
+        if (run_once(-1) < 0)
+            break;
+    }
+}
+
+void epoll_reactor::stop()
+{
+    running = false;
+
+    uint64_t one = 1;
+    if (write(wakefd, &one, sizeof(one)) < 0) {}
+}
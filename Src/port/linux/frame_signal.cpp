@@ -0,0 +1,110 @@
+#include "port/linux/frame_signal.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <errno.h>
+#include <unistd.h>
+
+frame_signal::frame_signal()
+    : efd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      pending(false),
+      reactor(nullptr),
+      ready_fn(nullptr),
+      ready_ctx(nullptr),
+      notified(0),
+      wakeups(0)
+{
+}
+
+frame_signal::~frame_signal()
+{
+    if (efd < 0)
+        return;
+
+    if (reactor)
+        reactor->remove(efd);
+    close(efd);
+}
+
+void frame_signal::attach(cmnd_parser& parser)
+{
+    parser.set_frame_notifier(notify, this);
+}
+
+bool frame_signal::attach(epoll_reactor& r, void (*handler)(void* ctx), void* ctx)
+{
+    if (efd < 0 || reactor)
+        return false;
+
+    ready_fn  = handler;
+    ready_ctx = ctx;
+
+    if (!r.add(efd, EPOLLIN, on_ready, this))
+        return false;
+
+    reactor = &r;
+    return true;
+}
+
+void frame_signal::notify(void* ctx)
+{
+    frame_signal& s = *static_cast<frame_signal*>(ctx);
+
+    s.notified.fetch_add(1, std::memory_order_relaxed);
+
+    if (!s.pending.exchange(true) && s.efd >= 0)
+    {
+        uint64_t one = 1;
+        if (write(s.efd, &one, sizeof(one)) < 0) {}
+        s.wakeups.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void frame_signal::clear()
+{
+    uint64_t v;
+
+    while (read(efd, &v, sizeof(v)) > 0) {}
+
+    // Cleared before the queue is drained, so a frame queued from now on signals again
+    pending.exchange(false);
+}
+
+bool frame_signal::wait(int timeout_ms)
+{
+    if (efd < 0)
+        return false;
+
+    pollfd p = { efd, POLLIN, 0 };
+    int    n;
+
+    do
+        n = poll(&p, 1, timeout_ms);
+    while (n < 0 && errno == EINTR);
+
+    if (n <= 0 || !(p.revents & POLLIN))
+        return false;
+
+    clear();
+    return true;
+}
+
+void frame_signal::on_ready(void* ctx, uint32_t)
+{
+    frame_signal& s = *static_cast<frame_signal*>(ctx);
+
+    s.clear();
+
+    if (s.ready_fn)
+        s.ready_fn(s.ready_ctx);
+}
+
+frame_signal_stats frame_signal::stats() const
+{
+    frame_signal_stats st;
+
+    st.notified = notified.load(std::memory_order_relaxed);
+    st.wakeups  = wakeups.load(std::memory_order_relaxed);
+    return st;
+}
@@ -0,0 +1,6 @@
+#include "port/linux/pathwire_port.h"
+
+void pathwire_port_init(serial_port& port, cmnd_sender& sender)
+{
+    sender.set_tx_notifier(serial_port::notify_tx, &port);
+}
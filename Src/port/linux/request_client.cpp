@@ -0,0 +1,342 @@
+#include "port/linux/request_client.h"
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+const char* request_reply::string(uint16_t i) const
+{
+    if (type != data_type::STRING || i >= count)
+        return nullptr;
+
+    const char* s = reinterpret_cast<const char*>(data);
+
+    while (i--)
+        s += strlen(s) + 1;
+    return s;
+}
+
+request_op::request_op(request_client& c, const char* p, data_type type,
+                       const void* values, uint16_t count, uint32_t timeout)
+    : client(&c),
+      path(p),
+      arg_type(type),
+      arg_count(count > MAX_CSV_ITEMS ? MAX_CSV_ITEMS : count),
+      timeout_ms(timeout),
+      id(0),
+      deadline_ns(0),
+      sent_ns(0),
+      next(nullptr),
+      waiter()
+{
+    if (arg_count)
+        memcpy(&args, values, arg_count * sizeof(int32_t));
+
+    result.status = request_status::TIMEOUT;
+    result.type   = data_type::NONE;
+    result.count  = 0;
+    result.rtt_ns = 0;
+}
+
+void request_op::await_suspend(std::coroutine_handle<> h)
+{
+    waiter = h;
+    client->submit(*this);
+}
+
+request_client::request_client(epoll_reactor& r, cmnd_executer& e, cmnd_sender& s)
+    : reactor(r),
+      executer(e),
+      sender(s),
+      timer_ns(0),
+      tx_blocked(false),
+      pending(0),
+      next_slot(0),
+      backlog_head(nullptr),
+      backlog_tail(nullptr),
+      counters()
+{
+    for (int i = 0; i < REQUEST_MAX_PENDING; i++)
+    {
+        slots[i]      = nullptr;
+        generation[i] = 0;
+    }
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (timer_fd >= 0 && !reactor.add(timer_fd, EPOLLIN, on_timer, this))
+    {
+        ::close(timer_fd);
+        timer_fd = -1;
+    }
+
+    executer.set_response_handler(on_response, this);
+}
+
+request_client::~request_client()
+{
+    executer.set_response_handler(nullptr, nullptr);
+
+    if (timer_fd >= 0)
+    {
+        reactor.remove(timer_fd);
+        ::close(timer_fd);
+    }
+}
+
+request_op request_client::request(const char* path, uint32_t timeout_ms)
+{
+    return request_op(*this, path, data_type::NONE, nullptr, 0, timeout_ms);
+}
+
+request_op request_client::request(const char* path, const int32_t* values, uint16_t count,
+                                   uint32_t timeout_ms)
+{
+    return request_op(*this, path, data_type::INT, values, count, timeout_ms);
+}
+
+request_op request_client::request(const char* path, const float* values, uint16_t count,
+                                   uint32_t timeout_ms)
+{
+    return request_op(*this, path, data_type::FLOAT, values, count, timeout_ms);
+}
+
+void request_client::submit(request_op& op)
+{
+    op.deadline_ns = now_ns() + (uint64_t)op.timeout_ms * 1000000ULL;
+
+    if (backlog_tail)
+        backlog_tail->next = &op;
+    else
+        backlog_head = &op;
+    backlog_tail = &op;
+
+    flush();
+
+    if (timer_ns == 0 || op.deadline_ns < timer_ns)
+        arm_timer(op.deadline_ns);
+}
+
+bool request_client::send(request_op& op)
+{
+    sender.tag_request(op.id);
+
+    switch (op.arg_type)
+    {
+    case data_type::INT:   return sender.send_int(op.path, op.args.i, op.arg_count);
+    case data_type::FLOAT: return sender.send_float(op.path, op.args.f, op.arg_count);
+    default:               return sender.send_trigger(op.path);
+    }
+}
+
+void request_client::flush()
+{
+    tx_blocked = false;
+
+    while (backlog_head && pending < REQUEST_MAX_PENDING)
+    {
+        // Free slot; its generation makes the ID of every use unique
+        while (slots[next_slot])
+            next_slot = (uint16_t)((next_slot + 1U) % REQUEST_MAX_PENDING);
+
+        request_op& op = *backlog_head;
+        uint16_t    k  = next_slot;
+
+        op.id = (uint16_t)(generation[k] * REQUEST_MAX_PENDING + k);
+
+        if (!send(op))
+        {
+            counters.tx_full++;
+            tx_blocked = true;
+
+            uint64_t retry = now_ns() + REQUEST_RETRY_US * 1000ULL;
+            if (timer_ns == 0 || retry < timer_ns)
+                arm_timer(retry);
+            return;
+        }
+
+        backlog_head = op.next;
+        if (backlog_head == nullptr)
+            backlog_tail = nullptr;
+
+        op.next    = nullptr;
+        op.sent_ns = now_ns();
+        slots[k]   = &op;
+        pending++;
+        counters.sent++;
+    }
+}
+
+void request_client::on_response(void* ctx, uint16_t id, data_type type, const void* data, uint16_t count)
+{
+    request_client& c  = *static_cast<request_client*>(ctx);
+    uint16_t        k  = (uint16_t)(id % REQUEST_MAX_PENDING);
+    request_op*     op = c.slots[k];
+
+    if (op == nullptr || op->id != id)
+    {
+        c.counters.stale++;
+        return;
+    }
+
+    request_reply& r = op->result;
+    uint32_t       n = 0;
+
+    r.status = request_status::OK;
+    r.type   = type;
+    r.count  = count;
+    r.rtt_ns = now_ns() - op->sent_ns;
+
+    if (type == data_type::INT || type == data_type::FLOAT)
+    {
+        n = (uint32_t)count * 4U;
+
+        if (n <= REQUEST_MAX_REPLY)
+            memcpy(r.data, data, n);
+    }
+    else if (type == data_type::STRING)
+    {
+        const char* const* s = static_cast<const char* const*>(data);
+
+        for (uint16_t i = 0; i < count && n <= REQUEST_MAX_REPLY; i++)
+        {
+            uint32_t len = (uint32_t)strlen(s[i]) + 1U;
+
+            if (n + len <= REQUEST_MAX_REPLY)
+                memcpy(&r.data[n], s[i], len);
+            n += len;
+        }
+    }
+
+    if (n > REQUEST_MAX_REPLY)
+    {
+        r.status = request_status::OVERSIZE;
+        r.count  = 0;
+    }
+
+    c.slots[k] = nullptr;
+    c.generation[k]++;
+    c.pending--;
+    c.counters.replies++;
+
+    // The freed slot goes to the next waiting request before the
+    // resumed coroutine can queue new ones
+    c.flush();
+
+    std::coroutine_handle<> h = op->waiter;
+    h.resume();   // may end the coroutine and destroy *op
+}
+
+void request_client::expire()
+{
+    // Resuming a coroutine may add or complete requests: rescan each time
+    for (;;)
+    {
+        uint64_t    now = now_ns();
+        request_op* op  = nullptr;
+
+        for (int k = 0; k < REQUEST_MAX_PENDING && op == nullptr; k++)
+        {
+            if (slots[k] && slots[k]->deadline_ns <= now)
+            {
+                op       = slots[k];
+                slots[k] = nullptr;
+                generation[k]++;
+                pending--;
+            }
+        }
+
+        if (op == nullptr)
+        {
+            // Unsent requests are in deadline order only per timeout;
+            // check them all
+            request_op* prev = nullptr;
+
+            for (request_op* b = backlog_head; b; prev = b, b = b->next)
+            {
+                if (b->deadline_ns > now)
+                    continue;
+
+                if (prev)
+                    prev->next = b->next;
+                else
+                    backlog_head = b->next;
+                if (backlog_tail == b)
+                    backlog_tail = prev;
+
+                op = b;
+                break;
+            }
+        }
+
+        if (op == nullptr)
+            return;
+
+        op->result.status = request_status::TIMEOUT;
+        counters.timeouts++;
+
+        std::coroutine_handle<> h = op->waiter;
+        h.resume();
+    }
+}
+
+void request_client::arm_timer(uint64_t at_ns)
+{
+    itimerspec its = {};
+
+    its.it_value.tv_sec  = (time_t)(at_ns / 1000000000ULL);
+    its.it_value.tv_nsec = (long)(at_ns % 1000000000ULL);
+
+    if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, nullptr) == 0)
+        timer_ns = at_ns;
+}
+
+void request_client::rearm()
+{
+    uint64_t next = 0;
+
+    for (int k = 0; k < REQUEST_MAX_PENDING; k++)
+    {
+        if (slots[k] && (next == 0 || slots[k]->deadline_ns < next))
+            next = slots[k]->deadline_ns;
+    }
+
+    for (request_op* b = backlog_head; b; b = b->next)
+    {
+        if (next == 0 || b->deadline_ns < next)
+            next = b->deadline_ns;
+    }
+
+    if (tx_blocked)
+    {
+        uint64_t retry = now_ns() + REQUEST_RETRY_US * 1000ULL;
+        if (next == 0 || retry < next)
+            next = retry;
+    }
+
+    timer_ns = 0;
+    if (next)
+        arm_timer(next);
+}
+
+void request_client::on_timer(void* ctx, uint32_t)
+{
+    request_client& c = *static_cast<request_client*>(ctx);
+    uint64_t        v;
+
+    while (read(c.timer_fd, &v, sizeof(v)) > 0) {}
+
+    c.timer_ns = 0;
+    c.expire();
+    c.flush();
+    c.rearm();
+}
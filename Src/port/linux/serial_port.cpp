@@ -0,0 +1,337 @@
+#include "port/linux/serial_port.h"
+
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+static bool baud_constant(uint32_t baudrate, speed_t& out)
+{
+    static const struct { uint32_t rate; speed_t code; } rates[] = {
+        { 9600, B9600 },       { 19200, B19200 },     { 38400, B38400 },
+        { 57600, B57600 },     { 115200, B115200 },   { 230400, B230400 },
+        { 460800, B460800 },   { 921600, B921600 },   { 1000000, B1000000 },
+        { 2000000, B2000000 }, { 3000000, B3000000 }, { 4000000, B4000000 },
+    };
+
+    for (const auto& r : rates)
+    {
+        if (r.rate == baudrate)
+        {
+            out = r.code;
+            return true;
+        }
+    }
+    return false;
+}
+
+serial_port::serial_port(
+    epoll_reactor& reactor,
+    ring_buffer<uint8_t>& rx,
+    ring_buffer<uint8_t>& tx)
+    : reactor(reactor),
+      rx_queue(rx),
+      tx_queue(tx),
+      lanes(nullptr),
+      port_fd(-1),
+      is_socket(false),
+      rx_handler(nullptr),
+      rx_ctx(nullptr),
+      tx_armed(false),
+      rx_paused(false),
+      chunk_len(0),
+      chunk_pos(0),
+      counters()
+{
+}
+
+serial_port::~serial_port()
+{
+    close();
+}
+
+bool serial_port::open(const char* device, uint32_t baudrate)
+{
+    int fd = ::open(device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    if (!attach(fd))
+        return false;
+
+    if (!configure(baudrate))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool serial_port::attach(int fd)
+{
+    close();
+
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0 ||
+        !reactor.add(fd, EPOLLIN, on_event, this))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    struct stat st;
+
+    port_fd   = fd;
+    is_socket = fstat(fd, &st) == 0 && S_ISSOCK(st.st_mode);
+    tx_armed  = false;
+    rx_paused = false;
+
+    // Frames queued before the port existed
+    if (!tx_queue.empty())
+        arm_tx();
+    return true;
+}
+
+bool serial_port::configure(uint32_t baudrate)
+{
+    termios tio;
+
+    if (port_fd < 0 || tcgetattr(port_fd, &tio) != 0)
+        return false;
+
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tio.c_cc[VMIN]  = 0;
+    tio.c_cc[VTIME] = 0;
+
+    if (baudrate)
+    {
+        speed_t speed;
+        if (!baud_constant(baudrate, speed))
+            return false;
+
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+    }
+
+    return tcsetattr(port_fd, TCSANOW, &tio) == 0;
+}
+
+void serial_port::close()
+{
+    if (port_fd < 0)
+        return;
+
+    reactor.remove(port_fd);
+    ::close(port_fd);
+    port_fd = -1;
+}
+
+int serial_port::release()
+{
+    int fd = port_fd;
+
+    if (fd >= 0)
+    {
+        reactor.remove(fd);
+        port_fd = -1;
+    }
+    return fd;
+}
+
+void serial_port::set_rx_handler(rx_ready_fn fn, void* ctx)
+{
+    rx_handler = fn;
+    rx_ctx     = ctx;
+}
+
+void serial_port::attach_tx_lanes(tx_lanes* l)
+{
+    lanes = l;
+}
+
+void serial_port::update_events()
+{
+    uint32_t events = (rx_paused ? 0U : (uint32_t)EPOLLIN) |
+                      (tx_armed  ? (uint32_t)EPOLLOUT : 0U);
+    reactor.set_events(port_fd, events);
+}
+
+void serial_port::arm_tx()
+{
+    if (port_fd >= 0 && !tx_armed.exchange(true))
+        update_events();
+}
+
+void serial_port::notify_tx(void* ctx)
+{
+    static_cast<serial_port*>(ctx)->arm_tx();
+}
+
+void serial_port::resume_rx()
+{
+    if (port_fd >= 0 && rx_paused.exchange(false))
+        update_events();
+}
+
+void serial_port::on_event(void* ctx, uint32_t events)
+{
+    serial_port* self = static_cast<serial_port*>(ctx);
+
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+        self->on_readable();
+
+    if ((events & EPOLLOUT) && self->port_fd >= 0)
+        self->on_writable();
+}
+
+void serial_port::on_readable()
+{
+    bool got = false;
+
+    for (;;)
+    {
+        iovec    iov[2];
+        uint8_t* a;
+        uint8_t* b;
+        uint16_t alen, blen;
+
+        if (rx_queue.writable(a, alen, b, blen) == 0)
+        {
+            // Let the parser drain the ring first; reading resumes on resume_rx()
+            rx_paused = true;
+            update_events();
+            counters.rx_stalls++;
+            break;
+        }
+
+        iov[0] = iovec{ a, alen };
+        iov[1] = iovec{ b, blen };
+
+        ssize_t n = readv(port_fd, iov, blen ? 2 : 1);
+
+        if (n < 0 && (errno == EAGAIN || errno == EINTR))
+            break;
+
+        if (n <= 0)
+        {
+            // Peer closed the socket, or EIO on a pty whose other end
+            // is gone: a hung-up descriptor would keep reporting EPOLLHUP
+            counters.hangups++;
+            close();
+            break;
+        }
+
+        rx_queue.produce((uint16_t)n);
+        counters.rx_bytes += (uint64_t)n;
+        counters.reads++;
+        got = true;
+
+        if ((size_t)n < (size_t)alen + blen)
+            break;  // kernel buffer drained
+    }
+
+    if (got && rx_handler)
+        rx_handler(rx_ctx);
+}
+
+ssize_t serial_port::write_iov(iovec* iov, int count)
+{
+    if (!is_socket)
+        return writev(port_fd, iov, count);
+
+    // A closed peer must show up as EPIPE, not as SIGPIPE
+    msghdr msg {};
+    msg.msg_iov    = iov;
+    msg.msg_iovlen = (size_t)count;
+    return sendmsg(port_fd, &msg, MSG_NOSIGNAL);
+}
+
+bool serial_port::write_ring()
+{
+    for (;;)
+    {
+        uint8_t* a;
+        uint8_t* b;
+        uint16_t alen, blen;
+
+        if (tx_queue.readable(a, alen, b, blen) == 0)
+            return true;
+
+        iovec iov[2] = { { a, alen }, { b, blen } };
+
+        ssize_t n = write_iov(iov, blen ? 2 : 1);
+
+        if (n <= 0)
+            return false;   // EAGAIN: wait for the next EPOLLOUT
+
+        tx_queue.consume((uint16_t)n);
+        counters.tx_bytes += (uint64_t)n;
+        counters.writes++;
+    }
+}
+
+bool serial_port::write_lanes()
+{
+    for (;;)
+    {
+        if (chunk_pos == chunk_len)
+        {
+            chunk_pos = 0;
+            chunk_len = 0;
+
+            while (chunk_len < SERIAL_TX_CHUNK && lanes->pop(chunk[chunk_len]))
+                chunk_len++;
+
+            if (chunk_len == 0)
+                return true;
+        }
+
+        iovec   iov = { &chunk[chunk_pos], (size_t)(chunk_len - chunk_pos) };
+        ssize_t n   = write_iov(&iov, 1);
+
+        if (n <= 0)
+            return false;
+
+        chunk_pos = (uint16_t)(chunk_pos + n);
+        counters.tx_bytes += (uint64_t)n;
+        counters.writes++;
+    }
+}
+
+void serial_port::on_writable()
+{
+    bool drained = lanes ? write_lanes() : write_ring();
+
+    if (!drained)
+        return;
+
+    tx_armed = false;
+    update_events();
+
+    // A frame queued between the last write and the disarm saw
+    // tx_armed still set and did not arm again
+    bool pending;
+
+    if (lanes)
+    {
+        chunk_pos = 0;
+        chunk_len = lanes->pop(chunk[0]) ? 1 : 0;
+        pending   = chunk_len != 0;
+    }
+    else
+        pending = !tx_queue.empty();
+
+    // Re-applied unconditionally: an arm_tx() racing with the disarm
+    // above may have set EPOLLOUT before it was cleared again
+    if (pending)
+    {
+        tx_armed = true;
+        update_events();
+    }
+}
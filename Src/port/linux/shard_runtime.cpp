@@ -0,0 +1,555 @@
+#include "port/linux/shard_runtime.h"
+
+#include "core/cmnd_parser.h"
+#include "core/cmnd_executer.h"
+#include "core/cmnd_sender.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sched.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <new>
+
+static_assert((SHARD_MAILBOX_SIZE & (SHARD_MAILBOX_SIZE - 1)) == 0,
+              "SHARD_MAILBOX_SIZE must be a power of two");
+
+/* Mailbox records start on 16-byte boundaries */
+#define RECORD_ALIGN 16U
+
+static thread_local int this_shard = -1;
+
+static uint64_t now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Counter with a single writer: no locked instruction on the hot path */
+template<typename T>
+static void bump(std::atomic<T>& c, T d)
+{
+    c.store(c.load(std::memory_order_relaxed) + d, std::memory_order_relaxed);
+}
+
+static uint32_t record_size(uint16_t len)
+{
+    return (uint32_t)(16U + len + RECORD_ALIGN - 1U) & ~(RECORD_ALIGN - 1U);
+}
+
+shard_runtime::shard_runtime()
+    : shards_started(0),
+      link_count(0)
+{
+    for (int i = 0; i < SHARD_MAX_SHARDS; i++)
+    {
+        shard& s = shards[i];
+
+        s.runtime     = this;
+        s.index       = i;
+        s.cpu         = -1;
+        s.started_ns  = 0;
+        s.reactor     = nullptr;
+        s.wake_fd     = -1;
+        s.wake_pending = false;
+        s.adopt       = false;
+        s.running     = false;
+        s.owned_count = 0;
+        s.frames      = 0;
+        s.tasks       = 0;
+        s.links       = 0;
+        s.mailbox_full = 0;
+    }
+
+    for (int i = 0; i < SHARD_MAX_LINKS; i++)
+    {
+        slots[i].fd    = -1;
+        slots[i].owner = -1;
+        slots[i].adopt = false;
+        slots[i].port  = nullptr;
+    }
+
+    for (int p = 0; p <= SHARD_MAX_SHARDS; p++)
+    {
+        for (int c = 0; c < SHARD_MAX_SHARDS; c++)
+        {
+            mailboxes[p][c].head = 0;
+            mailboxes[p][c].tail = 0;
+        }
+    }
+}
+
+shard_runtime::~shard_runtime()
+{
+    stop();
+}
+
+int shard_runtime::current_shard()
+{
+    return this_shard;
+}
+
+bool shard_runtime::start(int count, const int* cpus)
+{
+    if (shards_started || count < 1 || count > SHARD_MAX_SHARDS)
+        return false;
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1)
+        cores = 1;
+
+    for (int i = 0; i < count; i++)
+    {
+        shard& s = shards[i];
+
+        s.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (s.wake_fd < 0)
+            break;
+
+        s.cpu        = cpus ? cpus[i] : (int)(i % cores);
+        s.running    = true;
+        s.started_ns = now_ns();
+
+        if (pthread_create(&s.thread, nullptr, shard_main, &s) != 0)
+        {
+            close(s.wake_fd);
+            s.wake_fd = -1;
+            s.running = false;
+            break;
+        }
+        shards_started++;
+    }
+
+    if (shards_started < count)
+    {
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void shard_runtime::stop()
+{
+    for (int i = 0; i < shards_started; i++)
+    {
+        shards[i].running = false;
+        wake(i);
+    }
+
+    for (int i = 0; i < shards_started; i++)
+    {
+        pthread_join(shards[i].thread, nullptr);
+        close(shards[i].wake_fd);
+        shards[i].wake_fd = -1;
+    }
+
+    shards_started = 0;
+}
+
+void* shard_runtime::shard_main(void* arg)
+{
+    shard* s = static_cast<shard*>(arg);
+    s->runtime->run(*s);
+    return nullptr;
+}
+
+void shard_runtime::run(shard& s)
+{
+    this_shard = s.index;
+
+    if (s.cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(s.cpu, &set);
+
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+            s.cpu = -1;   // e.g. outside the allowed cpuset; runs unpinned
+    }
+
+    epoll_reactor reactor;
+    s.reactor = &reactor;
+
+    if (reactor.add(s.wake_fd, EPOLLIN, on_wake, &s))
+    {
+        on_wake(&s, 0);   // links and tasks queued before the loop ran
+
+        while (s.running.load(std::memory_order_relaxed))
+        {
+            if (reactor.run_once(-1) < 0)
+                break;
+
+            // Replies and posted frames queued during this iteration
+            for (uint16_t i = 0; i < s.owned_count; i++)
+            {
+                link_slot& l = slots[s.owned[i]];
+                if (!l.link.tx->empty())
+                    l.port->arm_tx();
+            }
+        }
+    }
+
+    for (uint16_t i = 0; i < s.owned_count; i++)
+    {
+        link_slot& l = slots[s.owned[i]];
+        l.port->~serial_port();   // closes the descriptor
+        l.port = nullptr;
+    }
+    s.owned_count = 0;
+
+    // Links handed over but never opened
+    for (int i = 0; i < link_count.load(); i++)
+    {
+        if (slots[i].owner.load() == s.index && slots[i].adopt.exchange(false))
+        {
+            close(slots[i].fd);
+            slots[i].fd = -1;
+        }
+    }
+
+    s.reactor = nullptr;
+}
+
+void shard_runtime::wake(int to)
+{
+    shard& s = shards[to];
+
+    if (!s.wake_pending.exchange(true) && s.wake_fd >= 0)
+    {
+        uint64_t one = 1;
+        if (write(s.wake_fd, &one, sizeof(one)) < 0) {}
+    }
+}
+
+void shard_runtime::on_wake(void* ctx, uint32_t)
+{
+    shard&   s = *static_cast<shard*>(ctx);
+    uint64_t v;
+
+    while (read(s.wake_fd, &v, sizeof(v)) > 0) {}
+
+    // Cleared before looking, so a producer that posts now signals again
+    s.wake_pending = false;
+
+    if (s.adopt.exchange(false))
+        s.runtime->adopt(s);
+
+    s.runtime->drain(s);
+}
+
+void shard_runtime::adopt(shard& s)
+{
+    int count = link_count.load(std::memory_order_acquire);
+
+    for (int i = 0; i < count; i++)
+    {
+        link_slot& l = slots[i];
+
+        if (l.owner.load(std::memory_order_acquire) != s.index || !l.adopt.exchange(false))
+            continue;
+
+        l.port = new (l.port_mem) serial_port(*s.reactor, *l.link.rx, *l.link.tx);
+        l.port->set_rx_handler(on_link_rx, &l);
+
+        int fd = l.fd;
+        l.fd = -1;
+
+        if (!l.port->attach(fd))   // closes fd on failure
+        {
+            l.port->~serial_port();
+            l.port = nullptr;
+            l.owner.store(-1, std::memory_order_release);
+            continue;
+        }
+
+        s.owned[s.owned_count++] = (uint16_t)i;
+
+        // Bytes that arrived before the move
+        if (!l.link.rx->empty())
+            on_link_rx(&l);
+    }
+}
+
+void shard_runtime::on_link_rx(void* ctx)
+{
+    link_slot& l = *static_cast<link_slot*>(ctx);
+    uint64_t   t = now_ns();
+    uint64_t   n = 0;
+    bool       more;
+
+    do
+    {
+        l.link.parser->poll();
+        more = !l.link.frames->empty();
+
+        while (!l.link.frames->empty())
+        {
+            l.link.executer->poll();
+            n++;
+        }
+    } while (more);
+
+    l.port->resume_rx();
+
+    bump<uint64_t>(l.busy_ns, now_ns() - t);
+    bump<uint64_t>(l.frames, n);
+    bump<uint64_t>(l.runtime->shards[this_shard].frames, n);
+    l.rx_bytes.store(l.rx_base + l.port->stats().rx_bytes, std::memory_order_relaxed);
+}
+
+bool shard_runtime::send(int to, const message& m, const void* payload)
+{
+    int      producer = this_shard >= 0 ? this_shard : SHARD_MAX_SHARDS;
+    mailbox& b        = box(producer, to);
+    uint32_t need     = record_size(m.len);
+    uint32_t tail     = b.tail.load(std::memory_order_relaxed);
+    uint32_t head     = b.head.load(std::memory_order_acquire);
+    uint32_t pos      = tail & (SHARD_MAILBOX_SIZE - 1U);
+    uint32_t to_end   = SHARD_MAILBOX_SIZE - pos;
+
+    // A record never wraps; the rest of the buffer is padded instead
+    uint32_t total = need + (to_end < need ? to_end : 0U);
+
+    if (total > SHARD_MAILBOX_SIZE - (tail - head))
+    {
+        shards[to].mailbox_full.fetch_add(1U, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (to_end < need)
+    {
+        message pad = {};
+        pad.kind = op::PAD;
+        memcpy(&b.data[pos], &pad, sizeof(pad));
+        pos = 0;
+    }
+
+    memcpy(&b.data[pos], &m, sizeof(m));
+    if (m.len)
+        memcpy(&b.data[pos + 16U], payload, m.len);
+
+    b.tail.store(tail + total, std::memory_order_release);
+    wake(to);
+    return true;
+}
+
+void shard_runtime::drain(shard& s)
+{
+    for (int p = 0; p <= SHARD_MAX_SHARDS; p++)
+    {
+        mailbox& b    = box(p, s.index);
+        uint32_t head = b.head.load(std::memory_order_relaxed);
+        uint32_t tail = b.tail.load(std::memory_order_acquire);
+
+        if (head == tail)
+            continue;
+
+        while (head != tail)
+        {
+            uint32_t pos = head & (SHARD_MAILBOX_SIZE - 1U);
+            message  m;
+
+            memcpy(&m, &b.data[pos], sizeof(m));
+
+            if (m.kind == op::PAD)
+            {
+                head += SHARD_MAILBOX_SIZE - pos;
+                continue;
+            }
+
+            dispatch(s, m, &b.data[pos + 16U]);
+            head += record_size(m.len);
+        }
+
+        b.head.store(head, std::memory_order_release);
+    }
+}
+
+void shard_runtime::dispatch(shard& s, const message& m, const void* payload)
+{
+    link_slot& l     = slots[m.link];
+    int        owner = l.owner.load(std::memory_order_acquire);
+
+    if (owner != s.index)
+    {
+        // Moved away after the message was posted: follow the link
+        if (owner >= 0)
+            send(owner, m, payload);
+        return;
+    }
+
+    if (m.kind == op::DETACH)
+    {
+        detach(s, m.link, m.arg);
+        return;
+    }
+
+    m.fn(l.link, payload, m.len);
+    bump<uint64_t>(s.tasks, 1U);
+}
+
+void shard_runtime::detach(shard& s, int link, int to)
+{
+    link_slot& l = slots[link];
+
+    if (l.port)
+    {
+        l.rx_base += l.port->stats().rx_bytes;
+        l.fd = l.port->release();
+        l.port->~serial_port();
+        l.port = nullptr;
+    }
+
+    for (uint16_t i = 0; i < s.owned_count; i++)
+    {
+        if (s.owned[i] == link)
+        {
+            s.owned[i] = s.owned[--s.owned_count];
+            break;
+        }
+    }
+
+    // Everything above happens-before the new owner's acquire of owner
+    l.adopt.store(true, std::memory_order_relaxed);
+    l.owner.store(to, std::memory_order_release);
+    shards[to].adopt.store(true, std::memory_order_release);
+    wake(to);
+}
+
+int shard_runtime::add_link(int fd, const shard_link& link, int shard)
+{
+    int id = link_count.load(std::memory_order_relaxed);
+
+    if (this_shard >= 0 || fd < 0 || shard < 0 || shard >= shards_started ||
+        id >= SHARD_MAX_LINKS ||
+        shards[shard].links.load() >= (uint32_t)(REACTOR_MAX_SOURCES - 1))
+        return -1;
+
+    link_slot& l = slots[id];
+
+    l.link     = link;
+    l.fd       = fd;
+    l.assigned = shard;
+    l.runtime  = this;
+    l.rx_base  = 0;
+    l.busy_ns  = 0;
+    l.frames   = 0;
+    l.rx_bytes = 0;
+    l.adopt.store(true, std::memory_order_relaxed);
+    l.owner.store(shard, std::memory_order_release);
+
+    link_count.store(id + 1, std::memory_order_release);
+    shards[shard].links.fetch_add(1U);
+    shards[shard].adopt.store(true, std::memory_order_release);
+    wake(shard);
+    return id;
+}
+
+bool shard_runtime::move_link(int link, int shard)
+{
+    if (this_shard >= 0 || link < 0 || link >= link_count.load() ||
+        shard < 0 || shard >= shards_started)
+        return false;
+
+    link_slot& l     = slots[link];
+    int        owner = l.owner.load(std::memory_order_acquire);
+
+    if (owner < 0)
+        return false;
+    if (l.assigned == shard)
+        return true;
+    if (shards[shard].links.load() >= (uint32_t)(REACTOR_MAX_SOURCES - 1))
+        return false;
+
+    // The current owner hands the link on; if an earlier move is still in
+    // transit, the message follows the link to the next owner
+    message m = {};
+    m.link = (uint16_t)link;
+    m.kind = op::DETACH;
+    m.arg  = (uint8_t)shard;
+
+    if (!send(owner, m, nullptr))
+        return false;
+
+    shards[l.assigned].links.fetch_sub(1U);
+    shards[shard].links.fetch_add(1U);
+    l.assigned = shard;
+    return true;
+}
+
+bool shard_runtime::post(int link, shard_task_fn fn, const void* payload, uint16_t len)
+{
+    if (link < 0 || link >= link_count.load(std::memory_order_acquire) ||
+        fn == nullptr || len > SHARD_MAX_PAYLOAD)
+        return false;
+
+    int owner = slots[link].owner.load(std::memory_order_acquire);
+
+    if (owner < 0)
+        return false;
+
+    if (owner == this_shard)
+    {
+        fn(slots[link].link, payload, len);
+        bump<uint64_t>(shards[owner].tasks, 1U);
+        return true;
+    }
+
+    message m = {};
+    m.fn   = fn;
+    m.link = (uint16_t)link;
+    m.len  = len;
+    m.kind = op::TASK;
+
+    return send(owner, m, payload);
+}
+
+void shard_runtime::send_raw_task(const shard_link& link, const void* payload, uint16_t len)
+{
+    link.sender->send_raw(static_cast<const uint8_t*>(payload), len);
+}
+
+bool shard_runtime::post_raw(int link, const uint8_t* frame, uint16_t len)
+{
+    return post(link, send_raw_task, frame, len);
+}
+
+shard_load shard_runtime::load(int index) const
+{
+    const shard& s = shards[index];
+    shard_load   out = {};
+
+    out.frames       = s.frames.load(std::memory_order_relaxed);
+    out.tasks        = s.tasks.load(std::memory_order_relaxed);
+    out.links        = s.links.load(std::memory_order_relaxed);
+    out.mailbox_full = s.mailbox_full.load(std::memory_order_relaxed);
+    out.cpu          = s.cpu.load(std::memory_order_relaxed);
+
+    clockid_t clock;
+    timespec  ts;
+
+    if (index < shards_started &&
+        pthread_getcpuclockid(s.thread, &clock) == 0 &&
+        clock_gettime(clock, &ts) == 0)
+    {
+        uint64_t wall = now_ns() - s.started_ns;
+
+        out.busy_ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+        out.idle_ns = wall > out.busy_ns ? wall - out.busy_ns : 0;
+    }
+    return out;
+}
+
+shard_link_load shard_runtime::link_load(int link) const
+{
+    const link_slot& l   = slots[link];
+    shard_link_load  out = {};
+
+    out.busy_ns  = l.busy_ns.load(std::memory_order_relaxed);
+    out.frames   = l.frames.load(std::memory_order_relaxed);
+    out.rx_bytes = l.rx_bytes.load(std::memory_order_relaxed);
+    out.shard    = l.owner.load(std::memory_order_relaxed);
+    return out;
+}
@@ -0,0 +1,234 @@
+#include "port/linux/shm_link.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+
+#define SHM_LINK_MAGIC 0x4B4C5750U   // "PWLK"
+
+shm_link::shm_link(ring_buffer<uint8_t>& rx, ring_buffer<uint8_t>& tx)
+    : rx_queue(rx),
+      tx_queue(tx),
+      region(nullptr),
+      region_size(0),
+      out(nullptr),
+      in(nullptr),
+      out_data(nullptr),
+      in_data(nullptr),
+      mask(0),
+      owner(false),
+      shm_name(),
+      counters()
+{
+}
+
+shm_link::~shm_link()
+{
+    close();
+}
+
+bool shm_link::map(int fd, size_t size)
+{
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (p == MAP_FAILED)
+        return false;
+
+    region      = static_cast<header*>(p);
+    region_size = size;
+    return true;
+}
+
+bool shm_link::create(const char* name, uint32_t ring_size)
+{
+    if (region || ring_size < 2 || (ring_size & (ring_size - 1)) ||
+        strlen(name) >= sizeof(shm_name))
+        return false;
+
+    shm_unlink(name);   // left over from a crashed run
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        return false;
+
+    size_t size = sizeof(header) + 2U * ring_size;
+
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        ::close(fd);
+        shm_unlink(name);
+        return false;
+    }
+
+    if (!map(fd, size))
+    {
+        shm_unlink(name);
+        return false;
+    }
+
+    // ftruncate() zero-filled the object: both rings start empty
+    region->ring_size = ring_size;
+
+    out      = &region->ring[0];
+    in       = &region->ring[1];
+    out_data = reinterpret_cast<uint8_t*>(region + 1);
+    in_data  = out_data + ring_size;
+    mask     = ring_size - 1;
+    owner    = true;
+    strcpy(shm_name, name);
+
+    // Published last: open() refuses the object until it is complete
+    region->magic.store(SHM_LINK_MAGIC, std::memory_order_release);
+    return true;
+}
+
+bool shm_link::open(const char* name)
+{
+    if (region)
+        return false;
+
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(header) ||
+        !map(fd, (size_t)st.st_size))
+        return false;
+
+    // An object whose creator is still setting it up is refused; retry
+    bool ready = region->magic.load(std::memory_order_acquire) == SHM_LINK_MAGIC;
+
+    uint32_t ring_size = region->ring_size;
+
+    if (!ready || region_size != sizeof(header) + 2U * (size_t)ring_size)
+    {
+        close();
+        return false;
+    }
+
+    out      = &region->ring[1];
+    in       = &region->ring[0];
+    in_data  = reinterpret_cast<uint8_t*>(region + 1);
+    out_data = in_data + ring_size;
+    mask     = ring_size - 1;
+    owner    = false;
+    return true;
+}
+
+void shm_link::close()
+{
+    if (region == nullptr)
+        return;
+
+    munmap(region, region_size);
+    region = nullptr;
+
+    if (owner)
+        shm_unlink(shm_name);
+    owner = false;
+}
+
+uint32_t shm_link::send_pending()
+{
+    uint32_t head  = out->head.load(std::memory_order_relaxed);
+    uint32_t tail  = out->tail.load(std::memory_order_acquire);
+    uint32_t room  = (mask + 1) - (head - tail);
+    uint32_t moved = 0;
+
+    uint8_t* a;
+    uint8_t* b;
+    uint16_t alen, blen;
+
+    tx_queue.readable(a, alen, b, blen);
+
+    const uint8_t* src[2] = { a, b };
+    uint16_t       len[2] = { alen, blen };
+
+    for (int i = 0; i < 2 && room; i++)
+    {
+        uint32_t n = len[i] < room ? len[i] : room;
+
+        // The shared ring may wrap inside this region as well
+        uint32_t pos   = (head + moved) & mask;
+        uint32_t first = (mask + 1 - pos) < n ? (mask + 1 - pos) : n;
+
+        memcpy(out_data + pos, src[i], first);
+        memcpy(out_data, src[i] + first, n - first);
+
+        moved += n;
+        room  -= n;
+    }
+
+    if (moved == 0)
+        return 0;
+
+    out->head.store(head + moved, std::memory_order_release);
+    tx_queue.consume((uint16_t)moved);
+
+    counters.tx_bytes += moved;
+    if (room == 0 && !tx_queue.empty())
+        counters.tx_stalls++;
+
+    return moved;
+}
+
+uint32_t shm_link::receive_pending()
+{
+    uint32_t tail  = in->tail.load(std::memory_order_relaxed);
+    uint32_t head  = in->head.load(std::memory_order_acquire);
+    uint32_t avail = head - tail;
+    uint32_t moved = 0;
+
+    if (avail == 0)
+        return 0;
+
+    uint8_t* a;
+    uint8_t* b;
+    uint16_t alen, blen;
+
+    rx_queue.writable(a, alen, b, blen);
+
+    uint8_t* dst[2] = { a, b };
+    uint16_t len[2] = { alen, blen };
+
+    for (int i = 0; i < 2 && avail; i++)
+    {
+        uint32_t n = len[i] < avail ? len[i] : avail;
+
+        uint32_t pos   = (tail + moved) & mask;
+        uint32_t first = (mask + 1 - pos) < n ? (mask + 1 - pos) : n;
+
+        memcpy(dst[i], in_data + pos, first);
+        memcpy(dst[i] + first, in_data, n - first);
+
+        moved += n;
+        avail -= n;
+    }
+
+    if (moved == 0)
+    {
+        counters.rx_stalls++;
+        return 0;
+    }
+
+    in->tail.store(tail + moved, std::memory_order_release);
+    rx_queue.produce((uint16_t)moved);
+
+    counters.rx_bytes += moved;
+    if (avail)
+        counters.rx_stalls++;
+
+    return moved;
+}
+
+uint32_t shm_link::pump()
+{
+    if (region == nullptr)
+        return 0;
+
+    return send_pending() + receive_pending();
+}
@@ -0,0 +1,62 @@
+#include "port/linux/unix_socket.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <string.h>
+
+static bool make_address(const char* path, sockaddr_un& addr)
+{
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return false;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    return true;
+}
+
+int unix_listen(const char* path)
+{
+    sockaddr_un addr;
+    if (!make_address(path, addr))
+        return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    unlink(path);
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(fd, 1) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int unix_accept(int listen_fd)
+{
+    return accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+}
+
+int unix_connect(const char* path)
+{
+    sockaddr_un addr;
+    if (!make_address(path, addr))
+        return -1;
+
+    // Blocking connect: a local connect completes or fails immediately
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
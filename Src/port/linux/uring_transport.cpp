@@ -0,0 +1,462 @@
+#include "port/linux/uring_transport.h"
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+/* user_data: <link index> << 2 | <operation> */
+#define OP_READ   0U
+#define OP_WRITE  1U
+#define OP_WAKE   2U
+
+static uint32_t load_acquire(const uint32_t* p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(uint32_t* p, uint32_t v)
+{
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+uring_transport::uring_transport()
+    : ring_fd(-1),
+      wake_fd(eventfd(0, EFD_CLOEXEC)),
+      sq_head(nullptr),
+      sq_tail(nullptr),
+      sq_mask(nullptr),
+      sq_array(nullptr),
+      sqes(nullptr),
+      sq_entries(0),
+      sq_local(0),
+      sq_pending(0),
+      cq_head(nullptr),
+      cq_tail(nullptr),
+      cq_mask(nullptr),
+      cqes(nullptr),
+      sq_ring(MAP_FAILED),
+      sq_ring_size(0),
+      sqes_size(0),
+      running(false),
+      wake_posted(false),
+      wake_value(0),
+      started(false),
+      rx_stalled(false),
+      enter_count(0),
+      link_count(0),
+      links()
+{
+    io_uring_params p;
+    memset(&p, 0, sizeof(p));
+
+    int fd = (int)syscall(__NR_io_uring_setup, URING_QUEUE_DEPTH, &p);
+    if (fd < 0 || wake_fd < 0)
+    {
+        if (fd >= 0) close(fd);
+        return;
+    }
+
+    // One mapping for both rings (IORING_FEAT_SINGLE_MMAP, Linux 5.4+)
+    size_t sq_size = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+    size_t cq_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+
+    sq_ring_size = sq_size > cq_size ? sq_size : cq_size;
+    sqes_size    = p.sq_entries * sizeof(io_uring_sqe);
+
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP))
+    {
+        close(fd);
+        return;
+    }
+
+    sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    void* s = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+    if (sq_ring == MAP_FAILED || s == MAP_FAILED)
+    {
+        if (sq_ring != MAP_FAILED) munmap(sq_ring, sq_ring_size);
+        if (s != MAP_FAILED)       munmap(s, sqes_size);
+        sq_ring = MAP_FAILED;
+        close(fd);
+        return;
+    }
+
+    uint8_t* base = static_cast<uint8_t*>(sq_ring);
+
+    sq_head    = reinterpret_cast<uint32_t*>(base + p.sq_off.head);
+    sq_tail    = reinterpret_cast<uint32_t*>(base + p.sq_off.tail);
+    sq_mask    = reinterpret_cast<uint32_t*>(base + p.sq_off.ring_mask);
+    sq_array   = reinterpret_cast<uint32_t*>(base + p.sq_off.array);
+    sq_entries = p.sq_entries;
+    sqes       = static_cast<io_uring_sqe*>(s);
+
+    cq_head    = reinterpret_cast<uint32_t*>(base + p.cq_off.head);
+    cq_tail    = reinterpret_cast<uint32_t*>(base + p.cq_off.tail);
+    cq_mask    = reinterpret_cast<uint32_t*>(base + p.cq_off.ring_mask);
+    cqes       = reinterpret_cast<io_uring_cqe*>(base + p.cq_off.cqes);
+
+    // Slot i of the array always names SQE i
+    for (uint32_t i = 0; i < sq_entries; i++)
+        sq_array[i] = i;
+
+    sq_local = *sq_tail;
+    ring_fd  = fd;
+
+    for (int i = 0; i < URING_MAX_LINKS; i++)
+        links[i].fd = -1;
+}
+
+uring_transport::~uring_transport()
+{
+    for (int i = 0; i < link_count; i++)
+    {
+        if (links[i].fd >= 0)
+            close(links[i].fd);
+    }
+
+    if (ring_fd >= 0)
+    {
+        munmap(sqes, sqes_size);
+        munmap(sq_ring, sq_ring_size);
+        close(ring_fd);
+    }
+
+    if (wake_fd >= 0)
+        close(wake_fd);
+}
+
+int uring_transport::add_link(
+    int fd,
+    ring_buffer<uint8_t>& rx,
+    ring_buffer<uint8_t>& tx,
+    link_rx_fn handler,
+    void* ctx)
+{
+    if (!valid() || started || fd < 0 || link_count >= URING_MAX_LINKS)
+        return -1;
+
+    // io_uring waits for readiness itself; on a non-blocking descriptor
+    // some kernels would complete with -EAGAIN instead
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) < 0)
+        return -1;
+
+    link_state& l = links[link_count];
+    l.fd       = fd;
+    l.rx       = &rx;
+    l.tx       = &tx;
+    l.handler  = handler;
+    l.ctx      = ctx;
+    l.reading  = false;
+    l.writing  = false;
+    l.received = false;
+    l.stalled  = false;
+    l.counters = uring_link_stats();
+
+    return link_count++;
+}
+
+bool uring_transport::start()
+{
+    if (!valid() || started)
+        return false;
+
+    // Buffer 2i: RX ring storage of link i, 2i + 1: its TX ring storage
+    iovec iov[2 * URING_MAX_LINKS];
+
+    for (int i = 0; i < link_count; i++)
+    {
+        iov[2 * i]     = iovec{ links[i].rx->storage(), links[i].rx->capacity() };
+        iov[2 * i + 1] = iovec{ links[i].tx->storage(), links[i].tx->capacity() };
+    }
+
+    if (link_count &&
+        syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS,
+                iov, 2 * link_count) != 0)
+        return false;
+
+    started = true;
+
+    for (int i = 0; i < link_count; i++)
+        post_read(i);
+
+    post_wake();
+    return true;
+}
+
+io_uring_sqe* uring_transport::get_sqe()
+{
+    if (sq_local - load_acquire(sq_head) >= sq_entries)
+    {
+        // Queue full: hand what is queued to the kernel first
+        if (enter(0, 0) < 0 || sq_local - load_acquire(sq_head) >= sq_entries)
+            return nullptr;
+    }
+
+    io_uring_sqe* sqe = &sqes[sq_local & *sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+
+    sq_local++;
+    sq_pending++;
+    store_release(sq_tail, sq_local);
+    return sqe;
+}
+
+int uring_transport::enter(uint32_t wait_nr, int timeout_ms)
+{
+    uint32_t flags = wait_nr ? IORING_ENTER_GETEVENTS : 0U;
+
+    __kernel_timespec       ts;
+    io_uring_getevents_arg  arg;
+    void*                   argp = nullptr;
+    size_t                  argsz = 0;
+
+    if (wait_nr && timeout_ms >= 0)
+    {
+        ts.tv_sec  = timeout_ms / 1000;
+        ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000LL;
+
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+
+        flags |= IORING_ENTER_EXT_ARG;
+        argp   = &arg;
+        argsz  = sizeof(arg);
+    }
+
+    enter_count++;
+
+    int n = (int)syscall(__NR_io_uring_enter, ring_fd, sq_pending, wait_nr,
+                         flags, argp, argsz);
+    if (n >= 0)
+    {
+        sq_pending -= (uint32_t)n;
+        return n;
+    }
+
+    return (errno == EINTR || errno == ETIME || errno == EBUSY) ? 0 : -1;
+}
+
+void uring_transport::post_read(int i)
+{
+    link_state& l = links[i];
+
+    if (l.fd < 0 || l.reading)
+        return;
+
+    uint8_t* a;
+    uint8_t* b;
+    uint16_t alen, blen;
+
+    if (l.rx->writable(a, alen, b, blen) == 0)
+    {
+        // No read, so no completion calls the handler again: run_once()
+        // does until it has made room
+        if (!l.stalled)
+            l.counters.rx_stalls++;
+        l.stalled = true;
+        return;
+    }
+
+    l.stalled = false;
+
+    io_uring_sqe* sqe = get_sqe();
+    if (sqe == nullptr)
+        return;
+
+    sqe->opcode    = IORING_OP_READ_FIXED;
+    sqe->fd        = l.fd;
+    sqe->addr      = (uint64_t)(uintptr_t)a;
+    sqe->len       = alen;
+    sqe->buf_index = (uint16_t)(2 * i);
+    sqe->user_data = ((uint64_t)i << 2) | OP_READ;
+
+    l.reading = true;
+}
+
+void uring_transport::post_write(int i)
+{
+    link_state& l = links[i];
+
+    if (l.fd < 0 || l.writing)
+        return;
+
+    uint8_t* a;
+    uint8_t* b;
+    uint16_t alen, blen;
+
+    if (l.tx->readable(a, alen, b, blen) == 0)
+        return;
+
+    io_uring_sqe* sqe = get_sqe();
+    if (sqe == nullptr)
+        return;
+
+    // The wrapped-around part follows once this write completes
+    sqe->opcode    = IORING_OP_WRITE_FIXED;
+    sqe->fd        = l.fd;
+    sqe->addr      = (uint64_t)(uintptr_t)a;
+    sqe->len       = alen;
+    sqe->buf_index = (uint16_t)(2 * i + 1);
+    sqe->user_data = ((uint64_t)i << 2) | OP_WRITE;
+
+    l.writing = true;
+}
+
+void uring_transport::post_wake()
+{
+    io_uring_sqe* sqe = get_sqe();
+    if (sqe == nullptr)
+        return;
+
+    sqe->opcode    = IORING_OP_READ;
+    sqe->fd        = wake_fd;
+    sqe->addr      = (uint64_t)(uintptr_t)&wake_value;
+    sqe->len       = sizeof(wake_value);
+    sqe->user_data = OP_WAKE;
+}
+
+void uring_transport::arm_tx()
+{
+    uint64_t one = 1;
+
+    if (!wake_posted.exchange(true) && write(wake_fd, &one, sizeof(one)) < 0)
+        wake_posted = false;
+}
+
+void uring_transport::notify_tx(void* ctx)
+{
+    static_cast<uring_transport*>(ctx)->arm_tx();
+}
+
+void uring_transport::hang_up(int i)
+{
+    link_state& l = links[i];
+
+    // A write still in flight keeps its own file reference
+    close(l.fd);
+    l.fd      = -1;
+    l.stalled = false;
+    l.counters.hangups++;
+}
+
+void uring_transport::complete(uint64_t data, int32_t res)
+{
+    uint32_t op = (uint32_t)(data & 3U);
+
+    if (op == OP_WAKE)
+    {
+        wake_posted = false;
+        post_wake();
+        return;
+    }
+
+    link_state& l = links[data >> 2];
+
+    if (op == OP_READ)
+    {
+        l.reading = false;
+
+        if (l.fd < 0)
+            return;
+
+        if (res > 0)
+        {
+            l.rx->produce((uint16_t)res);
+            l.counters.rx_bytes += (uint64_t)res;
+            l.counters.reads++;
+            l.received = true;
+        }
+        else if (res != -EAGAIN && res != -EINTR)
+        {
+            // 0: peer closed the socket; -EIO: pty whose other end is gone
+            hang_up((int)(data >> 2));
+        }
+        return;     // re-posted after the handler ran
+    }
+
+    l.writing = false;
+
+    if (res > 0)
+    {
+        l.tx->consume((uint16_t)res);
+        l.counters.tx_bytes += (uint64_t)res;
+        l.counters.writes++;
+    }
+}
+
+int uring_transport::run_once(int timeout_ms)
+{
+    if (!started)
+        return -1;
+
+    // Frames queued since the last iteration, including replies sent
+    // from the handlers
+    for (int i = 0; i < link_count; i++)
+        post_write(i);
+
+    // A stalled link is served again right away, not after the timeout
+    if (enter(1, rx_stalled ? 0 : timeout_ms) < 0)
+        return -1;
+
+    int handled = 0;
+
+    uint32_t head = *cq_head;
+    uint32_t tail = load_acquire(cq_tail);
+
+    for (; head != tail; head++, handled++)
+    {
+        const io_uring_cqe& cqe = cqes[head & *cq_mask];
+        complete(cqe.user_data, cqe.res);
+    }
+
+    store_release(cq_head, head);
+
+    // One handler call per link and iteration, however many reads
+    // completed; a link whose full RX ring stopped reading is called
+    // every iteration until its handler drains the ring
+    rx_stalled = false;
+
+    for (int i = 0; i < link_count; i++)
+    {
+        link_state& l = links[i];
+
+        if (l.received || (l.stalled && !l.rx->empty()))
+        {
+            l.received = false;
+            if (l.handler)
+                l.handler(l.ctx, i);
+        }
+
+        post_read(i);
+        rx_stalled |= l.stalled;
+    }
+
+    return handled;
+}
+
+void uring_transport::run()
+{
+    running = true;
+
+    while (running)
+    {
+        if (run_once(-1) < 0)
+            break;
+    }
+}
+
+void uring_transport::stop()
+{
+    running = false;
+    arm_tx();
+}
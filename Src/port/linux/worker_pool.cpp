@@ -0,0 +1,459 @@
+#include "port/linux/worker_pool.h"
+
+#include "core/fragment_reassembler.h"
+
+#include <string.h>
+#include <sched.h>
+#include <new>
+
+/* Descriptor structs are followed by their bytes at this alignment */
+#define PAYLOAD_ALIGN 16U
+
+static uint32_t align_up(uint32_t n)
+{
+    return (n + PAYLOAD_ALIGN - 1U) & ~(PAYLOAD_ALIGN - 1U);
+}
+
+/* Counter with a single writer: no locked instruction on the hot path */
+static void bump(std::atomic<uint64_t>& c)
+{
+    c.store(c.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+}
+
+worker_pool::worker_pool()
+    : workers_started(0),
+      next_worker(0),
+      key_fn(nullptr),
+      spare(nullptr),
+      returned(nullptr),
+      free_jobs(WORKER_MAX_JOBS),
+      ready_total(0),
+      sleepers(0),
+      running(false),
+      queued(0),
+      executed(0),
+      stolen(0),
+      waits(0),
+      oversize(0)
+{
+    for (int i = WORKER_MAX_JOBS - 1; i >= 0; i--)
+    {
+        jobs[i].next = spare;
+        spare        = &jobs[i];
+    }
+
+    for (int i = 0; i < WORKER_MAX_QUEUES; i++)
+    {
+        queues[i].head      = nullptr;
+        queues[i].tail      = nullptr;
+        queues[i].scheduled = false;
+    }
+
+    for (int i = 0; i < WORKER_MAX_THREADS; i++)
+    {
+        workers[i].pool        = this;
+        workers[i].index       = i;
+        workers[i].first       = 0;
+        workers[i].ready_count = 0;
+    }
+}
+
+worker_pool::~worker_pool()
+{
+    stop();
+}
+
+bool worker_pool::start(int count)
+{
+    if (workers_started || count < 1 || count > WORKER_MAX_THREADS)
+        return false;
+
+    running = true;
+
+    for (int i = 0; i < count; i++)
+    {
+        // Counted first: running workers steal from workers[0..workers_started)
+        workers_started = i + 1;
+
+        if (pthread_create(&workers[i].thread, nullptr, worker_main, &workers[i]) != 0)
+        {
+            workers_started = i;
+            break;
+        }
+    }
+
+    if (workers_started == 0)
+    {
+        running = false;
+        return false;
+    }
+    return true;
+}
+
+void worker_pool::stop()
+{
+    if (workers_started == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> l(idle_lock);
+        running = false;
+        idle.notify_all();
+    }
+
+    for (int i = 0; i < workers_started; i++)
+        pthread_join(workers[i].thread, nullptr);
+
+    workers_started = 0;
+}
+
+void worker_pool::attach(cmnd_executer& executer)
+{
+    executer.set_handler_dispatch(dispatch, this);
+}
+
+void worker_pool::attach(fragment_reassembler& reassembler)
+{
+    reassembler.set_handler_dispatch(dispatch, this);
+}
+
+worker_stats worker_pool::stats() const
+{
+    worker_stats s;
+
+    s.queued   = queued.load(std::memory_order_relaxed);
+    s.executed = executed.load(std::memory_order_relaxed);
+    s.stolen   = stolen.load(std::memory_order_relaxed);
+    s.waits    = waits.load(std::memory_order_relaxed);
+    s.oversize = oversize.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool worker_pool::pack(job& j, data_type type, const void* data, uint16_t count)
+{
+    unsigned char* out = j.payload;
+
+    j.type  = type;
+    j.count = count;
+    j.data  = nullptr;
+
+    switch (type)
+    {
+    case data_type::INT:
+    case data_type::FLOAT:
+    case data_type::BYTES:
+    {
+        uint32_t n = (type == data_type::BYTES) ? count : count * 4U;
+
+        if (n > WORKER_JOB_SIZE)
+            return false;
+
+        memcpy(out, data, n);
+        j.data = out;
+        return true;
+    }
+
+    case data_type::STRING:
+    {
+        // Pointer array first, then the strings it points to
+        const char* const* in  = static_cast<const char* const*>(data);
+        char**             ptr = reinterpret_cast<char**>(out);
+        uint32_t           pos = (uint32_t)count * sizeof(char*);
+
+        if (pos > WORKER_JOB_SIZE)
+            return false;
+
+        for (uint16_t i = 0; i < count; i++)
+        {
+            uint32_t len = (uint32_t)strlen(in[i]) + 1U;
+
+            if (pos + len > WORKER_JOB_SIZE)
+                return false;
+
+            memcpy(out + pos, in[i], len);
+            ptr[i] = reinterpret_cast<char*>(out + pos);
+            pos   += len;
+        }
+
+        j.data = out;
+        return true;
+    }
+
+    case data_type::BLOCK:
+    {
+        sample_block b   = *static_cast<const sample_block*>(data);
+        uint32_t     at  = align_up(sizeof(sample_block));
+        uint32_t     len = (uint32_t)b.samples * b.channels * sizeof(float);
+
+        if (at + len > WORKER_JOB_SIZE)
+            return false;
+
+        memcpy(out + at, b.values, len);
+        b.values = reinterpret_cast<const float*>(out + at);
+        j.data   = new (out) sample_block(b);
+        return true;
+    }
+
+    case data_type::CHUNK:
+    {
+        payload_chunk c  = *static_cast<const payload_chunk*>(data);
+        uint32_t      at = align_up(sizeof(payload_chunk));
+
+        if (at + c.len > WORKER_JOB_SIZE)
+            return false;
+
+        memcpy(out + at, c.data, c.len);
+        c.data = out + at;
+        j.data = new (out) payload_chunk(c);
+        return true;
+    }
+
+    case data_type::STREAM:
+    {
+        stream_chunk c  = *static_cast<const stream_chunk*>(data);
+        uint32_t     at = align_up(sizeof(stream_chunk));
+
+        if (at + c.len > WORKER_JOB_SIZE)
+            return false;
+
+        if (c.len)
+            memcpy(out + at, c.data, c.len);
+        c.data = out + at;
+        j.data = new (out) stream_chunk(c);
+        return true;
+    }
+
+    case data_type::NONE:
+    default:
+        return true;
+    }
+}
+
+worker_pool::job* worker_pool::take_job()
+{
+    if (spare == nullptr)
+    {
+        // Take back everything the workers have released so far
+        spare = returned.exchange(nullptr, std::memory_order_acquire);
+
+        while (spare == nullptr)
+        {
+            bump(waits);
+            returned.wait(nullptr, std::memory_order_acquire);
+            spare = returned.exchange(nullptr, std::memory_order_acquire);
+        }
+    }
+
+    job* j = spare;
+    spare  = j->next;
+    free_jobs.fetch_sub(1, std::memory_order_relaxed);
+    return j;
+}
+
+void worker_pool::free_job(job* j)
+{
+    // Push only: the dispatching thread takes the whole list at once, so no ABA
+    job* head = returned.load(std::memory_order_relaxed);
+
+    do
+    {
+        j->next = head;
+    } while (!returned.compare_exchange_weak(head, j, std::memory_order_release,
+                                             std::memory_order_relaxed));
+
+    free_jobs.fetch_add(1, std::memory_order_relaxed);
+
+    if (head == nullptr)
+        returned.notify_one();
+}
+
+void worker_pool::dispatch(void* ctx, const path_entry& entry, data_type type, const void* data, uint16_t count)
+{
+    worker_pool& p = *static_cast<worker_pool*>(ctx);
+
+    if (p.workers_started == 0)
+    {
+        entry.handler(type, data, count);
+        return;
+    }
+
+    // Entries of one table are adjacent, so each path gets its own queue
+    uint32_t key = p.key_fn ? p.key_fn(entry, type, data, count)
+                            : (uint32_t)((uintptr_t)&entry / sizeof(path_entry));
+    uint16_t index = (uint16_t)(key % WORKER_MAX_QUEUES);
+
+    serial_queue& q = p.queues[index];
+    bool          ready;
+
+    job* j = p.take_job();
+
+    if (!p.pack(*j, type, data, count))
+    {
+        bump(p.oversize);
+        j->next = p.spare;
+        p.spare = j;
+        p.free_jobs.fetch_add(1, std::memory_order_relaxed);
+
+        // Too large to copy: run it here rather than lose the call, once
+        // the calls queued before it for the same key are done. Rare, so
+        // the wait just yields; nothing is added to the queue meanwhile.
+        for (;;)
+        {
+            {
+                std::lock_guard<std::mutex> l(q.lock);
+                if (q.head == nullptr && !q.scheduled)
+                    break;
+            }
+            sched_yield();
+        }
+
+        entry.handler(type, data, count);
+        return;
+    }
+
+    j->entry = &entry;
+    j->next  = nullptr;
+
+    {
+        std::lock_guard<std::mutex> l(q.lock);
+
+        if (q.tail)
+            q.tail->next = j;
+        else
+            q.head = j;
+        q.tail = j;
+
+        ready       = !q.scheduled;
+        q.scheduled = true;
+    }
+
+    bump(p.queued);
+
+    if (ready)
+        p.schedule(p.workers[p.next_worker++ % (uint32_t)p.workers_started], index);
+}
+
+void worker_pool::schedule(worker& w, uint16_t queue)
+{
+    {
+        std::lock_guard<std::mutex> l(w.lock);
+        w.ready[(w.first + w.ready_count) % WORKER_MAX_QUEUES] = queue;
+        w.ready_count++;
+    }
+
+    // Pairs with the check of ready_total after sleepers++ in run()
+    ready_total.fetch_add(1);
+
+    if (sleepers.load() > 0)
+    {
+        std::lock_guard<std::mutex> l(idle_lock);
+        idle.notify_one();
+    }
+}
+
+int worker_pool::next_queue(worker& w)
+{
+    {
+        std::lock_guard<std::mutex> l(w.lock);
+
+        if (w.ready_count)
+        {
+            int queue = w.ready[w.first];
+            w.first   = (uint16_t)((w.first + 1U) % WORKER_MAX_QUEUES);
+            w.ready_count--;
+            ready_total.fetch_sub(1);
+            return queue;
+        }
+    }
+
+    // Steal the most recently readied queue of another worker
+    for (int k = 1; k < workers_started; k++)
+    {
+        worker& v = workers[(w.index + k) % workers_started];
+        std::lock_guard<std::mutex> l(v.lock);
+
+        if (v.ready_count)
+        {
+            v.ready_count--;
+            ready_total.fetch_sub(1);
+            stolen.fetch_add(1, std::memory_order_relaxed);
+            return v.ready[(v.first + v.ready_count) % WORKER_MAX_QUEUES];
+        }
+    }
+
+    return -1;
+}
+
+void worker_pool::run_queue(worker& w, uint16_t index)
+{
+    serial_queue& q = queues[index];
+
+    for (int n = 0; n < WORKER_BATCH; n++)
+    {
+        job* j;
+
+        {
+            std::lock_guard<std::mutex> l(q.lock);
+
+            j = q.head;
+            if (j == nullptr)
+            {
+                q.scheduled = false;
+                return;
+            }
+
+            q.head = j->next;
+            if (q.head == nullptr)
+                q.tail = nullptr;
+        }
+
+        j->entry->handler(j->type, j->data, j->count);
+        executed.fetch_add(1, std::memory_order_relaxed);
+        free_job(j);
+    }
+
+    {
+        std::lock_guard<std::mutex> l(q.lock);
+
+        if (q.head == nullptr)
+        {
+            q.scheduled = false;
+            return;
+        }
+    }
+
+    // More calls pending: back to the end of the run queue, other keys go first
+    schedule(w, index);
+}
+
+void worker_pool::run(worker& w)
+{
+    for (;;)
+    {
+        int queue = next_queue(w);
+
+        if (queue >= 0)
+        {
+            run_queue(w, (uint16_t)queue);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> l(idle_lock);
+
+        if (!running && ready_total.load() == 0)
+            return;
+
+        sleepers.fetch_add(1);
+        while (ready_total.load() == 0 && running)
+            idle.wait(l);
+        sleepers.fetch_sub(1);
+    }
+}
+
+void* worker_pool::worker_main(void* arg)
+{
+    worker& w = *static_cast<worker*>(arg);
+
+    w.pool->run(w);
+    return nullptr;
+}
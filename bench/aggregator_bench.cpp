@@ -0,0 +1,90 @@
+// Per-sample cost of sample_aggregator::push() for 1..4 channels and
+// several stage sets, with a window of 10 (one summary frame per ten
+// samples, formatted into a TX ring that is drained after every frame).
+// The frame cost is reported separately by running with a window so
+// long that no frame is sent. Also checks that layouts above
+// MAX_CSV_ITEMS values are rejected.
+//
+//   g++ -std=c++11 -O2 -IInc bench/aggregator_bench.cpp Src/core/*.cpp -o aggregator_bench
+//   ./aggregator_bench [samples]
+#include "core/sample_aggregator.h"
+#include "core/cmnd_executer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+static uint8_t              tx_storage[1024];
+static ring_buffer<uint8_t> tx(tx_storage, sizeof(tx_storage));
+
+static double run(uint8_t channels, uint16_t window, uint8_t stages, int samples,
+                  uint32_t& frames)
+{
+    cmnd_sender       sender(tx);
+    sample_aggregator agg(sender, "sens/imu/gyro", channels, window, stages);
+    float             sample[AGGREGATOR_MAX_CHANNELS];
+    uint8_t           b;
+
+    frames = 0;
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < samples; i++)
+    {
+        for (uint8_t c = 0; c < channels; c++)
+            sample[c] = (float)((i * 7 + c * 13) % 101) * 0.01f;
+
+        agg.push(sample);
+
+        if (!tx.empty())
+        {
+            frames++;
+            while (tx.pop(b)) {}
+        }
+    }
+
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return s * 1e9 / samples;
+}
+
+int main(int argc, char** argv)
+{
+    int samples = argc > 1 ? atoi(argv[1]) : 2000000;
+
+    if (samples <= 0)
+        samples = 2000000;
+
+    struct { const char* name; uint8_t stages; } sets[] = {
+        { "MEAN",     AGG_MEAN },
+        { "MIN|MAX",  AGG_MIN | AGG_MAX },
+        { "MEAN|RMS", AGG_MEAN | AGG_RMS },
+    };
+
+    bool ok = true;
+
+    for (auto& set : sets)
+    {
+        for (uint8_t channels = 1; channels <= AGGREGATOR_MAX_CHANNELS; channels++)
+        {
+            uint32_t frames, none;
+            double   ns   = run(channels, 10, set.stages, samples, frames);
+            double   bare = run(channels, 60000, set.stages, samples, none);
+
+            printf("%-9s %u ch  %5.1f ns/sample  (accumulate %5.1f ns, frame %6.1f ns)  "
+                   "%lu frames\n", set.name, channels, ns, bare, (ns - bare) * 10,
+                   (unsigned long)frames);
+            ok &= frames == (uint32_t)(samples / 10);
+        }
+    }
+
+    // 3 channels x MEAN|MIN|MAX = 9 values per frame cannot be parsed
+    cmnd_sender       sender(tx);
+    sample_aggregator too_wide(sender, "sens/imu/gyro", 3, 10, AGG_MEAN | AGG_MIN | AGG_MAX);
+    float             sample[3] = { 0.0f, 0.0f, 0.0f };
+    bool              refused = !too_wide.valid() && !too_wide.push(sample) && tx.empty();
+
+    printf("9 values per frame: %s\n", refused ? "rejected" : "FAILED");
+    ok &= refused;
+
+    puts(ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
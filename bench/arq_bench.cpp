@@ -0,0 +1,222 @@
+// Selective-repeat ARQ over a simulated lossy link: peer A sends
+// numbered reliable frames to peer B through a link with a fixed byte
+// rate, a propagation delay and random byte loss in both directions
+// (CRC-16 trailers turn damaged frames into losses). Reports, per loss
+// rate and window, the ticks needed, the share of the link rate
+// carrying first-time frames and the retransmits (early: triggered by
+// the ACK mask before the timeout), and checks that every frame reached
+// B's handler exactly once. Also checks that a sender whose staging
+// buffer exceeds the slot size is refused before anything goes on the
+// wire.
+//
+//   g++ -std=c++11 -O2 -IInc bench/arq_bench.cpp Src/core/*.cpp -o arq_bench
+//   ./arq_bench [frames]
+#include "core/cmnd_sender.h"
+#include "core/cmnd_parser.h"
+#include "core/cmnd_executer.h"
+#include "core/reliable_link.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_MAX_FRAMES 20000
+#define LINK_RATE        8       // bytes per tick and direction
+#define LINK_DELAY       6       // ticks from sender to receiver
+#define LINE_SIZE        (LINK_RATE * (LINK_DELAY + 2))
+#define SLOT_SIZE        48
+
+static uint8_t seen[BENCH_MAX_FRAMES];
+
+static void on_seq(data_type type, const void* data, uint16_t count)
+{
+    int32_t i = static_cast<const int32_t*>(data)[0];
+
+    if (type == data_type::INT && count == 1 && i >= 0 && i < BENCH_MAX_FRAMES)
+        seen[i]++;
+}
+
+static const path_entry table[] = {
+    { "arq/seq", data_type::INT, on_seq },
+};
+
+static uint32_t rng = 12345;
+
+static uint32_t next_random()
+{
+    rng = rng * 1664525UL + 1013904223UL;
+    return rng >> 8;
+}
+
+// One direction: bytes leave the TX ring at LINK_RATE, arrive LINK_DELAY ticks later
+struct wire
+{
+    uint8_t  bytes[LINE_SIZE];
+    uint32_t due[LINE_SIZE];
+    uint32_t head, count;
+    uint32_t loss_ppm;
+
+    void carry(ring_buffer<uint8_t>& from, ring_buffer<uint8_t>& to, uint32_t now)
+    {
+        for (int n = 0; n < LINK_RATE && count < LINE_SIZE; n++)
+        {
+            uint8_t b;
+            if (!from.pop(b))
+                break;
+
+            uint32_t k = (head + count++) % LINE_SIZE;
+            bytes[k] = b;
+            due[k]   = now + LINK_DELAY;
+        }
+
+        while (count && due[head] <= now)
+        {
+            if (next_random() % 1000000U >= loss_ppm && !to.push(bytes[head]))
+                break;
+            head = (head + 1) % LINE_SIZE;
+            count--;
+        }
+    }
+};
+
+struct peer
+{
+    uint8_t    rx_storage[1024];
+    uint8_t    tx_storage[1024];
+    cmnd_frame frame_storage[16];
+    char       work[512];
+    char       stage[SLOT_SIZE];
+    uint8_t    arq_storage[RELIABLE_MAX_WINDOW * SLOT_SIZE];
+
+    ring_buffer<uint8_t>    rx;
+    ring_buffer<uint8_t>    tx;
+    ring_buffer<cmnd_frame> frames;
+    cmnd_sender             sender;
+    cmnd_parser             parser;
+    cmnd_executer           executer;
+    reliable_link           link;
+
+    peer(const path_entry* paths, uint16_t count, uint8_t window, uint16_t timeout)
+        : rx(rx_storage, sizeof(rx_storage)),
+          tx(tx_storage, sizeof(tx_storage)),
+          frames(frame_storage, 16),
+          sender(tx, stage, sizeof(stage)),
+          parser(rx, frames, work, sizeof(work)),
+          executer(frames, paths, count),
+          link(sender, arq_storage, SLOT_SIZE, window, timeout)
+    {
+        sender.set_crc_mode(crc_mode::CRC16_CCITT);
+        parser.set_crc_mode(crc_mode::CRC16_CCITT);
+        executer.set_reply_sender(&sender);
+        executer.set_reliable_link(&link);
+    }
+
+    void poll()
+    {
+        do
+        {
+            parser.poll();
+            while (!frames.empty())
+                executer.poll();
+        } while (!rx.empty() && frames.space());
+    }
+};
+
+static bool run(int frames, uint32_t loss_ppm, uint8_t window)
+{
+    static wire a_to_b, b_to_a;
+    // Round trip plus a full window queued ahead of the frame
+    uint16_t    timeout = (uint16_t)(2 * LINK_DELAY + window * SLOT_SIZE / LINK_RATE + 8);
+    peer*       a = new peer(nullptr, 0, window, timeout);
+    peer*       b = new peer(table, 1, window, timeout);
+
+    memset(seen, 0, sizeof(seen));
+    memset(&a_to_b, 0, sizeof(a_to_b));
+    memset(&b_to_a, 0, sizeof(b_to_a));
+    a_to_b.loss_ppm = loss_ppm;
+    b_to_a.loss_ppm = loss_ppm;
+
+    int      next = 0;
+    uint32_t now  = 0;
+    uint32_t frame_bytes = 0;
+
+    while ((next < frames || a->link.in_flight()) && now < 10000000U)
+    {
+        while (next < frames && a->link.can_send())
+        {
+            uint16_t before = a->tx.count();
+
+            if (!a->link.send_int("arq/seq", &next, 1))
+                break;
+            frame_bytes += (uint16_t)(a->tx.count() - before);
+            next++;
+        }
+
+        a_to_b.carry(a->tx, b->rx, now);
+        b_to_a.carry(b->tx, a->rx, now);
+
+        b->poll();
+        a->poll();
+        a->link.tick();
+        b->link.tick();
+        now++;
+    }
+
+    int missing = 0, duplicated = 0;
+
+    for (int i = 0; i < frames; i++)
+    {
+        if (seen[i] == 0) missing++;
+        if (seen[i] > 1)  duplicated++;
+    }
+
+    printf("loss %5.2f%%  window %2u  %8u ticks  goodput %5.1f%% of link  "
+           "retransmits %5lu (early %5lu)  missing %d  duplicated %d\n",
+           loss_ppm / 10000.0, window, (unsigned)now,
+           100.0 * frame_bytes / ((double)now * LINK_RATE),
+           (unsigned long)a->link.stats().retransmits,
+           (unsigned long)a->link.stats().early_resends, missing, duplicated);
+
+    delete a;
+    delete b;
+    return missing == 0 && duplicated == 0;
+}
+
+// A staging buffer larger than a slot must be refused up front: the
+// frame would be on the wire with a sequence number it cannot keep
+static bool run_oversize()
+{
+    static uint8_t tx_storage[256];
+    static char    big_stage[2 * SLOT_SIZE];
+    static uint8_t arq_storage[4 * SLOT_SIZE];
+
+    ring_buffer<uint8_t> tx(tx_storage, sizeof(tx_storage));
+    cmnd_sender          sender(tx, big_stage, sizeof(big_stage));
+    reliable_link        link(sender, arq_storage, SLOT_SIZE, 4, 10);
+    int32_t              v = 1;
+
+    bool refused = !link.send_int("arq/seq", &v, 1);
+    bool ok      = refused && tx.empty() && link.in_flight() == 0;
+
+    printf("oversized staging buffer: %s\n", ok ? "refused before sending" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 5000;
+
+    if (frames <= 0 || frames > BENCH_MAX_FRAMES)
+        frames = BENCH_MAX_FRAMES;
+
+    static const uint32_t losses[]  = { 0, 2000, 10000, 30000 };   // ppm per byte
+    static const uint8_t  windows[] = { 1, 4, RELIABLE_MAX_WINDOW };
+    bool ok = run_oversize();
+
+    for (uint32_t loss : losses)
+        for (uint8_t window : windows)
+            ok &= run(frames, loss, window);
+
+    puts(ok ? "all frames delivered exactly once" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+// Decode loop with blocking handlers: frames round robin over 8 paths
+// whose handler sleeps (a stand-in for a database write) are executed
+// inline or through worker_pool with 1..8 workers. Reports the time the
+// decode loop spends per frame and the time until every handler has
+// run. The decode loop waits for a free job buffer once more than
+// WORKER_MAX_JOBS calls are pending.
+//
+//   g++ -std=c++20 -O2 -IInc bench/pool_bench.cpp Src/core/*.cpp Src/port/linux/worker_pool.cpp -o pool_bench -pthread
+//   ./pool_bench [frames] [handler_us]
+#include "core/cmnd_parser.h"
+#include "core/cmnd_executer.h"
+#include "port/linux/worker_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <utility>
+
+#define BENCH_PATHS 8
+
+static unsigned              handler_us = 100;
+static std::atomic<uint32_t> done;
+static char                  paths[BENCH_PATHS][16];
+
+template<int K>
+static void slow(data_type, const void*, uint16_t)
+{
+    usleep(handler_us);
+    done.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<int... K>
+static void fill_table(path_entry* table, std::integer_sequence<int, K...>)
+{
+    ((table[K] = path_entry { paths[K], data_type::INT, slow<K> }), ...);
+}
+
+static path_entry table[BENCH_PATHS];
+
+static uint8_t    rx_storage[4096];
+static cmnd_frame frame_storage[16];
+static char       work[512];
+
+static worker_pool pool;
+
+static double now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void run(int workers, uint32_t total)
+{
+    ring_buffer<uint8_t>    rx(rx_storage, sizeof(rx_storage));
+    ring_buffer<cmnd_frame> frames(frame_storage, 16);
+    cmnd_parser             parser(rx, frames, work, sizeof(work));
+    cmnd_executer           executer(frames, table, BENCH_PATHS);
+
+    if (workers)
+    {
+        pool.start(workers);
+        pool.attach(executer);
+    }
+
+    done = 0;
+
+    double t0     = now_ns();
+    double decode = 0;
+
+    for (uint32_t k = 0; k < total; k++)
+    {
+        char frame[40];
+        int  n = snprintf(frame, sizeof(frame), "{p:%s:d:%u}", paths[k % BENCH_PATHS], k);
+
+        for (int i = 0; i < n; i++)
+            rx.push((uint8_t)frame[i]);
+
+        double t = now_ns();
+        bool   more;
+        do
+        {
+            parser.poll();
+            more = !frames.empty();
+            while (!frames.empty())
+                executer.poll();
+        } while (more);
+        decode += now_ns() - t;
+    }
+
+    pool.stop();
+
+    double elapsed = now_ns() - t0;
+    worker_stats s = pool.stats();
+
+    printf("%-7s workers=%d  decode %8.0f ns/frame  all handlers done after %7.1f ms  (%u run, %lu waits)\n",
+           workers ? "pool" : "inline", workers, decode / total, elapsed / 1e6, done.load(),
+           (unsigned long)s.waits);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t total = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 2000U;
+    handler_us     = argc > 2 ? (unsigned)strtoul(argv[2], nullptr, 0) : 100U;
+
+    for (int i = 0; i < BENCH_PATHS; i++)
+        snprintf(paths[i], sizeof(paths[i]), "db/t%d", i);
+    fill_table(table, std::make_integer_sequence<int, BENCH_PATHS>());
+
+    const int workers[] = { 0, 1, 4, 8 };
+
+    for (int w : workers)
+        run(w, total);
+
+    return 0;
+}
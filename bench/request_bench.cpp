@@ -0,0 +1,199 @@
+// Request/response round trips over a socketpair: a forked responder
+// answers "param/get" requests; the parent awaits them from request_client
+// coroutines on an epoll_reactor. Reports requests/s and round-trip
+// times for 1, 8 and 64 requests in flight.
+//
+//   g++ -std=c++20 -O2 -IInc bench/request_bench.cpp Src/core/*.cpp Src/port/linux/*.cpp -o request_bench
+//   ./request_bench [requests]
+#include "core/cmnd_sender.h"
+#include "core/cmnd_parser.h"
+#include "core/cmnd_executer.h"
+#include "core/reply_writer.h"
+#include "port/linux/serial_port.h"
+#include "port/linux/pathwire_port.h"
+#include "port/linux/request_client.h"
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+
+#define BENCH_MAX_REQUESTS 200000
+
+static uint8_t    rx_storage[16384];
+static uint8_t    tx_storage[16384];
+static cmnd_frame frame_storage[64];
+static char       work[2048];
+static char       stage[128];
+
+static ring_buffer<uint8_t>    rx(rx_storage, sizeof(rx_storage));
+static ring_buffer<uint8_t>    tx(tx_storage, sizeof(tx_storage));
+static ring_buffer<cmnd_frame> frames(frame_storage, 64);
+static cmnd_sender             sender(tx, stage, sizeof(stage));
+
+// Responder ----------------------------------------------------------------
+
+static void on_get(data_type type, const void* data, uint16_t count, reply_writer& reply)
+{
+    if (type != data_type::INT || count != 1)
+        return;
+
+    int32_t id = static_cast<const int32_t*>(data)[0];
+
+    reply.begin("param/value", data_type::INT);
+    reply.add_int(id);
+    reply.add_int(id * 10);
+    reply.end();
+}
+
+static const request_entry responder_table[] = {
+    { "param/get", data_type::INT, on_get },
+};
+
+static void respond(int fd)
+{
+    cmnd_parser   parser(rx, frames, work, sizeof(work));
+    cmnd_executer executer(frames, nullptr, 0);
+    uint8_t       buf[4096];
+
+    executer.set_reply_sender(&sender);
+    executer.set_request_table(responder_table, 1);
+
+    for (;;)
+    {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0)
+            _exit(0);
+
+        for (ssize_t i = 0; i < n; i++)
+            rx.push(buf[i]);
+
+        bool more;
+        do
+        {
+            parser.poll();
+            more = !frames.empty();
+            while (!frames.empty())
+                executer.poll();
+        } while (more);
+
+        while (!tx.empty())
+        {
+            uint16_t k = 0;
+            while (k < sizeof(buf) && tx.pop(buf[k]))
+                k++;
+            if (write(fd, buf, k) != (ssize_t)k)
+                _exit(1);
+        }
+    }
+}
+
+// Requester ----------------------------------------------------------------
+
+static uint64_t rtt[BENCH_MAX_REQUESTS];
+static uint32_t rtt_count;
+static uint32_t errors;
+static int      active;
+
+static request_task requester(request_client& client, uint32_t count, int32_t base)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        int32_t       arg = base + (int32_t)i;
+        request_reply r   = co_await client.request("param/get", &arg, 1);
+
+        if (r.status != request_status::OK || r.count != 2 ||
+            r.ints()[0] != arg || r.ints()[1] != arg * 10)
+            errors++;
+        else if (rtt_count < BENCH_MAX_REQUESTS)
+            rtt[rtt_count++] = r.rtt_ns;
+    }
+    active--;
+}
+
+static double now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t total = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 50000U;
+    int      sv[2];
+
+    if (total > BENCH_MAX_REQUESTS)
+        total = BENCH_MAX_REQUESTS;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0)
+        return 1;
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(sv[0]);
+        respond(sv[1]);
+    }
+    close(sv[1]);
+
+    epoll_reactor reactor;
+    serial_port   port(reactor, rx, tx);
+    cmnd_parser   parser(rx, frames, work, sizeof(work));
+    cmnd_executer executer(frames, nullptr, 0);
+
+    port.attach(sv[0]);
+    pathwire_port_init(port, sender);
+
+    struct link_ctx { cmnd_parser* parser; cmnd_executer* executer; serial_port* port; };
+    static link_ctx ctx;
+    ctx = { &parser, &executer, &port };
+
+    port.set_rx_handler([](void* arg) {
+        link_ctx& l = *static_cast<link_ctx*>(arg);
+        bool      more;
+        do
+        {
+            l.parser->poll();
+            more = !frames.empty();
+            while (!frames.empty())
+                l.executer->poll();
+        } while (more);
+        l.port->resume_rx();
+    }, &ctx);
+
+    request_client client(reactor, executer, sender);
+
+    const int depths[] = { 1, 8, 64 };
+
+    for (int depth : depths)
+    {
+        rtt_count = 0;
+        errors    = 0;
+        active    = depth;
+
+        double t0 = now_ns();
+
+        for (int k = 0; k < depth; k++)
+            requester(client, total / depth, k * 1000000);
+
+        while (active)
+            reactor.run_once(100);
+
+        double elapsed = now_ns() - t0;
+
+        std::sort(rtt, rtt + rtt_count);
+
+        printf("in flight %2d  %8.0f requests/s  rtt p50 %6.1f us  p99 %6.1f us  errors %u\n",
+               depth, rtt_count / elapsed * 1e9,
+               rtt_count ? rtt[rtt_count / 2] / 1e3 : 0.0,
+               rtt_count ? rtt[rtt_count * 99 / 100] / 1e3 : 0.0, errors);
+    }
+
+    port.close();
+    waitpid(pid, nullptr, 0);
+    return 0;
+}
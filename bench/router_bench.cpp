@@ -0,0 +1,322 @@
+// Gateway forwarding cost: frames arriving on one inbound link are
+// delivered to 1..64 outbound links, either forwarded unchanged by
+// frame_router or parsed and re-sent through cmnd_sender (one handler
+// per outbound path). Reports throughput and the latency of a single
+// frame from the inbound RX ring into the outbound TX ring. Also checks
+// that a corrupted frame on a path-rewriting route is dropped instead
+// of leaving with a fresh CRC, and that routed ARQ frames are
+// acknowledged on the inbound link and forwarded once.
+//
+//   g++ -std=c++20 -O2 -IInc bench/router_bench.cpp Src/core/*.cpp -o router_bench
+//   ./router_bench [frames]
+#include "core/frame_router.h"
+#include "core/cmnd_sender.h"
+#include "core/cmnd_parser.h"
+#include "core/cmnd_executer.h"
+#include "core/reliable_link.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <utility>
+
+#define BENCH_MAX_LINKS 64
+#define BENCH_SAMPLES   20000
+
+struct out_link
+{
+    uint8_t              storage[4096];
+    char                 stage[64];
+    ring_buffer<uint8_t> tx { storage, sizeof(storage) };
+    cmnd_sender          sender { tx, stage, sizeof(stage) };
+};
+
+static out_link   links[BENCH_MAX_LINKS];
+static char       prefixes[BENCH_MAX_LINKS][12];
+static char       paths[BENCH_MAX_LINKS][24];
+static frame_route routes[BENCH_MAX_LINKS];
+
+/* Re-send handler of the parse-and-send gateway for outbound link K */
+template<int K>
+static void relay(data_type type, const void* data, uint16_t count)
+{
+    if (type == data_type::INT)
+        links[K].sender.send_int("motor/set", static_cast<const int32_t*>(data), count);
+}
+
+template<int... K>
+static void fill_table(path_entry* table, std::integer_sequence<int, K...>)
+{
+    ((table[K] = path_entry { paths[K], data_type::INT, relay<K> }), ...);
+}
+
+static path_entry relay_table[BENCH_MAX_LINKS];
+
+static uint8_t  rx_storage[65535];
+static uint8_t  local_storage[4096];
+static char     scratch[256];
+static char     work[4096];
+static cmnd_frame frame_storage[64];
+
+static ring_buffer<uint8_t>    rx(rx_storage, sizeof(rx_storage));
+static ring_buffer<uint8_t>    local(local_storage, sizeof(local_storage));
+static ring_buffer<cmnd_frame> frames(frame_storage, 64);
+
+static double now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void drain_tx(int count)
+{
+    for (int i = 0; i < count; i++)
+        links[i].tx.consume(links[i].tx.count());
+}
+
+/* Pushes as much of the input stream as fits; returns the new position */
+static uint32_t refill(const char* stream, uint32_t len, uint32_t pos)
+{
+    uint8_t* a;
+    uint8_t* b;
+    uint16_t a_len;
+    uint16_t b_len;
+
+    rx.writable(a, a_len, b, b_len);
+
+    uint32_t n = std::min<uint32_t>(a_len, len - pos);
+    memcpy(a, stream + pos, n);
+    rx.produce((uint16_t)n);
+    return pos + n;
+}
+
+struct gateway
+{
+    virtual void poll() = 0;
+};
+
+struct router_gateway : gateway
+{
+    frame_router router { rx, local, scratch, sizeof(scratch) };
+    cmnd_parser  parser { local, frames, work, sizeof(work) };
+
+    explicit router_gateway(int count)
+    {
+        static cmnd_sender* senders[BENCH_MAX_LINKS];
+        for (int i = 0; i < count; i++)
+            senders[i] = &links[i].sender;
+        router.set_routes(routes, (uint8_t)count, senders, (uint8_t)count);
+    }
+
+    void poll() override
+    {
+        router.poll();
+        parser.poll();
+        frames.consume(frames.count());
+    }
+};
+
+struct resend_gateway : gateway
+{
+    cmnd_parser   parser { rx, frames, work, sizeof(work) };
+    cmnd_executer executer;
+
+    explicit resend_gateway(int count)
+        : executer(frames, relay_table, (uint16_t)count)
+    {
+    }
+
+    void poll() override
+    {
+        bool more;
+        do
+        {
+            parser.poll();
+            more = !frames.empty();
+            while (!frames.empty())
+                executer.poll();
+        } while (more);
+    }
+};
+
+static void run(const char* name, gateway& gw, int count, uint32_t total)
+{
+    // Input: counter frames round robin over all outbound links
+    static char stream[BENCH_MAX_LINKS * 4096];
+    uint32_t    len = 0;
+
+    for (uint32_t k = 0; len + 40 < sizeof(stream) && k < 100000; k++)
+        len += (uint32_t)snprintf(stream + len, sizeof(stream) - len,
+                                  "{p:%s:d:%u}", paths[k % count], k & 0xFFFU);
+
+    // Throughput
+    uint32_t frames_done = 0;
+    uint32_t per_pass    = 0;
+    for (uint32_t i = 0; i < len; i++)
+        per_pass += stream[i] == '{';
+
+    double t0 = now_ns();
+
+    while (frames_done < total)
+    {
+        for (uint32_t pos = 0; pos < len; )
+        {
+            pos = refill(stream, len, pos);
+            gw.poll();
+            drain_tx(count);
+        }
+        frames_done += per_pass;
+    }
+
+    double elapsed = now_ns() - t0;
+
+    // Latency of one frame from RX ring to TX ring
+    static double samples[BENCH_SAMPLES];
+
+    for (int s = 0; s < BENCH_SAMPLES; s++)
+    {
+        char     frame[40];
+        uint32_t n = (uint32_t)snprintf(frame, sizeof(frame), "{p:%s:d:%d}", paths[s % count], s);
+
+        double t = now_ns();
+        refill(frame, n, 0);
+        gw.poll();
+        samples[s] = now_ns() - t;
+
+        drain_tx(count);
+    }
+
+    std::sort(samples, samples + BENCH_SAMPLES);
+
+    printf("%-8s links=%2d  %6.2f M frames/s  %5.0f ns/frame  latency p50 %5.0f ns  p99 %5.0f ns\n",
+           name, count, frames_done / elapsed * 1e3, elapsed / frames_done,
+           samples[BENCH_SAMPLES / 2], samples[BENCH_SAMPLES * 99 / 100]);
+}
+
+// A frame corrupted on the inbound link must not leave with a fresh CRC
+// when its route rewrites the path; an intact one must pass the
+// outbound parser's check
+static bool run_corrupt()
+{
+    static uint8_t    in_storage[256], loc_storage[256], out_storage[256], enc_storage[256];
+    static char       stage[64], rscratch[64], owork[128];
+    static cmnd_frame out_frames[4];
+
+    ring_buffer<uint8_t>    in(in_storage, sizeof(in_storage));
+    ring_buffer<uint8_t>    loc(loc_storage, sizeof(loc_storage));
+    ring_buffer<uint8_t>    out(out_storage, sizeof(out_storage));
+    ring_buffer<uint8_t>    enc(enc_storage, sizeof(enc_storage));
+    ring_buffer<cmnd_frame> out_queue(out_frames, 4);
+    cmnd_sender             mcu(out, stage, sizeof(stage));
+    cmnd_sender             ground(enc);
+    frame_router            router(in, loc, rscratch, sizeof(rscratch));
+    cmnd_parser             mcu_parser(out, out_queue, owork, sizeof(owork));
+    cmnd_sender*            senders[] = { &mcu };
+    static const frame_route route[] = { { "mcu0/", 0, 5, nullptr } };
+    int32_t                 v = 1234;
+
+    router.set_routes(route, 1, senders, 1);
+    router.set_crc_mode(crc_mode::CRC16_CCITT);
+    ground.set_crc_mode(crc_mode::CRC16_CCITT);
+    mcu_parser.set_crc_mode(crc_mode::CRC16_CCITT);
+
+    // "{p:mcu0/motor/set:d:1234}XXXX", once corrupted in the payload, once intact
+    ground.send_int("mcu0/motor/set", &v, 1);
+    ground.send_int("mcu0/motor/set", &v, 1);
+
+    uint16_t n = enc.count();
+    uint8_t  b = 0;
+
+    for (uint16_t i = 0; i < n; i++)
+    {
+        enc.pop(b);
+        in.push(i == 21 ? (uint8_t)'5' : b);   // 1234 -> 1534
+    }
+
+    router.poll();
+    mcu_parser.poll();
+
+    bool ok = router.stats().dropped == 1 && router.stats().forwarded == 1 &&
+              out_queue.count() == 1 && mcu_parser.crc_errors() == 0;
+
+    printf("corrupted frame on a rewriting route: %s\n",
+           ok ? "dropped, intact one forwarded" : "FAILED");
+    return ok;
+}
+
+// Routed 's'-tagged frames are acknowledged by the router on the inbound
+// link; a retransmission whose ACK was lost is not forwarded again
+static bool run_reliable()
+{
+    static uint8_t in_storage[256], loc_storage[256], out_storage[256], ack_storage[128];
+    static uint8_t slots[2 * 64];
+    static char    gstage[64], astage[64], rscratch[64];
+
+    ring_buffer<uint8_t> in(in_storage, sizeof(in_storage));
+    ring_buffer<uint8_t> loc(loc_storage, sizeof(loc_storage));
+    ring_buffer<uint8_t> out(out_storage, sizeof(out_storage));
+    ring_buffer<uint8_t> acks(ack_storage, sizeof(ack_storage));
+    cmnd_sender          ground(in, gstage, sizeof(gstage));
+    cmnd_sender          ack_sender(acks, astage, sizeof(astage));
+    cmnd_sender          mcu(out);
+    reliable_link        ground_arq(ground, slots, 64, 2, 1);
+    reliable_link        router_arq(ack_sender, nullptr, 0, 1, 1);
+    frame_router         router(in, loc, rscratch, sizeof(rscratch));
+    cmnd_sender*         senders[] = { &mcu };
+    static const frame_route route[] = { { "mcu0/", 0, 0, nullptr } };
+    int32_t              v = 1;
+
+    router.set_routes(route, 1, senders, 1);
+    router.set_reliable_link(&router_arq);
+
+    ground_arq.send_int("mcu0/motor/set", &v, 1);
+    ground_arq.send_int("mcu0/motor/set", &v, 1);
+    ground_arq.tick();          // timeout 1: both are sent again
+    router.poll();
+
+    char     ack[32] = { 0 };
+    uint16_t n       = acks.count();
+
+    for (uint16_t i = 0; i < n && i < sizeof(ack) - 1; i++)
+        acks.pop(reinterpret_cast<uint8_t&>(ack[i]));
+
+    bool ok = router.stats().forwarded == 2 && router.stats().duplicates == 2 &&
+              strstr(ack, "{p:$ack:d:2,0}") != nullptr;
+
+    printf("routed ARQ frames: %s\n", ok ? "acknowledged, forwarded once" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t  total    = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 2000000U;
+    const int counts[] = { 1, 8, 64 };
+
+    for (int i = 0; i < BENCH_MAX_LINKS; i++)
+    {
+        snprintf(prefixes[i], sizeof(prefixes[i]), "mcu%d/", i);
+        snprintf(paths[i], sizeof(paths[i]), "mcu%d/motor/set", i);
+        routes[i] = frame_route { prefixes[i], (uint8_t)i, (uint8_t)strlen(prefixes[i]), nullptr };
+    }
+    fill_table(relay_table, std::make_integer_sequence<int, BENCH_MAX_LINKS>());
+
+    bool ok = run_corrupt();
+    ok &= run_reliable();
+
+    for (int count : counts)
+    {
+        {
+            router_gateway gw(count);
+            run("router", gw, count, total);
+        }
+        {
+            resend_gateway gw(count);
+            run("re-send", gw, count, total);
+        }
+    }
+
+    return ok ? 0 : 1;
+}
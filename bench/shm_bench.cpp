@@ -0,0 +1,150 @@
+// Shared-memory link throughput: a forked "firmware" process sends
+// telemetry frames through cmnd_sender and shm_link, the parent parses
+// and dispatches them with cmnd_parser/cmnd_executer.
+//
+//   g++ -std=c++20 -O2 -IInc bench/shm_bench.cpp Src/core/*.cpp Src/port/linux/shm_link.cpp -o shm_bench
+//   ./shm_bench [frames] [text|binary]
+#include "core/cmnd_sender.h"
+#include "core/cmnd_parser.h"
+#include "core/cmnd_executer.h"
+#include "port/linux/shm_link.h"
+
+#include <sys/wait.h>
+#include <sched.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_SHM_NAME "/pathwire_bench"
+
+static uint32_t received;
+static int32_t  last_value = -1;
+static uint32_t out_of_order;
+
+static void on_counter(data_type type, const void* data, uint16_t count)
+{
+    int32_t value;
+
+    if (type == data_type::INT && count == 1)
+    {
+        memcpy(&value, data, sizeof(value));
+
+        if (value != last_value + 1)
+            out_of_order++;
+
+        last_value = value;
+        received++;
+    }
+}
+
+static const path_entry bench_paths[] = {
+    { "sim/ctr", data_type::INT, on_counter },
+};
+
+static double now_s()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int run_firmware(uint32_t frames, wire_mode mode)
+{
+    static uint8_t rx_storage[4096];
+    static uint8_t tx_storage[65535];
+    static char    stage[64];
+
+    ring_buffer<uint8_t> rx(rx_storage, sizeof(rx_storage));
+    ring_buffer<uint8_t> tx(tx_storage, sizeof(tx_storage));
+    shm_link             link(rx, tx);
+    cmnd_sender          sender(tx, stage, sizeof(stage));
+
+    sender.set_wire_mode(mode);
+
+    while (!link.open(BENCH_SHM_NAME))
+        usleep(1000);
+
+    for (uint32_t i = 0; i < frames; )
+    {
+        int32_t value = (int32_t)i;
+
+        if (sender.send_int("sim/ctr", &value, 1))
+            i++;
+        else if (link.pump() == 0)
+            sched_yield();  // peer is behind; matters when sharing a core
+    }
+
+    while (!tx.empty())
+        if (link.pump() == 0)
+            sched_yield();
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t  frames = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 5000000U;
+    wire_mode mode   = (argc > 2 && strcmp(argv[2], "binary") == 0) ? wire_mode::BINARY
+                                                                     : wire_mode::TEXT;
+
+    static uint8_t    rx_storage[65535];
+    static uint8_t    tx_storage[4096];
+    static cmnd_frame frame_storage[64];
+    static char       work[4096];
+
+    ring_buffer<uint8_t>    rx(rx_storage, sizeof(rx_storage));
+    ring_buffer<uint8_t>    tx(tx_storage, sizeof(tx_storage));
+    ring_buffer<cmnd_frame> frames_q(frame_storage, 64);
+    cmnd_parser             parser(rx, frames_q, work, sizeof(work));
+    cmnd_executer           executer(frames_q, bench_paths, 1);
+    shm_link                link(rx, tx);
+
+    parser.set_wire_mode(mode);
+
+    if (!link.create(BENCH_SHM_NAME))
+    {
+        perror("shm_link::create");
+        return 1;
+    }
+
+    pid_t child = fork();
+    if (child == 0)
+        _exit(run_firmware(frames, mode));
+
+    double start = now_s();
+    bool   done  = false;
+
+    while (received < frames)
+    {
+        if (link.pump() == 0 && rx.empty())
+            sched_yield();
+
+        bool more;
+        do
+        {
+            parser.poll();
+            more = !frames_q.empty();
+            while (!frames_q.empty())
+                executer.poll();
+        } while (more);
+
+        if (!done)
+            done = waitpid(child, nullptr, WNOHANG) == child;
+        else if (rx.empty() && link.pump() == 0)
+            break;  // firmware finished and everything was drained
+    }
+
+    double elapsed = now_s() - start;
+
+    if (!done)
+        waitpid(child, nullptr, 0);
+
+    printf("%s: %u/%u frames in %.3f s, %.2f M frames/s, %.1f MB/s, %u out of order\n",
+           mode == wire_mode::BINARY ? "binary" : "text",
+           received, frames, elapsed, received / elapsed / 1e6,
+           link.stats().rx_bytes / elapsed / 1e6, out_of_order);
+
+    return received == frames && out_of_order == 0 ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+// Receive-side scaling of the epoll and io_uring backends over pty
+// pairs. A writer thread feeds counter frames into the master end of
+// every pty; the backend under test reads the slave ends and runs a
+// parser/executer per link. Reported per backend and link count:
+// frames/s, receiver CPU time per frame and receiver syscalls per
+// 1000 frames.
+//
+//   g++ -std=c++20 -O2 -DREACTOR_MAX_SOURCES=72 -IInc bench/uring_bench.cpp Src/core/*.cpp Src/port/linux/*.cpp -o uring_bench -lutil -pthread
+//   ./uring_bench [frames_per_link]
+#include "core/cmnd_parser.h"
+#include "core/cmnd_executer.h"
+#include "port/linux/serial_port.h"
+#include "port/linux/uring_transport.h"
+
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <atomic>
+#include <thread>
+
+#define BENCH_MAX_LINKS 64
+#define BENCH_BATCH     64      // frames per write() into a pty
+
+static std::atomic<uint32_t> received;
+
+static void on_counter(data_type, const void*, uint16_t)
+{
+    received.fetch_add(1, std::memory_order_relaxed);
+}
+
+static const path_entry bench_paths[] = {
+    { "sim/ctr", data_type::INT, on_counter },
+};
+
+struct bench_link
+{
+    uint8_t                 rx_storage[4096];
+    uint8_t                 tx_storage[256];
+    cmnd_frame              frame_storage[32];
+    char                    work[512];
+
+    ring_buffer<uint8_t>    rx { rx_storage, sizeof(rx_storage) };
+    ring_buffer<uint8_t>    tx { tx_storage, sizeof(tx_storage) };
+    ring_buffer<cmnd_frame> frames { frame_storage, 32 };
+    cmnd_parser             parser { rx, frames, work, sizeof(work) };
+    cmnd_executer           executer { frames, bench_paths, 1 };
+
+    serial_port*            port = nullptr;
+    int                     master = -1;
+    int                     slave = -1;
+};
+
+static bench_link links[BENCH_MAX_LINKS];
+
+static void drain(bench_link& l)
+{
+    bool more;
+    do
+    {
+        l.parser.poll();
+        more = !l.frames.empty();
+        while (!l.frames.empty())
+            l.executer.poll();
+    } while (more);
+}
+
+static void on_port_rx(void* ctx)
+{
+    bench_link* l = static_cast<bench_link*>(ctx);
+    drain(*l);
+    l->port->resume_rx();
+}
+
+static void on_link_rx(void* ctx, int)
+{
+    drain(*static_cast<bench_link*>(ctx));
+}
+
+static double now_s(clockid_t clock)
+{
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool open_links(int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        termios tio;
+
+        if (openpty(&links[i].master, &links[i].slave, nullptr, nullptr, nullptr) != 0)
+            return false;
+
+        // Raw on both ends: no echo back into the writer, no line editing
+        tcgetattr(links[i].slave, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(links[i].slave, TCSANOW, &tio);
+        tcsetattr(links[i].master, TCSANOW, &tio);
+
+        links[i].parser.reset();
+    }
+    return true;
+}
+
+static void close_masters(int count)
+{
+    for (int i = 0; i < count; i++)
+        close(links[i].master);
+}
+
+/* Writes frames_per_link counter frames to every master, round robin */
+static void writer(int count, uint32_t frames_per_link)
+{
+    static char batch[BENCH_BATCH * 32];
+
+    for (uint32_t sent = 0; sent < frames_per_link; sent += BENCH_BATCH)
+    {
+        int len = 0;
+
+        for (uint32_t k = sent; k < sent + BENCH_BATCH && k < frames_per_link; k++)
+            len += snprintf(batch + len, sizeof(batch) - len, "{p:sim/ctr:d:%u}", k);
+
+        for (int i = 0; i < count; i++)
+        {
+            for (int off = 0; off < len; )
+            {
+                ssize_t n = write(links[i].master, batch + off, len - off);
+                if (n <= 0)
+                    return;
+                off += (int)n;
+            }
+        }
+    }
+}
+
+struct result
+{
+    double   wall;
+    double   cpu;
+    uint64_t syscalls;
+};
+
+static result run_epoll(int count, uint32_t frames_per_link)
+{
+    static serial_port* ports[BENCH_MAX_LINKS];
+
+    epoll_reactor reactor;
+    uint64_t      waits = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        ports[i] = new serial_port(reactor, links[i].rx, links[i].tx);
+        ports[i]->set_rx_handler(on_port_rx, &links[i]);
+        links[i].port = ports[i];
+
+        if (!ports[i]->attach(links[i].slave))
+        {
+            fprintf(stderr, "epoll: link %d not attached (REACTOR_MAX_SOURCES)\n", i);
+            exit(1);
+        }
+    }
+
+    uint32_t total = frames_per_link * (uint32_t)count;
+    received = 0;
+
+    double      wall0 = now_s(CLOCK_MONOTONIC);
+    double      cpu0  = now_s(CLOCK_THREAD_CPUTIME_ID);
+    std::thread w(writer, count, frames_per_link);
+
+    while (received < total && reactor.run_once(1000) >= 0)
+        waits++;
+
+    result r { now_s(CLOCK_MONOTONIC) - wall0, now_s(CLOCK_THREAD_CPUTIME_ID) - cpu0, waits };
+    w.join();
+
+    for (int i = 0; i < count; i++)
+    {
+        r.syscalls += ports[i]->stats().reads;
+        delete ports[i];
+    }
+    close_masters(count);
+    return r;
+}
+
+static result run_uring(int count, uint32_t frames_per_link)
+{
+    uring_transport uring;
+
+    for (int i = 0; i < count; i++)
+        uring.add_link(links[i].slave, links[i].rx, links[i].tx, on_link_rx, &links[i]);
+
+    if (!uring.start())
+        return result { 0, 0, 0 };
+
+    uint32_t total = frames_per_link * (uint32_t)count;
+    received = 0;
+
+    double      wall0 = now_s(CLOCK_MONOTONIC);
+    double      cpu0  = now_s(CLOCK_THREAD_CPUTIME_ID);
+    std::thread w(writer, count, frames_per_link);
+
+    while (received < total && uring.run_once(1000) >= 0) {}
+
+    result r { now_s(CLOCK_MONOTONIC) - wall0, now_s(CLOCK_THREAD_CPUTIME_ID) - cpu0,
+               uring.enters() };
+    w.join();
+
+    close_masters(count);
+    return r;
+}
+
+static void report(const char* name, int count, uint32_t frames_per_link, const result& r)
+{
+    double frames = (double)frames_per_link * count;
+
+    printf("%-6s links=%2d  %6.2f M frames/s  %6.0f ns cpu/frame  %7.1f syscalls/1k frames  (%u/%.0f)\n",
+           name, count, received / r.wall / 1e6, r.cpu / frames * 1e9,
+           r.syscalls / frames * 1000.0, received.load(), frames);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t  frames_per_link = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 0) : 20000U;
+    const int counts[] = { 1, 8, 32, 64 };
+
+    for (int count : counts)
+    {
+        if (!open_links(count))
+        {
+            perror("openpty");
+            return 1;
+        }
+        report("epoll", count, frames_per_link, run_epoll(count, frames_per_link));
+
+        if (!open_links(count))
+        {
+            perror("openpty");
+            return 1;
+        }
+        report("uring", count, frames_per_link, run_uring(count, frames_per_link));
+    }
+
+    return 0;
+}
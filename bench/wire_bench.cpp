@@ -0,0 +1,164 @@
+// Text vs binary wire mode at equal baud: a staging sender keeps its TX
+// ring full, a simulated 8N1 UART moves baud / 10 bytes per second into
+// the receiver's RX ring, and the parser and executer decode every
+// frame, whose values are checked. Reports, per payload and mode, the
+// encoded frame size and the frames per second the link carries. A
+// second pass without the link limit measures the host CPU time per
+// frame (encode + decode).
+//
+//   g++ -std=c++11 -O2 -IInc bench/wire_bench.cpp Src/core/*.cpp -o wire_bench
+//   ./wire_bench [frames] [baud]
+#include "core/cmnd_sender.h"
+#include "core/cmnd_parser.h"
+#include "core/cmnd_executer.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <chrono>
+
+#define LINK_STEP_US 100     // simulated time per link step
+
+static uint32_t received, mismatched;
+static int32_t  expect_i[MAX_CSV_ITEMS];
+static float    expect_f[MAX_CSV_ITEMS];
+
+static void on_int(data_type type, const void* data, uint16_t count)
+{
+    const int32_t* v = static_cast<const int32_t*>(data);
+
+    received++;
+    for (uint16_t i = 0; i < count; i++)
+        if (type != data_type::INT || v[i] != expect_i[i])
+            mismatched++;
+}
+
+static void on_float(data_type type, const void* data, uint16_t count)
+{
+    const float* v = static_cast<const float*>(data);
+
+    received++;
+    // Text mode carries 3 decimals
+    for (uint16_t i = 0; i < count; i++)
+        if (type != data_type::FLOAT || v[i] - expect_f[i] > 0.0006f || expect_f[i] - v[i] > 0.0006f)
+            mismatched++;
+}
+
+static const path_entry table[] = {
+    { "ctl/arm",       data_type::INT,   on_int },
+    { "sens/imu/gyro", data_type::FLOAT, on_float },
+    { "sens/imu/raw",  data_type::INT,   on_int },
+};
+
+struct payload
+{
+    const char* path;
+    data_type   type;
+    uint16_t    count;
+};
+
+// baud == 0: no link limit, every queued byte is delivered at once
+static bool run(const payload& p, wire_mode mode, uint32_t frames, uint32_t baud,
+                uint32_t& frame_bytes, double& seconds)
+{
+    static uint8_t    tx_storage[1024];
+    static uint8_t    rx_storage[1024];
+    static cmnd_frame frame_storage[16];
+    static char       stage[128];
+    static char       work[512];
+
+    ring_buffer<uint8_t>    tx(tx_storage, sizeof(tx_storage));
+    ring_buffer<uint8_t>    rx(rx_storage, sizeof(rx_storage));
+    ring_buffer<cmnd_frame> frame_queue(frame_storage, 16);
+    cmnd_sender             sender(tx, stage, sizeof(stage));
+    cmnd_parser             parser(rx, frame_queue, work, sizeof(work));
+    cmnd_executer           executer(frame_queue, table, 3);
+
+    sender.set_wire_mode(mode);
+    parser.set_wire_mode(mode);
+
+    for (uint16_t i = 0; i < p.count; i++)
+    {
+        expect_i[i] = 1000 * (int32_t)i - 123456;
+        expect_f[i] = 0.125f * (float)i - 0.731f;
+    }
+
+    received   = 0;
+    mismatched = 0;
+
+    uint32_t sent   = 0;
+    uint64_t steps  = 0;
+    uint64_t credit = 0;
+    uint32_t bytes  = 0;
+    auto     t0     = std::chrono::steady_clock::now();
+
+    while (received < frames)
+    {
+        // Keep the TX ring full so the link never idles
+        while (sent < frames)
+        {
+            uint32_t before = sender.queued_bytes();
+            bool     ok     = p.type == data_type::INT ? sender.send_int(p.path, expect_i, p.count)
+                                                      : sender.send_float(p.path, expect_f, p.count);
+            if (!ok)
+                break;
+            if (sent++ == 0)
+                bytes = sender.queued_bytes() - before;
+        }
+
+        credit = baud ? credit + (uint64_t)baud * LINK_STEP_US : UINT64_MAX;
+        for (uint8_t b; credit >= 10000000ULL && rx.space() && tx.pop(b); credit -= 10000000ULL)
+            rx.push(b);
+
+        parser.poll();
+        while (!frame_queue.empty())
+            executer.poll();
+        steps++;
+    }
+
+    frame_bytes = bytes;
+    seconds     = baud ? steps * LINK_STEP_US * 1e-6
+                       : std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return mismatched == 0;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t frames = argc > 1 ? (uint32_t)atoi(argv[1]) : 20000;
+    uint32_t baud   = argc > 2 ? (uint32_t)atoi(argv[2]) : 115200;
+
+    if (frames == 0)
+        frames = 20000;
+    if (baud == 0)
+        baud = 115200;
+
+    static const payload payloads[] = {
+        { "ctl/arm",       data_type::INT,   1 },
+        { "sens/imu/gyro", data_type::FLOAT, 3 },
+        { "sens/imu/raw",  data_type::INT,   MAX_CSV_ITEMS },
+    };
+    static const wire_mode modes[] = { wire_mode::TEXT, wire_mode::BINARY };
+    bool ok = true;
+
+    printf("%lu baud (8N1)\n", (unsigned long)baud);
+
+    for (const payload& p : payloads)
+    {
+        for (wire_mode mode : modes)
+        {
+            uint32_t bytes;
+            double   link, host;
+
+            ok &= run(p, mode, frames, baud, bytes, link);
+            ok &= run(p, mode, frames, 0, bytes, host);
+
+            printf("%-14s %u x %-5s  %-6s  %3u B/frame  %7.0f frames/s  %5.0f ns/frame host\n",
+                   p.path, p.count, p.type == data_type::INT ? "INT" : "FLOAT",
+                   mode == wire_mode::TEXT ? "text" : "binary", bytes, frames / link,
+                   host * 1e9 / frames);
+        }
+    }
+
+    puts(ok ? "all values decoded" : "FAILED");
+    return ok ? 0 : 1;
+}